@@ -0,0 +1,191 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <bloom_filter.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using datasketches::bloom_filter;
+using benchmark_keys::makeKeys;
+
+constexpr uint16_t NUM_HASHES = 3;
+// 8MB filters, well beyond the size of the caches
+constexpr uint64_t NUM_BITS = 1ULL << 26;
+
+std::vector<bloom_filter> makeFilters(const bloom_filter & target, size_t num_filters)
+{
+    std::vector<bloom_filter> filters;
+    for (size_t i = 0; i < num_filters; ++i)
+    {
+        filters.push_back(bloom_filter::builder::create_by_size(NUM_BITS, NUM_HASHES, target.get_seed()));
+        for (uint64_t j = 0; j < 10000; ++j)
+            filters.back().update(i * 10000 + j);
+    }
+    return filters;
+}
+
+// Unions the given number of filters one by one
+void BM_BloomFilterUnion(benchmark::State & state)
+{
+    const size_t num_filters = static_cast<size_t>(state.range(0));
+    auto target = bloom_filter::builder::create_by_size(NUM_BITS, NUM_HASHES);
+    const auto filters = makeFilters(target, num_filters);
+
+    for (auto _ : state)
+    {
+        for (const auto & filter : filters)
+            target.union_with(filter);
+        benchmark::DoNotOptimize(target.get_bits_used());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_filters));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(num_filters * NUM_BITS / 8));
+}
+
+// Unions the given number of filters in one pass
+void BM_BloomFilterUnionMany(benchmark::State & state)
+{
+    const size_t num_filters = static_cast<size_t>(state.range(0));
+    auto target = bloom_filter::builder::create_by_size(NUM_BITS, NUM_HASHES);
+    const auto filters = makeFilters(target, num_filters);
+    std::vector<const bloom_filter *> pointers;
+    for (const auto & filter : filters)
+        pointers.push_back(&filter);
+
+    for (auto _ : state)
+    {
+        target.union_many(pointers.data(), pointers.size());
+        benchmark::DoNotOptimize(target.get_bits_used());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_filters));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(num_filters * NUM_BITS / 8));
+}
+
+void BM_BloomFilterIntersect(benchmark::State & state)
+{
+    auto target = bloom_filter::builder::create_by_size(NUM_BITS, NUM_HASHES);
+    const auto filters = makeFilters(target, 1);
+
+    for (auto _ : state)
+    {
+        target.intersect(filters[0]);
+        benchmark::DoNotOptimize(target.get_bits_used());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(NUM_BITS / 8));
+}
+
+uint64_t numBits(const benchmark::State & state)
+{
+    return static_cast<uint64_t>(state.range(0));
+}
+
+// Filters from 8KB, which fit in L1, to 8MB, well beyond L2
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->RangeMultiplier(32)->Range(1 << 16, NUM_BITS);
+}
+
+// Filled to about half of the bits
+bloom_filter makeFilter(uint64_t num_bits)
+{
+    auto filter = bloom_filter::builder::create_by_size(num_bits, NUM_HASHES);
+    for (const auto key : makeKeys<uint64_t>(num_bits / 4))
+        filter.update(key);
+    return filter;
+}
+
+template <typename T>
+void BM_BloomFilterUpdate(benchmark::State & state)
+{
+    auto filter = bloom_filter::builder::create_by_size(numBits(state), NUM_HASHES);
+    const auto keys = makeKeys<T>(1 << 16);
+    for (auto _ : state)
+    {
+        for (const auto & key : keys)
+            filter.update(key);
+        benchmark::DoNotOptimize(filter.get_bits_used());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+// Half of the queried keys are present
+template <typename T>
+void BM_BloomFilterQuery(benchmark::State & state)
+{
+    const auto filter = makeFilter(numBits(state));
+    const auto keys = makeKeys<T>(numBits(state) / 4, numBits(state) / 8);
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const auto & key : keys)
+            count += filter.query(key);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+void BM_BloomFilterSerialize(benchmark::State & state)
+{
+    const auto filter = makeFilter(numBits(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filter.serialize().data());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(numBits(state) / 8));
+}
+
+void BM_BloomFilterDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeFilter(numBits(state)).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bloom_filter::deserialize(bytes.data(), bytes.size()).get_bits_used());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+// Wraps a serialized filter and answers one query
+void BM_BloomFilterWrapQuery(benchmark::State & state)
+{
+    const auto bytes = makeFilter(numBits(state)).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bloom_filter::wrap(bytes.data(), bytes.size()).query(uint64_t(42)));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_BloomFilterUpdate, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_BloomFilterUpdate, double)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_BloomFilterUpdate, std::string)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_BloomFilterQuery, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_BloomFilterQuery, std::string)->Apply(sizeArgs);
+BENCHMARK(BM_BloomFilterSerialize)->Apply(sizeArgs);
+BENCHMARK(BM_BloomFilterDeserialize)->Apply(sizeArgs);
+BENCHMARK(BM_BloomFilterWrapQuery)->Apply(sizeArgs);
+BENCHMARK(BM_BloomFilterUnion)->RangeMultiplier(4)->Range(1, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BloomFilterUnionMany)->RangeMultiplier(4)->Range(1, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BloomFilterIntersect)->Unit(benchmark::kMillisecond);
@@ -18,10 +18,14 @@
  */
 
 #include <benchmark/benchmark.h>
+#include <blocked_count_min.hpp>
+#include <concurrent_count_min.hpp>
 #include <count_min.hpp>
+#include <saturating_count_min.hpp>
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,11 +33,54 @@ namespace
 {
 
 using Sketch = datasketches::count_min_sketch<uint64_t>;
+using BlockedSketch = datasketches::blocked_count_min_sketch<uint64_t>;
+using ConcurrentSketch = datasketches::concurrent_count_min_sketch<uint64_t>;
 
 // Roughly 99.9% confidence and 0.1% relative error:
-// suggest_num_hashes(0.999) == 7 and suggest_num_buckets(0.001) == 2719.
+// suggest_num_hashes(0.999) == 7, suggest_num_buckets(0.001) == 2719
+// and suggest_num_buckets_pow2(0.001) == 4096.
 constexpr uint8_t NUM_HASHES = 7;
 constexpr uint32_t NUM_BUCKETS = 2719;
+constexpr uint32_t NUM_BUCKETS_POW2 = 4096;
+// Sketch well beyond the size of the caches (56MB), where counter misses dominate.
+constexpr uint32_t NUM_BUCKETS_WIDE = 1 << 20;
+
+datasketches::count_min_hash_type hashType(const benchmark::State & state)
+{
+    return static_cast<datasketches::count_min_hash_type>(state.range(1));
+}
+
+uint32_t numBuckets(const benchmark::State & state)
+{
+    return static_cast<uint32_t>(state.range(2));
+}
+
+// Arguments are the number of keys, the hashing scheme and the number of buckets.
+void countMinArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({
+        benchmark::CreateRange(1024, 65536, 8),
+        {datasketches::PER_ROW_HASHING, datasketches::DOUBLE_HASHING},
+        {NUM_BUCKETS, NUM_BUCKETS_POW2, NUM_BUCKETS_WIDE}});
+}
+
+// The blocked sketch uses the same memory as the row-major sketches with NUM_BUCKETS_POW2
+// and NUM_BUCKETS_WIDE buckets per row.
+constexpr uint8_t BLOCKED_NUM_HASHES = 3;
+constexpr uint32_t BLOCKED_NUM_BLOCKS = NUM_HASHES * NUM_BUCKETS_POW2 / BlockedSketch::CELLS_PER_BLOCK;
+constexpr uint32_t BLOCKED_NUM_BLOCKS_WIDE = NUM_HASHES * NUM_BUCKETS_WIDE / BlockedSketch::CELLS_PER_BLOCK;
+
+// Arguments are the number of keys and the number of blocks.
+void blockedCountMinArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({benchmark::CreateRange(1024, 65536, 8), {BLOCKED_NUM_BLOCKS, BLOCKED_NUM_BLOCKS_WIDE}});
+}
+
+// Arguments are the number of keys and the number of buckets.
+void saturatingCountMinArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({benchmark::CreateRange(1024, 65536, 8), {NUM_BUCKETS_POW2, NUM_BUCKETS_WIDE}});
+}
 
 std::vector<uint64_t> makeUInt64Keys(size_t size)
 {
@@ -67,7 +114,27 @@ void BM_CountMinUpdateUInt64(benchmark::State & state)
     for (auto _ : state)
     {
         state.PauseTiming();
-        Sketch sketch(NUM_HASHES, NUM_BUCKETS);
+        Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
+        state.ResumeTiming();
+
+        for (const auto key : keys)
+            sketch.update(&key, sizeof(key), 1);
+
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(sketch.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
+void BM_CountMinConservativeUpdateUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state), datasketches::CONSERVATIVE_UPDATE);
         state.ResumeTiming();
 
         for (const auto key : keys)
@@ -89,7 +156,7 @@ void BM_CountMinUpdateStringBytes(benchmark::State & state)
     for (auto _ : state)
     {
         state.PauseTiming();
-        Sketch sketch(NUM_HASHES, NUM_BUCKETS);
+        Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
         state.ResumeTiming();
 
         for (const auto & key : keys)
@@ -103,10 +170,29 @@ void BM_CountMinUpdateStringBytes(benchmark::State & state)
     state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
 }
 
+void BM_CountMinUpdateBatchUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
+        state.ResumeTiming();
+
+        sketch.update_batch(keys.data(), nullptr, keys.size());
+
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(sketch.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
 void BM_CountMinEstimateUInt64(benchmark::State & state)
 {
     const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
-    Sketch sketch(NUM_HASHES, NUM_BUCKETS);
+    Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
     for (const auto key : keys)
         sketch.update(&key, sizeof(key), 1);
 
@@ -123,12 +209,30 @@ void BM_CountMinEstimateUInt64(benchmark::State & state)
     state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
 }
 
+void BM_CountMinEstimatesBatchUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
+    sketch.update_batch(keys.data(), nullptr, keys.size());
+
+    std::vector<uint64_t> estimates(keys.size());
+    for (auto _ : state)
+    {
+        sketch.get_estimates(keys.data(), estimates.data(), keys.size());
+        benchmark::DoNotOptimize(estimates.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
 void BM_CountMinEstimateStringBytes(benchmark::State & state)
 {
     const auto keys = makeStringKeys(static_cast<size_t>(state.range(0)));
     const auto bytes_per_iteration = totalStringBytes(keys);
 
-    Sketch sketch(NUM_HASHES, NUM_BUCKETS);
+    Sketch sketch(NUM_HASHES, numBuckets(state), hashType(state));
     for (const auto & key : keys)
         sketch.update(key.data(), key.size(), 1);
 
@@ -145,9 +249,213 @@ void BM_CountMinEstimateStringBytes(benchmark::State & state)
     state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
 }
 
+void BM_BlockedCountMinUpdateUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    // The sketch is reused across iterations: allocating and faulting in the
+    // widest configuration would otherwise dominate the measurement.
+    BlockedSketch sketch(BLOCKED_NUM_HASHES, static_cast<uint32_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sketch.update(&key, sizeof(key), 1);
+
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(sketch.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
+void BM_BlockedCountMinEstimateUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    BlockedSketch sketch(BLOCKED_NUM_HASHES, static_cast<uint32_t>(state.range(1)));
+    for (const auto key : keys)
+        sketch.update(&key, sizeof(key), 1);
+
+    uint64_t sum = 0;
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sum += sketch.get_estimate(&key, sizeof(key));
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
+template<typename C>
+void BM_SaturatingCountMinUpdateUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    datasketches::saturating_count_min_sketch<C> sketch(NUM_HASHES, static_cast<uint32_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sketch.update(&key, sizeof(key), 1);
+
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(sketch.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
+template<typename C>
+void BM_SaturatingCountMinEstimateUInt64(benchmark::State & state)
+{
+    const auto keys = makeUInt64Keys(static_cast<size_t>(state.range(0)));
+    datasketches::saturating_count_min_sketch<C> sketch(NUM_HASHES, static_cast<uint32_t>(state.range(1)));
+    for (const auto key : keys)
+        sketch.update(&key, sizeof(key), 1);
+
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const auto key : keys)
+            sum += sketch.get_estimate(&key, sizeof(key));
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+}
+
+// Merges the given number of sketches with NUM_BUCKETS_WIDE buckets one by one
+void BM_CountMinMerge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(0));
+    Sketch target(NUM_HASHES, NUM_BUCKETS_WIDE, datasketches::DOUBLE_HASHING);
+    std::vector<Sketch> sketches(num_sketches, target);
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches[i].update(static_cast<uint64_t>(i));
+
+    for (auto _ : state)
+    {
+        for (const auto & sketch : sketches)
+            target.merge(sketch);
+        benchmark::DoNotOptimize(target.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(num_sketches * NUM_HASHES * NUM_BUCKETS_WIDE * sizeof(uint64_t)));
+}
+
+// Merges the given number of sketches with NUM_BUCKETS_WIDE buckets in one pass
+void BM_CountMinMergeMany(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(0));
+    Sketch target(NUM_HASHES, NUM_BUCKETS_WIDE, datasketches::DOUBLE_HASHING);
+    std::vector<Sketch> sketches(num_sketches, target);
+    std::vector<const Sketch *> pointers;
+    for (size_t i = 0; i < num_sketches; ++i)
+    {
+        sketches[i].update(static_cast<uint64_t>(i));
+        pointers.push_back(&sketches[i]);
+    }
+
+    for (auto _ : state)
+    {
+        target.merge_many(pointers.data(), pointers.size());
+        benchmark::DoNotOptimize(target.get_total_weight());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(num_sketches * NUM_HASHES * NUM_BUCKETS_WIDE * sizeof(uint64_t)));
+}
+
+// Answers one query from a serialized sketch with the given number of buckets
+void BM_CountMinDeserializeEstimate(benchmark::State & state)
+{
+    Sketch sketch(NUM_HASHES, static_cast<uint32_t>(state.range(0)), datasketches::DOUBLE_HASHING);
+    for (const auto key : makeUInt64Keys(1024))
+        sketch.update(key);
+    const auto bytes = sketch.serialize();
+
+    for (auto _ : state)
+    {
+        const auto deserialized = Sketch::deserialize(bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(deserialized.get_estimate(uint64_t(42)));
+    }
+}
+
+void BM_CountMinWrapEstimate(benchmark::State & state)
+{
+    Sketch sketch(NUM_HASHES, static_cast<uint32_t>(state.range(0)), datasketches::DOUBLE_HASHING);
+    for (const auto key : makeUInt64Keys(1024))
+        sketch.update(key);
+    const auto bytes = sketch.serialize();
+
+    for (auto _ : state)
+    {
+        const auto wrapped = Sketch::wrap(bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(wrapped.get_estimate(uint64_t(42)));
+    }
+}
+
+// All threads update one shared sketch with the given number of buckets
+std::unique_ptr<ConcurrentSketch> sharedSketch;
+
+void BM_ConcurrentCountMinUpdateUInt64(benchmark::State & state)
+{
+    if (state.thread_index() == 0)
+        sharedSketch.reset(new ConcurrentSketch(NUM_HASHES, static_cast<uint32_t>(state.range(0))));
+    auto keys = makeUInt64Keys(65536);
+    for (auto & key : keys)
+        key += static_cast<uint64_t>(state.thread_index());
+
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sharedSketch->update(key);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    if (state.thread_index() == 0)
+        sharedSketch.reset();
+}
+
+// Baseline for the above: each thread updates its own sketch, which would have to be merged afterwards
+void BM_CountMinThreadLocalUpdateUInt64(benchmark::State & state)
+{
+    Sketch sketch(NUM_HASHES, static_cast<uint32_t>(state.range(0)), datasketches::DOUBLE_HASHING);
+    auto keys = makeUInt64Keys(65536);
+    for (auto & key : keys)
+        key += static_cast<uint64_t>(state.thread_index());
+
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sketch.update(key);
+    }
+
+    benchmark::DoNotOptimize(sketch.get_total_weight());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
 }
 
-BENCHMARK(BM_CountMinUpdateUInt64)->RangeMultiplier(8)->Range(1024, 65536);
-BENCHMARK(BM_CountMinUpdateStringBytes)->RangeMultiplier(8)->Range(1024, 65536);
-BENCHMARK(BM_CountMinEstimateUInt64)->RangeMultiplier(8)->Range(1024, 65536);
-BENCHMARK(BM_CountMinEstimateStringBytes)->RangeMultiplier(8)->Range(1024, 65536);
+BENCHMARK(BM_CountMinUpdateUInt64)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinConservativeUpdateUInt64)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinUpdateStringBytes)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinUpdateBatchUInt64)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinEstimateUInt64)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinEstimatesBatchUInt64)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinEstimateStringBytes)->Apply(countMinArgs);
+BENCHMARK(BM_CountMinMerge)->RangeMultiplier(4)->Range(1, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountMinMergeMany)->RangeMultiplier(4)->Range(1, 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountMinDeserializeEstimate)->Arg(NUM_BUCKETS_POW2)->Arg(NUM_BUCKETS_WIDE);
+BENCHMARK(BM_CountMinWrapEstimate)->Arg(NUM_BUCKETS_POW2)->Arg(NUM_BUCKETS_WIDE);
+BENCHMARK(BM_BlockedCountMinUpdateUInt64)->Apply(blockedCountMinArgs);
+BENCHMARK(BM_BlockedCountMinEstimateUInt64)->Apply(blockedCountMinArgs);
+BENCHMARK_TEMPLATE(BM_SaturatingCountMinUpdateUInt64, uint8_t)->Apply(saturatingCountMinArgs);
+BENCHMARK_TEMPLATE(BM_SaturatingCountMinUpdateUInt64, uint16_t)->Apply(saturatingCountMinArgs);
+BENCHMARK_TEMPLATE(BM_SaturatingCountMinEstimateUInt64, uint8_t)->Apply(saturatingCountMinArgs);
+BENCHMARK_TEMPLATE(BM_SaturatingCountMinEstimateUInt64, uint16_t)->Apply(saturatingCountMinArgs);
+BENCHMARK(BM_ConcurrentCountMinUpdateUInt64)->Arg(NUM_BUCKETS_POW2)->Arg(NUM_BUCKETS_WIDE)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_CountMinThreadLocalUpdateUInt64)->Arg(NUM_BUCKETS_POW2)->Arg(NUM_BUCKETS_WIDE)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <cpc_sketch.hpp>
+#include <cpc_union.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using datasketches::cpc_sketch;
+using datasketches::cpc_union;
+using benchmark_keys::makeKeys;
+
+uint8_t lgK(const benchmark::State & state)
+{
+    return static_cast<uint8_t>(state.range(0));
+}
+
+// Arguments are lg_k and the number of keys.
+// The number of keys relative to k selects the sparse, windowed or sliding representation.
+void sketchArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+cpc_sketch makeSketch(uint8_t lg_k, size_t num_keys, size_t offset = 0)
+{
+    cpc_sketch sketch(lg_k);
+    for (const auto key : makeKeys<uint64_t>(num_keys, offset))
+        sketch.update(key);
+    return sketch;
+}
+
+template <typename T>
+void BM_CpcUpdate(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        cpc_sketch sketch(lgK(state));
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+void BM_CpcEstimate(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_estimate());
+        benchmark::DoNotOptimize(sketch.get_upper_bound(2));
+    }
+}
+
+// Arguments are lg_k, the number of keys per sketch and the number of sketches.
+void BM_CpcUnion(benchmark::State & state)
+{
+    const size_t num_keys = static_cast<size_t>(state.range(1));
+    const size_t num_sketches = static_cast<size_t>(state.range(2));
+    std::vector<cpc_sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(lgK(state), num_keys, i * num_keys / 2));
+
+    for (auto _ : state)
+    {
+        cpc_union u(lgK(state));
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+void BM_CpcSerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+void BM_CpcDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch(lgK(state), static_cast<size_t>(state.range(1))).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(cpc_sketch::deserialize(bytes.data(), bytes.size()).get_estimate());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_CpcUpdate, uint64_t)->Apply(sketchArgs);
+BENCHMARK_TEMPLATE(BM_CpcUpdate, double)->Apply(sketchArgs);
+BENCHMARK_TEMPLATE(BM_CpcUpdate, std::string)->Apply(sketchArgs);
+BENCHMARK(BM_CpcEstimate)->Apply(sketchArgs);
+BENCHMARK(BM_CpcUnion)->ArgsProduct({{10, 12, 16}, {1024, 1 << 20}, {2, 16}});
+BENCHMARK(BM_CpcSerialize)->Apply(sketchArgs);
+BENCHMARK(BM_CpcDeserialize)->Apply(sketchArgs);
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <density_sketch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using Sketch = datasketches::density_sketch<float>;
+
+uint16_t paramK(const benchmark::State & state)
+{
+    return static_cast<uint16_t>(state.range(0));
+}
+
+uint32_t dim(const benchmark::State & state)
+{
+    return static_cast<uint32_t>(state.range(1));
+}
+
+// Arguments are k, the dimension and the number of points.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 50, 200}, {3, 16}, benchmark::CreateRange(1024, 1 << 16, 8)});
+}
+
+// Arguments are k and the dimension.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 50, 200}, {3, 16}});
+}
+
+std::vector<std::vector<float>> makePoints(size_t num_points, uint32_t dim, uint64_t seed = 0)
+{
+    const auto values = benchmark_keys::makeValues<float>(num_points * dim, seed);
+    std::vector<std::vector<float>> points;
+    points.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++i)
+        points.emplace_back(values.begin() + i * dim, values.begin() + (i + 1) * dim);
+    return points;
+}
+
+Sketch makeSketch(uint16_t k, uint32_t dim, uint64_t seed = 0)
+{
+    Sketch sketch(k, dim);
+    for (const auto & point : makePoints(1 << 16, dim, seed))
+        sketch.update(point);
+    return sketch;
+}
+
+void BM_DensityUpdate(benchmark::State & state)
+{
+    const auto points = makePoints(static_cast<size_t>(state.range(2)), dim(state));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Sketch sketch(paramK(state), dim(state));
+        state.ResumeTiming();
+
+        for (const auto & point : points)
+            sketch.update(point);
+
+        benchmark::DoNotOptimize(sketch.get_num_retained());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(points.size()));
+}
+
+// Arguments are k, the dimension and the number of sketches.
+void BM_DensityMerge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(2));
+    std::vector<Sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(paramK(state), dim(state), i));
+
+    for (auto _ : state)
+    {
+        Sketch target(paramK(state), dim(state));
+        for (const auto & sketch : sketches)
+            target.merge(sketch);
+        benchmark::DoNotOptimize(target.get_num_retained());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+// Every estimate evaluates the kernel against all retained points
+void BM_DensityGetEstimate(benchmark::State & state)
+{
+    const auto sketch = makeSketch(paramK(state), dim(state));
+    const auto points = makePoints(1024, dim(state), 1);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_estimate(points[i]));
+        i = (i + 1) % points.size();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketch.get_num_retained()));
+}
+
+void BM_DensitySerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch(paramK(state), dim(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+void BM_DensityDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch(paramK(state), dim(state)).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Sketch::deserialize(bytes.data(), bytes.size()).get_n());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+BENCHMARK(BM_DensityUpdate)->Apply(updateArgs);
+BENCHMARK(BM_DensityMerge)->ArgsProduct({{10, 50, 200}, {3, 16}, {2, 16}});
+BENCHMARK(BM_DensityGetEstimate)->Apply(sizeArgs);
+BENCHMARK(BM_DensitySerialize)->Apply(sizeArgs);
+BENCHMARK(BM_DensityDeserialize)->Apply(sizeArgs);
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <frequent_items_sketch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using datasketches::frequent_items_sketch;
+using datasketches::frequent_items_error_type;
+
+// Distinct items in the Zipf-distributed streams
+constexpr size_t NUM_DISTINCT = 1 << 16;
+
+uint8_t lgMaxMapSize(const benchmark::State & state)
+{
+    return static_cast<uint8_t>(state.range(0));
+}
+
+// Arguments are lg_max_map_size and the number of items.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{8, 10, 14}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are lg_max_map_size.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->Arg(8)->Arg(10)->Arg(14);
+}
+
+template <typename T>
+std::vector<T> makeItems(size_t size, uint64_t seed = 0);
+
+template <>
+std::vector<uint64_t> makeItems<uint64_t>(size_t size, uint64_t seed)
+{
+    return benchmark_keys::makeZipfItems(size, NUM_DISTINCT, seed);
+}
+
+template <>
+std::vector<std::string> makeItems<std::string>(size_t size, uint64_t seed)
+{
+    std::vector<std::string> items;
+    items.reserve(size);
+    for (const auto item : benchmark_keys::makeZipfItems(size, NUM_DISTINCT, seed))
+        items.push_back("item-" + std::to_string(item));
+    return items;
+}
+
+template <typename T>
+frequent_items_sketch<T> makeSketch(uint8_t lg_max_map_size, uint64_t seed = 0)
+{
+    frequent_items_sketch<T> sketch(lg_max_map_size);
+    for (const auto & item : makeItems<T>(1 << 20, seed))
+        sketch.update(item);
+    return sketch;
+}
+
+template <typename T>
+void BM_FrequentItemsUpdate(benchmark::State & state)
+{
+    const auto items = makeItems<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        frequent_items_sketch<T> sketch(lgMaxMapSize(state));
+        state.ResumeTiming();
+
+        for (const auto & item : items)
+            sketch.update(item);
+
+        benchmark::DoNotOptimize(sketch.get_total_weight());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(items.size()));
+}
+
+// Arguments are lg_max_map_size and the number of sketches.
+template <typename T>
+void BM_FrequentItemsMerge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(1));
+    std::vector<frequent_items_sketch<T>> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch<T>(lgMaxMapSize(state), i));
+
+    for (auto _ : state)
+    {
+        frequent_items_sketch<T> target(lgMaxMapSize(state));
+        for (const auto & sketch : sketches)
+            target.merge(sketch);
+        benchmark::DoNotOptimize(target.get_total_weight());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+template <typename T>
+void BM_FrequentItemsGetEstimate(benchmark::State & state)
+{
+    const auto sketch = makeSketch<T>(lgMaxMapSize(state));
+    const auto items = makeItems<T>(1024, 1);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_estimate(items[i]));
+        i = (i + 1) % items.size();
+    }
+}
+
+template <typename T>
+void BM_FrequentItemsGetFrequentItems(benchmark::State & state)
+{
+    const auto sketch = makeSketch<T>(lgMaxMapSize(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.get_frequent_items(frequent_items_error_type::NO_FALSE_NEGATIVES).size());
+}
+
+template <typename T>
+void BM_FrequentItemsSerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch<T>(lgMaxMapSize(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+template <typename T>
+void BM_FrequentItemsDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch<T>(lgMaxMapSize(state)).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(frequent_items_sketch<T>::deserialize(bytes.data(), bytes.size()).get_total_weight());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_FrequentItemsUpdate, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsUpdate, std::string)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsMerge, uint64_t)->ArgsProduct({{8, 10, 14}, {2, 16}});
+BENCHMARK_TEMPLATE(BM_FrequentItemsMerge, std::string)->ArgsProduct({{8, 10, 14}, {2, 16}});
+BENCHMARK_TEMPLATE(BM_FrequentItemsGetEstimate, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsGetEstimate, std::string)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsGetFrequentItems, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsSerialize, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsSerialize, std::string)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsDeserialize, uint64_t)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_FrequentItemsDeserialize, std::string)->Apply(sizeArgs);
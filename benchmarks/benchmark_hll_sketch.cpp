@@ -0,0 +1,296 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <concurrent_hll.hpp>
+#include <hll.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using datasketches::concurrent_hll_sketch;
+using datasketches::hll_sketch;
+using datasketches::hll_union;
+using datasketches::target_hll_type;
+using benchmark_keys::makeKeys;
+
+uint8_t lgK(const benchmark::State & state)
+{
+    return static_cast<uint8_t>(state.range(0));
+}
+
+target_hll_type hllType(const benchmark::State & state)
+{
+    return static_cast<target_hll_type>(state.range(1));
+}
+
+// Arguments are lg_k, the target HLL type and the number of keys.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({
+        {12, 21},
+        {datasketches::HLL_4, datasketches::HLL_6, datasketches::HLL_8},
+        benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are lg_k and the target HLL type, sketches are in HLL mode.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16, 21}, {datasketches::HLL_4, datasketches::HLL_6, datasketches::HLL_8}});
+}
+
+hll_sketch makeSketch(uint8_t lg_k, target_hll_type type, size_t offset = 0)
+{
+    hll_sketch sketch(lg_k, type);
+    for (const auto key : makeKeys<uint64_t>(size_t(1) << (lg_k + 2), offset))
+        sketch.update(key);
+    return sketch;
+}
+
+template <typename T>
+void BM_HllUpdate(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(2)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        hll_sketch sketch(lgK(state), hllType(state));
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+template <typename T>
+void BM_HllUpdateBatch(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(2)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        hll_sketch sketch(lgK(state), hllType(state));
+        state.ResumeTiming();
+
+        sketch.update_batch(keys.data(), keys.size());
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+void BM_HllEstimate(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), hllType(state));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_estimate());
+        benchmark::DoNotOptimize(sketch.get_upper_bound(2));
+    }
+}
+
+// Arguments are lg_k, the type of the input sketches and the number of input sketches.
+void BM_HllUnion(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(2));
+    std::vector<hll_sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(lgK(state), hllType(state), i << (lgK(state) + 1)));
+
+    for (auto _ : state)
+    {
+        hll_union u(lgK(state));
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::DoNotOptimize(u.get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+// Merges of sketches in HLL mode into a union already in HLL mode, without computing the estimate.
+// Arguments are lg_k, the type of the input sketches and the number of input sketches.
+void BM_HllUnionMerge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(2));
+    std::vector<hll_sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(lgK(state), hllType(state), i << (lgK(state) + 1)));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        hll_union u(lgK(state));
+        u.update(sketches.back());
+        state.ResumeTiming();
+
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(num_sketches) * (int64_t(1) << lgK(state)));
+}
+
+// The first estimate of a union after merges into it, which rebuilds KxQ and curMin from the registers.
+// Arguments are lg_k and the type of the input sketches.
+void BM_HllUnionEstimate(benchmark::State & state)
+{
+    const auto sketch1 = makeSketch(lgK(state), hllType(state));
+    const auto sketch2 = makeSketch(lgK(state), hllType(state), size_t(1) << (lgK(state) + 1));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        hll_union u(lgK(state));
+        u.update(sketch1);
+        u.update(sketch2);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(u.get_estimate());
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t(1) << lgK(state)));
+}
+
+// Conversion of a sketch in HLL mode to HLL_8, as the union does with its first input.
+void BM_HllConvertToHll8(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), hllType(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(hll_sketch(sketch, datasketches::HLL_8).get_estimate());
+    state.SetBytesProcessed(state.iterations() * (int64_t(1) << lgK(state)));
+}
+
+void BM_HllUnionGetResult(benchmark::State & state)
+{
+    hll_union u(lgK(state));
+    u.update(makeSketch(lgK(state), datasketches::HLL_8));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(u.get_result(hllType(state)).get_estimate());
+}
+
+void BM_HllSerializeCompact(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), hllType(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize_compact().data());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sketch.get_compact_serialization_bytes()));
+}
+
+void BM_HllSerializeUpdatable(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), hllType(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize_updatable().data());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sketch.get_updatable_serialization_bytes()));
+}
+
+void BM_HllDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch(lgK(state), hllType(state)).serialize_compact();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(hll_sketch::deserialize(bytes.data(), bytes.size()).get_estimate());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+
+// All threads update one shared sketch with the given lg_k
+std::unique_ptr<concurrent_hll_sketch> sharedSketch;
+
+void BM_ConcurrentHllUpdate(benchmark::State & state)
+{
+    if (state.thread_index() == 0)
+        sharedSketch.reset(new concurrent_hll_sketch(static_cast<uint8_t>(state.range(0))));
+    const auto keys = makeKeys<uint64_t>(65536, static_cast<size_t>(state.thread_index()) << 16);
+
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sharedSketch->update(key);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    if (state.thread_index() == 0)
+        sharedSketch.reset();
+}
+
+// Baseline for the above: each thread updates its own HLL_8 sketch, which would have to be merged afterwards
+void BM_HllThreadLocalUpdate(benchmark::State & state)
+{
+    hll_sketch sketch(static_cast<uint8_t>(state.range(0)), datasketches::HLL_8, true);
+    const auto keys = makeKeys<uint64_t>(65536, static_cast<size_t>(state.thread_index()) << 16);
+
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sketch.update(key);
+    }
+
+    benchmark::DoNotOptimize(sketch.get_estimate());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+void BM_ConcurrentHllEstimate(benchmark::State & state)
+{
+    concurrent_hll_sketch sketch(static_cast<uint8_t>(state.range(0)));
+    for (const auto key : makeKeys<uint64_t>(size_t(1) << (state.range(0) + 2)))
+        sketch.update(key);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    state.SetBytesProcessed(state.iterations() * (int64_t(1) << state.range(0)));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_HllUpdate, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_HllUpdate, double)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_HllUpdate, std::string)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_HllUpdateBatch, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_HllUpdateBatch, std::string)->Apply(updateArgs);
+BENCHMARK(BM_HllEstimate)->Apply(sizeArgs);
+BENCHMARK(BM_HllUnion)->ArgsProduct({
+    {12, 21},
+    {datasketches::HLL_4, datasketches::HLL_6, datasketches::HLL_8},
+    {2, 16}});
+BENCHMARK(BM_HllUnionMerge)->ArgsProduct({
+    {12, 21},
+    {datasketches::HLL_4, datasketches::HLL_6, datasketches::HLL_8},
+    {16}});
+BENCHMARK(BM_HllUnionEstimate)->Apply(sizeArgs);
+BENCHMARK(BM_HllConvertToHll8)->Apply(sizeArgs);
+BENCHMARK(BM_HllUnionGetResult)->Apply(sizeArgs);
+BENCHMARK(BM_HllSerializeCompact)->Apply(sizeArgs);
+BENCHMARK(BM_HllSerializeUpdatable)->Apply(sizeArgs);
+BENCHMARK(BM_HllDeserialize)->Apply(sizeArgs);
+BENCHMARK(BM_ConcurrentHllUpdate)->Arg(12)->Arg(21)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_HllThreadLocalUpdate)->Arg(12)->Arg(21)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_ConcurrentHllEstimate)->Arg(10)->Arg(12)->Arg(16)->Arg(21);
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BENCHMARK_KEYS_HPP_
+#define BENCHMARK_KEYS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Deterministic inputs shared by the benchmarks, so that results are comparable between runs and commits
+
+namespace benchmark_keys
+{
+
+// Distinct keys starting at the given offset, so that two calls with overlapping ranges share keys
+template <typename T>
+std::vector<T> makeKeys(size_t size, size_t offset = 0);
+
+template <>
+inline std::vector<uint64_t> makeKeys<uint64_t>(size_t size, size_t offset)
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(size);
+    for (size_t i = offset; i < offset + size; ++i)
+        keys.push_back(static_cast<uint64_t>(i * 0x9e3779b97f4a7c15ULL));
+    return keys;
+}
+
+template <>
+inline std::vector<double> makeKeys<double>(size_t size, size_t offset)
+{
+    std::vector<double> keys;
+    keys.reserve(size);
+    for (size_t i = offset; i < offset + size; ++i)
+        keys.push_back(static_cast<double>(i) * 1.5 + 0.25);
+    return keys;
+}
+
+template <>
+inline std::vector<std::string> makeKeys<std::string>(size_t size, size_t offset)
+{
+    std::vector<std::string> keys;
+    keys.reserve(size);
+    for (size_t i = offset; i < offset + size; ++i)
+        keys.push_back("benchmark-key-" + std::to_string(i * 2654435761ULL));
+    return keys;
+}
+
+// Values drawn from a fixed-seed exponential distribution, a skewed input for the quantile sketches
+template <typename T>
+std::vector<T> makeValues(size_t size, uint64_t seed = 0)
+{
+    std::mt19937_64 generator(seed);
+    std::exponential_distribution<double> distribution(1.0);
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+        values.push_back(static_cast<T>(distribution(generator)));
+    return values;
+}
+
+// Items following a Zipf-like distribution over the given number of distinct items, for the heavy hitter sketches
+inline std::vector<uint64_t> makeZipfItems(size_t size, size_t num_distinct, uint64_t seed = 0)
+{
+    std::vector<double> weights;
+    weights.reserve(num_distinct);
+    for (size_t i = 1; i <= num_distinct; ++i)
+        weights.push_back(1.0 / static_cast<double>(i));
+    std::mt19937_64 generator(seed);
+    std::discrete_distribution<uint64_t> distribution(weights.begin(), weights.end());
+    std::vector<uint64_t> items;
+    items.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+        items.push_back(distribution(generator));
+    return items;
+}
+
+template <typename T>
+int64_t keyBytes(const std::vector<T> & keys)
+{
+    return static_cast<int64_t>(keys.size() * sizeof(T));
+}
+
+inline int64_t keyBytes(const std::vector<std::string> & keys)
+{
+    int64_t bytes = 0;
+    for (const auto & key : keys)
+        bytes += static_cast<int64_t>(key.size());
+    return bytes;
+}
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BENCHMARK_QUANTILES_COMMON_HPP_
+#define BENCHMARK_QUANTILES_COMMON_HPP_
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+// Benchmarks shared by the sketches with the quantiles API: kll_sketch, quantiles_sketch, req_sketch and tdigest.
+// The first argument of every benchmark is the size parameter k of the sketch.
+
+namespace benchmark_quantiles
+{
+
+// Creates a sketch with the given k, specialized for sketches with other constructor arguments
+template <typename Sketch>
+struct sketch_factory
+{
+    static Sketch create(uint16_t k) { return Sketch(k); }
+};
+
+inline uint16_t paramK(const benchmark::State & state)
+{
+    return static_cast<uint16_t>(state.range(0));
+}
+
+template <typename Sketch>
+Sketch makeSketch(uint16_t k, size_t num_values, uint64_t seed = 0)
+{
+    using T = typename Sketch::value_type;
+    auto sketch = sketch_factory<Sketch>::create(k);
+    for (const auto value : benchmark_keys::makeValues<T>(num_values, seed))
+        sketch.update(value);
+    return sketch;
+}
+
+// Arguments are k and the number of values.
+template <typename Sketch>
+void BM_Update(benchmark::State & state)
+{
+    using T = typename Sketch::value_type;
+    const auto values = benchmark_keys::makeValues<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = sketch_factory<Sketch>::create(paramK(state));
+        state.ResumeTiming();
+
+        for (const auto value : values)
+            sketch.update(value);
+
+        benchmark::DoNotOptimize(sketch.is_empty());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(values.size()));
+}
+
+// Arguments are k and the number of sketches of 2^16 values each.
+template <typename Sketch>
+void BM_Merge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(1));
+    std::vector<Sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch<Sketch>(paramK(state), 1 << 16, i));
+
+    for (auto _ : state)
+    {
+        auto target = sketch_factory<Sketch>::create(paramK(state));
+        for (const auto & sketch : sketches)
+            target.merge(sketch);
+        benchmark::DoNotOptimize(target.is_empty());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+// Queries a sketch of 2^20 values. Repeated queries may reuse state cached by the first one.
+template <typename Sketch>
+void BM_GetQuantile(benchmark::State & state)
+{
+    const auto sketch = makeSketch<Sketch>(paramK(state), 1 << 20);
+    double rank = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_quantile(rank));
+        rank = rank < 0.99 ? rank + 0.01 : 0;
+    }
+}
+
+template <typename Sketch>
+void BM_GetRank(benchmark::State & state)
+{
+    using T = typename Sketch::value_type;
+    const auto sketch = makeSketch<Sketch>(paramK(state), 1 << 20);
+    const auto items = benchmark_keys::makeValues<T>(1024, 1);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_rank(items[i]));
+        i = (i + 1) % items.size();
+    }
+}
+
+template <typename Sketch>
+void BM_GetCDF(benchmark::State & state)
+{
+    using T = typename Sketch::value_type;
+    const auto sketch = makeSketch<Sketch>(paramK(state), 1 << 20);
+    std::vector<T> split_points;
+    for (int i = 1; i <= 10; ++i)
+        split_points.push_back(static_cast<T>(i) / 2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.get_CDF(split_points.data(), static_cast<uint32_t>(split_points.size())).data());
+}
+
+// Builds the sorted view behind the queries, which the queries above may cache
+template <typename Sketch>
+void BM_SortedView(benchmark::State & state)
+{
+    const auto sketch = makeSketch<Sketch>(paramK(state), 1 << 20);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.get_sorted_view().size());
+}
+
+// Arguments are k and the number of values.
+template <typename Sketch>
+void BM_Serialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch<Sketch>(paramK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+template <typename Sketch>
+void BM_Deserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch<Sketch>(paramK(state), static_cast<size_t>(state.range(1))).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Sketch::deserialize(bytes.data(), bytes.size()).is_empty());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+#endif
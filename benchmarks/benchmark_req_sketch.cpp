@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <req_sketch.hpp>
+
+#include "benchmark_quantiles_common.hpp"
+
+namespace
+{
+
+using ReqFloat = datasketches::req_sketch<float>;
+using ReqDouble = datasketches::req_sketch<double>;
+
+// Arguments are k and the number of values.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{12, 24, 48}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are k and the number of sketches.
+void mergeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{12, 24, 48}, {2, 16}});
+}
+
+// Arguments are k.
+void queryArgs(benchmark::internal::Benchmark * b)
+{
+    b->Arg(12)->Arg(24)->Arg(48);
+}
+
+}
+
+using namespace benchmark_quantiles;
+
+BENCHMARK_TEMPLATE(BM_Update, ReqFloat)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Update, ReqDouble)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Merge, ReqFloat)->Apply(mergeArgs);
+BENCHMARK_TEMPLATE(BM_Merge, ReqDouble)->Apply(mergeArgs);
+BENCHMARK_TEMPLATE(BM_GetQuantile, ReqFloat)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_GetRank, ReqFloat)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_GetCDF, ReqFloat)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_SortedView, ReqFloat)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_Serialize, ReqFloat)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Deserialize, ReqFloat)->Apply(updateArgs);
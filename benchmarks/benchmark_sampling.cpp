@@ -0,0 +1,173 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ebpps_sketch.hpp>
+#include <var_opt_sketch.hpp>
+#include <var_opt_union.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using VarOptSketch = datasketches::var_opt_sketch<uint64_t>;
+using VarOptUnion = datasketches::var_opt_union<uint64_t>;
+using EbppsSketch = datasketches::ebpps_sketch<uint64_t>;
+using benchmark_keys::makeKeys;
+
+uint32_t paramK(const benchmark::State & state)
+{
+    return static_cast<uint32_t>(state.range(0));
+}
+
+// Arguments are k and the number of items.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{32, 1024, 16384}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are k and the number of sketches.
+void mergeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{32, 1024, 16384}, {2, 16}});
+}
+
+// Arguments are k.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->Arg(32)->Arg(1024)->Arg(16384);
+}
+
+// Sketches are fed 2^18 items with exponentially distributed weights
+template <typename Sketch>
+Sketch makeSketch(uint32_t k, uint64_t seed = 0)
+{
+    const size_t num_items = 1 << 18;
+    const auto items = makeKeys<uint64_t>(num_items, seed * num_items);
+    const auto weights = benchmark_keys::makeValues<double>(num_items, seed);
+    Sketch sketch(k);
+    for (size_t i = 0; i < num_items; ++i)
+        sketch.update(items[i], weights[i]);
+    return sketch;
+}
+
+template <typename Sketch>
+void BM_SamplingUpdate(benchmark::State & state)
+{
+    const size_t num_items = static_cast<size_t>(state.range(1));
+    const auto items = makeKeys<uint64_t>(num_items);
+    const auto weights = benchmark_keys::makeValues<double>(num_items);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Sketch sketch(paramK(state));
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < num_items; ++i)
+            sketch.update(items[i], weights[i]);
+
+        benchmark::DoNotOptimize(sketch.get_n());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_items));
+}
+
+void BM_VarOptUnion(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(1));
+    std::vector<VarOptSketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch<VarOptSketch>(paramK(state), i));
+
+    for (auto _ : state)
+    {
+        VarOptUnion u(paramK(state));
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::DoNotOptimize(u.get_result().get_n());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+void BM_EbppsMerge(benchmark::State & state)
+{
+    const size_t num_sketches = static_cast<size_t>(state.range(1));
+    std::vector<EbppsSketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch<EbppsSketch>(paramK(state), i));
+
+    for (auto _ : state)
+    {
+        EbppsSketch target(paramK(state));
+        for (const auto & sketch : sketches)
+            target.merge(sketch);
+        benchmark::DoNotOptimize(target.get_n());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_sketches));
+}
+
+// Estimates the total weight of the odd items
+void BM_VarOptSubsetSum(benchmark::State & state)
+{
+    const auto sketch = makeSketch<VarOptSketch>(paramK(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.estimate_subset_sum([](uint64_t item) { return (item & 1) != 0; }).estimate);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketch.get_num_samples()));
+}
+
+void BM_EbppsGetResult(benchmark::State & state)
+{
+    const auto sketch = makeSketch<EbppsSketch>(paramK(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.get_result().size());
+}
+
+template <typename Sketch>
+void BM_SamplingSerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch<Sketch>(paramK(state));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+template <typename Sketch>
+void BM_SamplingDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch<Sketch>(paramK(state)).serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Sketch::deserialize(bytes.data(), bytes.size()).get_n());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_SamplingUpdate, VarOptSketch)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_SamplingUpdate, EbppsSketch)->Apply(updateArgs);
+BENCHMARK(BM_VarOptUnion)->Apply(mergeArgs);
+BENCHMARK(BM_EbppsMerge)->Apply(mergeArgs);
+BENCHMARK(BM_VarOptSubsetSum)->Apply(sizeArgs);
+BENCHMARK(BM_EbppsGetResult)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_SamplingSerialize, VarOptSketch)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_SamplingSerialize, EbppsSketch)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_SamplingDeserialize, VarOptSketch)->Apply(sizeArgs);
+BENCHMARK_TEMPLATE(BM_SamplingDeserialize, EbppsSketch)->Apply(sizeArgs);
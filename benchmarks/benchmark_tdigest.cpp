@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <tdigest.hpp>
+
+#include "benchmark_quantiles_common.hpp"
+
+namespace
+{
+
+using TDigestFloat = datasketches::tdigest_float;
+using TDigestDouble = datasketches::tdigest_double;
+
+// Arguments are k and the number of values.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{100, 200, 400}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are k and the number of sketches.
+void mergeArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{100, 200, 400}, {2, 16}});
+}
+
+// Arguments are k.
+void queryArgs(benchmark::internal::Benchmark * b)
+{
+    b->Arg(100)->Arg(200)->Arg(400);
+}
+
+}
+
+using namespace benchmark_quantiles;
+
+// t-digest has no sorted view, its queries interpolate between the centroids
+BENCHMARK_TEMPLATE(BM_Update, TDigestFloat)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Update, TDigestDouble)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Merge, TDigestFloat)->Apply(mergeArgs);
+BENCHMARK_TEMPLATE(BM_Merge, TDigestDouble)->Apply(mergeArgs);
+BENCHMARK_TEMPLATE(BM_GetQuantile, TDigestDouble)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_GetRank, TDigestDouble)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_GetCDF, TDigestDouble)->Apply(queryArgs);
+BENCHMARK_TEMPLATE(BM_Serialize, TDigestDouble)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_Deserialize, TDigestDouble)->Apply(updateArgs);
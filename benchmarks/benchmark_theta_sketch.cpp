@@ -0,0 +1,500 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <arena_allocator.hpp>
+#include <benchmark/benchmark.h>
+#include <bit_packing.hpp>
+#include <concurrent_theta_sketch.hpp>
+#include <theta_a_not_b.hpp>
+#include <theta_intersection.hpp>
+#include <theta_sketch.hpp>
+#include <theta_union.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using datasketches::arena_allocator;
+using datasketches::compact_theta_sketch;
+using datasketches::concurrent_theta_sketch;
+using datasketches::monotonic_arena;
+using datasketches::theta_a_not_b;
+using datasketches::theta_intersection;
+using datasketches::theta_union;
+using datasketches::update_theta_sketch;
+using datasketches::wrapped_compact_theta_sketch;
+using benchmark_keys::makeKeys;
+
+uint8_t lgK(const benchmark::State & state)
+{
+    return static_cast<uint8_t>(state.range(0));
+}
+
+// Arguments are lg_k and the number of keys.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16, 20}, benchmark::CreateRange(1024, 1 << 22, 64)});
+}
+
+// Arguments are lg_k and the number of sketches.
+void setOperationArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16}, {2, 16}});
+}
+
+// Arguments are lg_k and the number of sketches, up to the fan-in of a rollup.
+void unionArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16}, {2, 16, 128}});
+}
+
+// Arguments are lg_k, sketches are in estimation mode.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->DenseRange(10, 16, 2);
+}
+
+update_theta_sketch makeSketch(uint8_t lg_k, size_t num_keys, size_t offset = 0)
+{
+    auto sketch = update_theta_sketch::builder().set_lg_k(lg_k).build();
+    for (const auto key : makeKeys<uint64_t>(num_keys, offset))
+        sketch.update(key);
+    return sketch;
+}
+
+// Sketches of 2^(lg_k+2) keys each, every sketch sharing half of its keys with the next
+std::vector<compact_theta_sketch> makeCompactSketches(uint8_t lg_k, size_t num_sketches)
+{
+    const size_t num_keys = size_t(1) << (lg_k + 2);
+    std::vector<compact_theta_sketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(lg_k, num_keys, i * num_keys / 2).compact());
+    return sketches;
+}
+
+template <typename T>
+void BM_ThetaUpdate(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = update_theta_sketch::builder().set_lg_k(lgK(state)).build();
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+// Arguments are lg_k, the number of keys and the table layout
+void BM_ThetaUpdateLayout(benchmark::State & state)
+{
+    const auto keys = makeKeys<uint64_t>(static_cast<size_t>(state.range(1)));
+    const auto layout = static_cast<update_theta_sketch::table_layout>(state.range(2));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = update_theta_sketch::builder().set_lg_k(lgK(state)).set_table_layout(layout).build();
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+template <typename T>
+void BM_ThetaUpdateBatch(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = update_theta_sketch::builder().set_lg_k(lgK(state)).build();
+        state.ResumeTiming();
+
+        sketch.update_batch(keys.data(), keys.size());
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+void BM_ThetaCompact(benchmark::State & state)
+{
+    const bool ordered = state.range(1) != 0;
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2));
+    for (auto _ : state)
+    {
+        const auto compact = sketch.compact(ordered);
+        benchmark::DoNotOptimize(compact.get_num_retained());
+    }
+}
+
+void BM_ThetaEstimate(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sketch.get_estimate());
+        benchmark::DoNotOptimize(sketch.get_lower_bound(2));
+        benchmark::DoNotOptimize(sketch.get_upper_bound(2));
+    }
+}
+
+void BM_ThetaUnion(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        auto u = theta_union::builder().set_lg_k(lgK(state)).build();
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_ThetaUnionUpdateMany(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        auto u = theta_union::builder().set_lg_k(lgK(state)).build();
+        u.update_many(sketches.begin(), sketches.end());
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+// Third argument is the number of threads.
+void BM_ThetaUnionParallel(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        auto u = theta_union::builder().set_lg_k(lgK(state)).build();
+        u.update_parallel(sketches.begin(), sketches.end(), static_cast<unsigned>(state.range(2)));
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+// Polling the estimate of a union that is not updated in between.
+// Second argument selects get_result().get_estimate() (0), get_estimate() (1) or a cached result (2).
+void BM_ThetaUnionEstimate(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), 4);
+    auto u = theta_union::builder().set_lg_k(lgK(state)).set_cache_result(state.range(1) == 2).build();
+    for (const auto & sketch : sketches)
+        u.update(sketch);
+    if (state.range(1) == 1)
+    {
+        for (auto _ : state)
+            benchmark::DoNotOptimize(u.get_estimate());
+    }
+    else
+    {
+        for (auto _ : state)
+            benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+}
+
+void BM_ThetaIntersection(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        theta_intersection intersection;
+        for (const auto & sketch : sketches)
+            intersection.update(sketch);
+        benchmark::DoNotOptimize(intersection.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_ThetaIntersectionUpdateMany(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        theta_intersection intersection;
+        intersection.update_many(sketches.begin(), sketches.end());
+        benchmark::DoNotOptimize(intersection.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_ThetaANotB(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), 2);
+    theta_a_not_b a_not_b;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a_not_b.compute(sketches[0], sketches[1]).get_estimate());
+}
+
+// A query of a union, an intersection and a difference of the same sketches.
+template <typename Allocator>
+double runSetOperations(uint8_t lg_k, const std::vector<compact_theta_sketch> & sketches, const Allocator & allocator)
+{
+    auto u = typename datasketches::theta_union_alloc<Allocator>::builder(allocator).set_lg_k(lg_k).build();
+    datasketches::theta_intersection_alloc<Allocator> intersection(datasketches::DEFAULT_SEED, allocator);
+    for (const auto & sketch : sketches)
+    {
+        u.update(sketch);
+        intersection.update(sketch);
+    }
+    const auto union_result = u.get_result();
+    datasketches::theta_a_not_b_alloc<Allocator> a_not_b(datasketches::DEFAULT_SEED, allocator);
+    return a_not_b.compute(union_result, intersection.get_result()).get_estimate();
+}
+
+// Third argument selects the default allocator (0) or a monotonic arena that is reset after every query (1).
+void BM_ThetaSetOperationsArena(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    if (state.range(2) == 0)
+    {
+        const std::allocator<uint64_t> allocator;
+        for (auto _ : state)
+            benchmark::DoNotOptimize(runSetOperations(lgK(state), sketches, allocator));
+    }
+    else
+    {
+        monotonic_arena arena;
+        const arena_allocator<uint64_t> allocator(arena);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(runSetOperations(lgK(state), sketches, allocator));
+            arena.reset();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_ThetaSerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sketch.get_serialized_size_bytes()));
+}
+
+void BM_ThetaSerializeCompressed(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize_compressed().data());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(sketch.get_serialized_size_bytes()));
+}
+
+void BM_ThetaDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact().serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(compact_theta_sketch::deserialize(bytes.data(), bytes.size()).get_estimate());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+void BM_ThetaDeserializeCompressed(benchmark::State & state)
+{
+    const auto bytes = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact().serialize_compressed();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(compact_theta_sketch::deserialize(bytes.data(), bytes.size()).get_estimate());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+// Serialized images of makeCompactSketches(), compressed if the third argument is not zero
+std::vector<compact_theta_sketch::vector_bytes> makeImages(const benchmark::State & state)
+{
+    std::vector<compact_theta_sketch::vector_bytes> images;
+    for (const auto & sketch : makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1))))
+        images.push_back(state.range(2) != 0 ? sketch.serialize_compressed() : sketch.serialize());
+    return images;
+}
+
+// Union of serialized images wrapped in place, as over a memory-mapped column of sketches
+void BM_ThetaWrappedUnion(benchmark::State & state)
+{
+    const auto images = makeImages(state);
+    for (auto _ : state)
+    {
+        auto u = theta_union::builder().set_lg_k(lgK(state)).build();
+        for (const auto & bytes : images)
+            u.update(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(images.size()));
+}
+
+void BM_ThetaWrappedUnionUpdateMany(benchmark::State & state)
+{
+    const auto images = makeImages(state);
+    for (auto _ : state)
+    {
+        std::vector<wrapped_compact_theta_sketch> sketches;
+        for (const auto & bytes : images)
+            sketches.push_back(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+        auto u = theta_union::builder().set_lg_k(lgK(state)).build();
+        u.update_many(sketches.begin(), sketches.end());
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(images.size()));
+}
+
+void BM_ThetaWrappedIntersection(benchmark::State & state)
+{
+    const auto images = makeImages(state);
+    for (auto _ : state)
+    {
+        theta_intersection intersection;
+        for (const auto & bytes : images)
+            intersection.update(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+        benchmark::DoNotOptimize(intersection.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(images.size()));
+}
+
+// Decodes 4096 deltas of the given number of bits with the given instruction set (0 scalar, 1 AVX2, 2 AVX-512)
+void BM_ThetaUnpackDeltas(benchmark::State & state)
+{
+    const auto bits = static_cast<uint8_t>(state.range(0));
+    const auto level = static_cast<datasketches::simd_ops::simd_level>(state.range(1));
+    if (level > datasketches::simd_ops::get_simd_level())
+    {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    const uint32_t num_values = 4096;
+    std::vector<uint64_t> deltas(num_values);
+    const auto keys = makeKeys<uint64_t>(num_values);
+    for (uint32_t i = 0; i < num_values; ++i)
+        deltas[i] = keys[i] >> (64 - bits);
+    std::vector<uint8_t> bytes(num_values / 8 * bits);
+    for (uint32_t i = 0; i < num_values; i += 8)
+        datasketches::pack_bits_block8(&deltas[i], &bytes[i / 8 * bits], bits);
+    std::vector<uint64_t> values(num_values);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(datasketches::unpack_deltas_block8(values.data(), bytes.data(), bits, num_values / 8, 0,
+            bytes.data() + bytes.size(), level));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * num_values);
+}
+
+// Wraps a serialized sketch and iterates over its hashes, which decodes a compressed image
+void BM_ThetaWrapIterate(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    const auto bytes = state.range(1) != 0 ? sketch.serialize_compressed() : sketch.serialize();
+    for (auto _ : state)
+    {
+        const auto wrapped = wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size());
+        uint64_t sum = 0;
+        for (const auto hash : wrapped)
+            sum += hash;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketch.get_num_retained()));
+}
+
+std::unique_ptr<concurrent_theta_sketch> sharedSketch;
+
+// Every thread updates the shared sketch through its own writer with distinct keys
+void BM_ConcurrentThetaUpdate(benchmark::State & state)
+{
+    if (state.thread_index() == 0)
+        sharedSketch.reset(new concurrent_theta_sketch(concurrent_theta_sketch::builder().set_lg_k(lgK(state)).build()));
+    const auto keys = makeKeys<uint64_t>(1 << 16, static_cast<size_t>(state.thread_index()) << 32);
+    for (auto _ : state)
+    {
+        // the sketch is only guaranteed to exist once all threads enter the loop
+        concurrent_theta_sketch::writer writer(*sharedSketch);
+        for (const auto key : keys)
+            writer.update(key);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    if (state.thread_index() == 0)
+        sharedSketch.reset();
+}
+
+// Baseline for the above: each thread updates its own sketch, which would have to be unioned afterwards
+void BM_ThetaThreadLocalUpdate(benchmark::State & state)
+{
+    auto sketch = update_theta_sketch::builder().set_lg_k(lgK(state)).build();
+    const auto keys = makeKeys<uint64_t>(1 << 16, static_cast<size_t>(state.thread_index()) << 32);
+    for (auto _ : state)
+    {
+        for (const auto key : keys)
+            sketch.update(key);
+    }
+
+    benchmark::DoNotOptimize(sketch.get_estimate());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_ThetaUpdate, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_ThetaUpdate, double)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_ThetaUpdate, std::string)->Apply(updateArgs);
+BENCHMARK(BM_ThetaUpdateLayout)->ArgsProduct({{12, 16}, {1 << 16, 1 << 20}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_ThetaUpdateBatch, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_ThetaUpdateBatch, std::string)->Apply(updateArgs);
+BENCHMARK(BM_ThetaCompact)->ArgsProduct({{10, 12, 16}, {0, 1}});
+BENCHMARK(BM_ThetaEstimate)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaUnion)->Apply(unionArgs);
+BENCHMARK(BM_ThetaUnionUpdateMany)->Apply(unionArgs);
+BENCHMARK(BM_ThetaUnionParallel)->ArgsProduct({{10, 12}, {128, 1024}, {1, 2, 4, 8}})->UseRealTime();
+BENCHMARK(BM_ThetaUnionEstimate)->ArgsProduct({{10, 12, 16}, {0, 1, 2}});
+BENCHMARK(BM_ThetaIntersection)->Apply(setOperationArgs);
+BENCHMARK(BM_ThetaIntersectionUpdateMany)->Apply(setOperationArgs);
+BENCHMARK(BM_ThetaANotB)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaSetOperationsArena)->ArgsProduct({{10, 12}, {2, 16}, {0, 1}});
+BENCHMARK(BM_ThetaSerialize)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaSerializeCompressed)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaDeserialize)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaDeserializeCompressed)->Apply(sizeArgs);
+BENCHMARK(BM_ThetaWrapIterate)->ArgsProduct({{10, 12, 16}, {0, 1}});
+BENCHMARK(BM_ThetaUnpackDeltas)->ArgsProduct({{20, 40, 53, 60}, {0, 1, 2}});
+BENCHMARK(BM_ThetaWrappedUnion)->ArgsProduct({{10, 12, 16}, {2, 16, 128}, {0, 1}});
+BENCHMARK(BM_ThetaWrappedUnionUpdateMany)->ArgsProduct({{10, 12, 16}, {2, 16, 128}, {0, 1}});
+BENCHMARK(BM_ThetaWrappedIntersection)->ArgsProduct({{10, 12, 16}, {2, 16}, {0, 1}});
+BENCHMARK(BM_ConcurrentThetaUpdate)->Arg(12)->Arg(16)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_ThetaThreadLocalUpdate)->Arg(12)->Arg(16)->ThreadRange(1, 8)->UseRealTime();
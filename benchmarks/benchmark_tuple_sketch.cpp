@@ -0,0 +1,240 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <tuple_a_not_b.hpp>
+#include <tuple_intersection.hpp>
+#include <tuple_sketch.hpp>
+#include <tuple_union.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark_keys.hpp"
+
+namespace
+{
+
+using UpdateSketch = datasketches::update_tuple_sketch<double>;
+using CompactSketch = datasketches::compact_tuple_sketch<double>;
+using Policy = datasketches::default_tuple_union_policy<double>;
+using Union = datasketches::tuple_union<double>;
+using Intersection = datasketches::tuple_intersection<double, Policy>;
+using ANotB = datasketches::tuple_a_not_b<double>;
+using benchmark_keys::makeKeys;
+
+// Summary that fills a cache line, probing an entry of it drags the whole line in
+struct LargeSummary
+{
+    double values[8];
+};
+
+struct LargeSummaryPolicy
+{
+    LargeSummary create() const { return LargeSummary(); }
+    void update(LargeSummary & summary, double value) const
+    {
+        for (auto & v : summary.values)
+            v += value;
+    }
+};
+
+using LargeSummarySketch = datasketches::update_tuple_sketch<LargeSummary, double, LargeSummaryPolicy>;
+
+uint8_t lgK(const benchmark::State & state)
+{
+    return static_cast<uint8_t>(state.range(0));
+}
+
+// Arguments are lg_k and the number of keys.
+void updateArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16}, benchmark::CreateRange(1024, 1 << 20, 32)});
+}
+
+// Arguments are lg_k and the number of sketches.
+void setOperationArgs(benchmark::internal::Benchmark * b)
+{
+    b->ArgsProduct({{10, 12, 16}, {2, 16}});
+}
+
+// Arguments are lg_k, sketches are in estimation mode.
+void sizeArgs(benchmark::internal::Benchmark * b)
+{
+    b->DenseRange(10, 16, 2);
+}
+
+UpdateSketch makeSketch(uint8_t lg_k, size_t num_keys, size_t offset = 0)
+{
+    auto sketch = UpdateSketch::builder().set_lg_k(lg_k).build();
+    for (const auto key : makeKeys<uint64_t>(num_keys, offset))
+        sketch.update(key, 1.0);
+    return sketch;
+}
+
+// Sketches of 2^(lg_k+2) keys each, every sketch sharing half of its keys with the next
+std::vector<CompactSketch> makeCompactSketches(uint8_t lg_k, size_t num_sketches)
+{
+    const size_t num_keys = size_t(1) << (lg_k + 2);
+    std::vector<CompactSketch> sketches;
+    for (size_t i = 0; i < num_sketches; ++i)
+        sketches.push_back(makeSketch(lg_k, num_keys, i * num_keys / 2).compact());
+    return sketches;
+}
+
+template <typename T>
+void BM_TupleUpdate(benchmark::State & state)
+{
+    const auto keys = makeKeys<T>(static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = UpdateSketch::builder().set_lg_k(lgK(state)).build();
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key, 1.0);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+    state.SetBytesProcessed(state.iterations() * benchmark_keys::keyBytes(keys));
+}
+
+// Arguments are lg_k, the number of keys and the table layout
+template <typename Sketch>
+void BM_TupleUpdateLayout(benchmark::State & state)
+{
+    const auto keys = makeKeys<uint64_t>(static_cast<size_t>(state.range(1)));
+    const auto layout = static_cast<typename Sketch::table_layout>(state.range(2));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto sketch = typename Sketch::builder().set_lg_k(lgK(state)).set_table_layout(layout).build();
+        state.ResumeTiming();
+
+        for (const auto & key : keys)
+            sketch.update(key, 1.0);
+
+        benchmark::DoNotOptimize(sketch.get_estimate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+void BM_TupleCompact(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.compact().get_num_retained());
+}
+
+// Sums the summaries of the retained entries, the typical query of a tuple sketch
+void BM_TupleSumSummaries(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (const auto & entry : sketch)
+            sum += entry.second;
+        benchmark::DoNotOptimize(sum / sketch.get_theta());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketch.get_num_retained()));
+}
+
+void BM_TupleUnion(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        auto u = Union::builder().set_lg_k(lgK(state)).build();
+        for (const auto & sketch : sketches)
+            u.update(sketch);
+        benchmark::DoNotOptimize(u.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_TupleIntersection(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        Intersection intersection;
+        for (const auto & sketch : sketches)
+            intersection.update(sketch);
+        benchmark::DoNotOptimize(intersection.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_TupleIntersectionUpdateMany(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), static_cast<size_t>(state.range(1)));
+    for (auto _ : state)
+    {
+        Intersection intersection;
+        intersection.update_many(sketches.begin(), sketches.end());
+        benchmark::DoNotOptimize(intersection.get_result().get_estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sketches.size()));
+}
+
+void BM_TupleANotB(benchmark::State & state)
+{
+    const auto sketches = makeCompactSketches(lgK(state), 2);
+    ANotB a_not_b;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a_not_b.compute(sketches[0], sketches[1]).get_estimate());
+}
+
+void BM_TupleSerialize(benchmark::State & state)
+{
+    const auto sketch = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sketch.serialize().data());
+}
+
+void BM_TupleDeserialize(benchmark::State & state)
+{
+    const auto bytes = makeSketch(lgK(state), size_t(1) << (lgK(state) + 2)).compact().serialize();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(CompactSketch::deserialize(bytes.data(), bytes.size()).get_estimate());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_TupleUpdate, uint64_t)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_TupleUpdate, double)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_TupleUpdate, std::string)->Apply(updateArgs);
+BENCHMARK_TEMPLATE(BM_TupleUpdateLayout, UpdateSketch)->ArgsProduct({{12, 16}, {1 << 16, 1 << 20}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_TupleUpdateLayout, LargeSummarySketch)->ArgsProduct({{12, 16}, {1 << 16, 1 << 20}, {0, 1}});
+BENCHMARK(BM_TupleCompact)->Apply(sizeArgs);
+BENCHMARK(BM_TupleSumSummaries)->Apply(sizeArgs);
+BENCHMARK(BM_TupleUnion)->Apply(setOperationArgs);
+BENCHMARK(BM_TupleIntersection)->Apply(setOperationArgs);
+BENCHMARK(BM_TupleIntersectionUpdateMany)->Apply(setOperationArgs);
+BENCHMARK(BM_TupleANotB)->Apply(sizeArgs);
+BENCHMARK(BM_TupleSerialize)->Apply(sizeArgs);
+BENCHMARK(BM_TupleDeserialize)->Apply(sizeArgs);
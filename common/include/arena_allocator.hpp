@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef ARENA_ALLOCATOR_HPP_
+#define ARENA_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace datasketches {
+
+// forward declaration
+template<typename A> class monotonic_arena_alloc;
+
+// alias with default upstream allocator for convenience
+using monotonic_arena = monotonic_arena_alloc<std::allocator<char>>;
+
+/**
+ * Monotonic arena: hands out memory from a list of blocks by bumping a pointer,
+ * ignores deallocation and makes all of its memory available again on reset().
+ *
+ * The blocks are obtained from the upstream allocator and kept until the arena is destroyed
+ * or release() is called. A workload that is repeated between resets takes the same blocks again,
+ * so after the first pass it runs without any calls to the upstream allocator.
+ * This is meant for short-lived objects such as set operations and their results
+ * that are built and dropped many times on the same thread, for instance while answering a query.
+ *
+ * Everything allocated from the arena must be destroyed before reset() or release().
+ * The arena is not thread-safe.
+ */
+template<typename Allocator = std::allocator<char>>
+class monotonic_arena_alloc {
+public:
+  static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * Constructor. No memory is allocated until the first allocation.
+   * @param block_size size of the first block in bytes, each new block is twice the size of the previous one
+   * @param allocator upstream allocator to obtain blocks from
+   */
+  explicit monotonic_arena_alloc(size_t block_size = DEFAULT_BLOCK_SIZE, const Allocator& allocator = Allocator());
+
+  // allocators hold the address of the arena
+  monotonic_arena_alloc(const monotonic_arena_alloc&) = delete;
+  monotonic_arena_alloc& operator=(const monotonic_arena_alloc&) = delete;
+
+  ~monotonic_arena_alloc();
+
+  /**
+   * Allocates memory from the current block or from the next block that fits.
+   * Adds a new block if none of the remaining blocks fit.
+   * @param size in bytes
+   * @param alignment power of 2
+   * @return pointer to the allocated memory
+   */
+  void* allocate(size_t size, size_t alignment);
+
+  /**
+   * Makes all blocks available for allocation again without returning them upstream.
+   */
+  void reset();
+
+  /**
+   * Returns all blocks to the upstream allocator.
+   */
+  void release();
+
+  /**
+   * @return number of blocks obtained from the upstream allocator
+   */
+  size_t get_num_blocks() const;
+
+  /**
+   * @return total size of the blocks in bytes
+   */
+  size_t get_capacity() const;
+
+  /**
+   * @return number of bytes handed out since the last reset including alignment padding
+   * and the unused ends of the blocks that were skipped
+   */
+  size_t get_bytes_used() const;
+
+private:
+  struct block {
+    char* data;
+    size_t size;
+  };
+  using AllocBlock = typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+
+  Allocator allocator_;
+  std::vector<block, AllocBlock> blocks_;
+  size_t next_block_size_;
+  size_t current_; // index of the block to allocate from
+  size_t offset_; // in the current block
+  size_t bytes_used_; // in the blocks before the current one
+};
+
+/**
+ * Allocator adaptor that takes memory from a monotonic arena.
+ * Deallocation does nothing, the memory is reused after the arena is reset.
+ *
+ * Can be given to the set operations and sketches in place of the default allocator, for example:
+ * @code
+ * monotonic_arena arena;
+ * using allocator = arena_allocator<uint64_t>;
+ * for (const auto& query: queries) {
+ *   {
+ *     auto u = theta_union_alloc<allocator>::builder(allocator(arena)).build();
+ *     for (const auto& sketch: query.sketches) u.update(sketch);
+ *     answer(u.get_result().get_estimate());
+ *   } // the union and its result must be destroyed before reset
+ *   arena.reset();
+ * }
+ * @endcode
+ * There is no default constructor: an instance bound to an arena must be passed explicitly.
+ */
+template<typename T, typename Allocator = std::allocator<char>>
+class arena_allocator {
+public:
+  using value_type = T;
+  using arena_type = monotonic_arena_alloc<Allocator>;
+
+  template<typename U>
+  struct rebind { using other = arena_allocator<U, Allocator>; };
+
+  /**
+   * Constructor
+   * @param arena to allocate from, must outlive the allocator and everything allocated with it
+   */
+  explicit arena_allocator(arena_type& arena) noexcept: arena_(&arena) {}
+
+  template<typename U>
+  arena_allocator(const arena_allocator<U, Allocator>& other) noexcept: arena_(other.arena_) {}
+
+  T* allocate(size_t n) {
+    if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) noexcept {}
+
+  /**
+   * @return arena this allocator takes memory from
+   */
+  arena_type& get_arena() const { return *arena_; }
+
+private:
+  arena_type* arena_;
+
+  template<typename U, typename B> friend class arena_allocator;
+};
+
+template<typename T, typename U, typename A>
+bool operator==(const arena_allocator<T, A>& a, const arena_allocator<U, A>& b) {
+  return &a.get_arena() == &b.get_arena();
+}
+
+template<typename T, typename U, typename A>
+bool operator!=(const arena_allocator<T, A>& a, const arena_allocator<U, A>& b) {
+  return !(a == b);
+}
+
+} /* namespace datasketches */
+
+#include "arena_allocator_impl.hpp"
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef ARENA_ALLOCATOR_IMPL_HPP_
+#define ARENA_ALLOCATOR_IMPL_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "arena_allocator.hpp"
+
+namespace datasketches {
+
+template<typename A>
+const size_t monotonic_arena_alloc<A>::DEFAULT_BLOCK_SIZE;
+
+template<typename A>
+monotonic_arena_alloc<A>::monotonic_arena_alloc(size_t block_size, const A& allocator):
+allocator_(allocator),
+blocks_(AllocBlock(allocator)),
+next_block_size_(block_size),
+current_(0),
+offset_(0),
+bytes_used_(0)
+{
+  if (block_size == 0) throw std::invalid_argument("block size must be positive");
+}
+
+template<typename A>
+monotonic_arena_alloc<A>::~monotonic_arena_alloc() {
+  release();
+}
+
+template<typename A>
+void* monotonic_arena_alloc<A>::allocate(size_t size, size_t alignment) {
+  while (true) {
+    if (current_ < blocks_.size()) {
+      const block& b = blocks_[current_];
+      const uintptr_t address = reinterpret_cast<uintptr_t>(b.data) + offset_;
+      const size_t padding = static_cast<size_t>((alignment - (address & (alignment - 1))) & (alignment - 1));
+      if (padding <= b.size - offset_ && size <= b.size - offset_ - padding) {
+        offset_ += padding + size;
+        return b.data + offset_ - size;
+      }
+      // the rest of this block is skipped until reset
+      bytes_used_ += b.size;
+      ++current_;
+      offset_ = 0;
+    } else {
+      const size_t block_size = std::max(next_block_size_, size + alignment);
+      block b = {allocator_.allocate(block_size), block_size};
+      blocks_.push_back(b);
+      next_block_size_ = block_size * 2;
+    }
+  }
+}
+
+template<typename A>
+void monotonic_arena_alloc<A>::reset() {
+  current_ = 0;
+  offset_ = 0;
+  bytes_used_ = 0;
+}
+
+template<typename A>
+void monotonic_arena_alloc<A>::release() {
+  for (const block& b: blocks_) allocator_.deallocate(b.data, b.size);
+  std::vector<block, AllocBlock>(AllocBlock(allocator_)).swap(blocks_);
+  reset();
+}
+
+template<typename A>
+size_t monotonic_arena_alloc<A>::get_num_blocks() const {
+  return blocks_.size();
+}
+
+template<typename A>
+size_t monotonic_arena_alloc<A>::get_capacity() const {
+  size_t capacity = 0;
+  for (const block& b: blocks_) capacity += b.size;
+  return capacity;
+}
+
+template<typename A>
+size_t monotonic_arena_alloc<A>::get_bytes_used() const {
+  return bytes_used_ + offset_;
+}
+
+} /* namespace datasketches */
+
+#endif
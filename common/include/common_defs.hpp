@@ -58,6 +58,16 @@ namespace random_utils {
 // usually has no additional cost
 template<typename T> void unused(T&&...) {}
 
+// hint the processor to fetch the cache line containing a given address ahead of a random access
+// no-op for compilers without the builtin
+static inline void prefetch(const void* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr);
+#else
+  unused(ptr);
+#endif
+}
+
 // common helping functions
 // TODO: find a better place for them
 
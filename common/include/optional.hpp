@@ -27,7 +27,9 @@
 using std::optional;
 #else
 
+#include <new>
 #include <type_traits>
+#include <utility>
 
 namespace datasketches {
 
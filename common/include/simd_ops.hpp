@@ -0,0 +1,350 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _SIMD_OPS_HPP_
+#define _SIMD_OPS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DATASKETCHES_SIMD_X86
+#define DATASKETCHES_SIMD_INLINE inline __attribute__((always_inline))
+#define DATASKETCHES_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define DATASKETCHES_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,popcnt")))
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace datasketches {
+
+/**
+ * Element-wise kernels over arrays, used to merge sketches.
+ *
+ * On x86 with GCC or Clang, AVX2 and AVX-512 versions of each kernel are compiled next to
+ * the portable one, and the widest version supported by the CPU is chosen at run time.
+ * Other platforms use the portable loops.
+ *
+ * The arrays need no particular alignment. None of the methods perform bounds checks.
+ */
+namespace simd_ops {
+
+  /// Instruction sets the kernels can use
+  enum simd_level {
+    SCALAR, ///< portable loops
+    AVX2,   ///< 256-bit vectors
+    AVX512  ///< 512-bit vectors
+  };
+
+  /**
+   * @return the widest instruction set supported by the CPU and the compiler
+   */
+  static inline simd_level detect_simd_level() {
+#ifdef DATASKETCHES_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return AVX512;
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+#endif
+    return SCALAR;
+  }
+
+  /**
+   * @return the instruction set used by default, detected once
+   */
+  static inline simd_level get_simd_level() {
+    static const simd_level level = detect_simd_level();
+    return level;
+  }
+
+  // Merging many arrays proceeds in chunks of the target of this size,
+  // so that the chunk stays in L1 cache while the sources stream through
+  static const size_t MERGE_CHUNK_BYTES = 8192;
+
+  template<typename T>
+  static inline void add_scalar(T* tgt, const T* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) tgt[i] += src[i];
+  }
+
+  static inline uint64_t popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (word * 0x0101010101010101ULL) >> 56;
+#endif
+  }
+
+  /// Bitwise operations for combining bit arrays
+  enum bit_op { BIT_OR, BIT_AND };
+
+  template<bit_op OP, typename T>
+  static inline T apply_bit_op(T a, T b) {
+    return OP == BIT_OR ? (a | b) : (a & b);
+  }
+
+  // Combines src into tgt with a bitwise operation and returns the number of bits set in tgt if COUNT
+  template<bit_op OP, bool COUNT>
+  static inline uint64_t combine_bits_scalar(uint8_t* tgt, const uint8_t* src, size_t length_bytes) {
+    uint64_t num_bits_set = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length_bytes; i += sizeof(uint64_t)) {
+      uint64_t a, b;
+      std::memcpy(&a, tgt + i, sizeof(a));
+      std::memcpy(&b, src + i, sizeof(b));
+      a = apply_bit_op<OP>(a, b);
+      std::memcpy(tgt + i, &a, sizeof(a));
+      if (COUNT) num_bits_set += popcount(a);
+    }
+    for (; i < length_bytes; ++i) {
+      tgt[i] = apply_bit_op<OP>(tgt[i], src[i]);
+      if (COUNT) num_bits_set += popcount(tgt[i]);
+    }
+    return num_bits_set;
+  }
+
+#ifdef DATASKETCHES_SIMD_X86
+
+  // The generic vector bodies below are inlined into the target-specific wrappers
+  // and compiled there with the corresponding instruction set.
+
+  template<typename T, size_t VECTOR_BYTES>
+  struct vector_of {
+    typedef T type __attribute__((vector_size(VECTOR_BYTES)));
+  };
+
+  template<typename T, size_t VECTOR_BYTES>
+  static DATASKETCHES_SIMD_INLINE void add_vectors(T* tgt, const T* src, size_t n) {
+    typedef typename vector_of<T, VECTOR_BYTES>::type vector_type;
+    const size_t lanes = VECTOR_BYTES / sizeof(T);
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes) {
+      vector_type a0, a1, b0, b1;
+      std::memcpy(&a0, tgt + i, VECTOR_BYTES);
+      std::memcpy(&a1, tgt + i + lanes, VECTOR_BYTES);
+      std::memcpy(&b0, src + i, VECTOR_BYTES);
+      std::memcpy(&b1, src + i + lanes, VECTOR_BYTES);
+      a0 += b0;
+      a1 += b1;
+      std::memcpy(tgt + i, &a0, VECTOR_BYTES);
+      std::memcpy(tgt + i + lanes, &a1, VECTOR_BYTES);
+    }
+    for (; i < n; ++i) tgt[i] += src[i];
+  }
+
+  template<bit_op OP, bool COUNT, size_t VECTOR_BYTES>
+  static DATASKETCHES_SIMD_INLINE uint64_t combine_bits_vectors(uint8_t* tgt, const uint8_t* src, size_t length_bytes) {
+    typedef typename vector_of<uint64_t, VECTOR_BYTES>::type vector_type;
+    const size_t lanes = VECTOR_BYTES / sizeof(uint64_t);
+    uint64_t num_bits_set = 0;
+    size_t i = 0;
+    for (; i + VECTOR_BYTES <= length_bytes; i += VECTOR_BYTES) {
+      vector_type a, b;
+      std::memcpy(&a, tgt + i, VECTOR_BYTES);
+      std::memcpy(&b, src + i, VECTOR_BYTES);
+      a = OP == BIT_OR ? (a | b) : (a & b);
+      std::memcpy(tgt + i, &a, VECTOR_BYTES);
+      if (COUNT) {
+        for (size_t j = 0; j < lanes; ++j) num_bits_set += __builtin_popcountll(a[j]);
+      }
+    }
+    return num_bits_set + combine_bits_scalar<OP, COUNT>(tgt + i, src + i, length_bytes - i);
+  }
+
+  template<typename T>
+  DATASKETCHES_TARGET_AVX2 void add_avx2(T* tgt, const T* src, size_t n) {
+    add_vectors<T, 32>(tgt, src, n);
+  }
+
+  template<typename T>
+  DATASKETCHES_TARGET_AVX512 void add_avx512(T* tgt, const T* src, size_t n) {
+    add_vectors<T, 64>(tgt, src, n);
+  }
+
+  template<bit_op OP, bool COUNT>
+  DATASKETCHES_TARGET_AVX2 uint64_t combine_bits_avx2(uint8_t* tgt, const uint8_t* src, size_t length_bytes) {
+    return combine_bits_vectors<OP, COUNT, 32>(tgt, src, length_bytes);
+  }
+
+  template<bit_op OP, bool COUNT>
+  DATASKETCHES_TARGET_AVX512 uint64_t combine_bits_avx512(uint8_t* tgt, const uint8_t* src, size_t length_bytes) {
+    return combine_bits_vectors<OP, COUNT, 64>(tgt, src, length_bytes);
+  }
+
+#endif // DATASKETCHES_SIMD_X86
+
+  // Vector extensions exist for arithmetic types other than bool and long double
+  template<typename T>
+  struct is_vectorizable: std::integral_constant<bool,
+    std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value> {};
+
+  template<typename T>
+  static inline void add_dispatch(T* tgt, const T* src, size_t n, simd_level level, std::true_type) {
+#ifdef DATASKETCHES_SIMD_X86
+    if (level == AVX512) return add_avx512(tgt, src, n);
+    if (level == AVX2) return add_avx2(tgt, src, n);
+#else
+    (void) level;
+#endif
+    add_scalar(tgt, src, n);
+  }
+
+  template<typename T>
+  static inline void add_dispatch(T* tgt, const T* src, size_t n, simd_level, std::false_type) {
+    add_scalar(tgt, src, n);
+  }
+
+  template<bit_op OP, bool COUNT>
+  static inline uint64_t combine_bits(uint8_t* tgt, const uint8_t* src, size_t length_bytes, simd_level level) {
+#ifdef DATASKETCHES_SIMD_X86
+    if (level == AVX512) return combine_bits_avx512<OP, COUNT>(tgt, src, length_bytes);
+    if (level == AVX2) return combine_bits_avx2<OP, COUNT>(tgt, src, length_bytes);
+#else
+    (void) level;
+#endif
+    return combine_bits_scalar<OP, COUNT>(tgt, src, length_bytes);
+  }
+
+  /**
+   * Adds the elements of src to the elements of tgt.
+   * @param tgt the array into which the sums are written
+   * @param src the array to add to tgt
+   * @param n the number of elements in the two arrays
+   * @param level instruction set to use
+   */
+  template<typename T>
+  static inline void add(T* tgt, const T* src, size_t n, simd_level level = get_simd_level()) {
+    add_dispatch(tgt, src, n, level, is_vectorizable<T>());
+  }
+
+  /**
+   * Adds the elements of several arrays to the elements of tgt in one pass over tgt.
+   * @param tgt the array into which the sums are written
+   * @param srcs pointers to the arrays to add to tgt
+   * @param num_srcs the number of arrays in srcs
+   * @param n the number of elements in each array
+   * @param level instruction set to use
+   */
+  template<typename T>
+  static inline void add_many(T* tgt, const T* const* srcs, size_t num_srcs, size_t n,
+      simd_level level = get_simd_level()) {
+    const size_t chunk = std::max<size_t>(MERGE_CHUNK_BYTES / sizeof(T), 1);
+    for (size_t start = 0; start < n; start += chunk) {
+      const size_t length = std::min(chunk, n - start);
+      for (size_t i = 0; i < num_srcs; ++i) add(tgt + start, srcs[i] + start, length, level);
+    }
+  }
+
+  /**
+   * Computes the bitwise OR of tgt and src into tgt.
+   * @param tgt the array of bits into which the results are written
+   * @param src the array of bits to union into tgt
+   * @param length_bytes the length of the two arrays, in bytes
+   * @param level instruction set to use
+   * @return the number of bits set in the resulting array
+   */
+  static inline uint64_t union_with(uint8_t* tgt, const uint8_t* src, size_t length_bytes,
+      simd_level level = get_simd_level()) {
+    return combine_bits<BIT_OR, true>(tgt, src, length_bytes, level);
+  }
+
+  /**
+   * Computes the bitwise AND of tgt and src into tgt.
+   * @param tgt the array of bits into which the results are written
+   * @param src the array of bits to intersect with tgt
+   * @param length_bytes the length of the two arrays, in bytes
+   * @param level instruction set to use
+   * @return the number of bits set in the resulting array
+   */
+  static inline uint64_t intersect(uint8_t* tgt, const uint8_t* src, size_t length_bytes,
+      simd_level level = get_simd_level()) {
+    return combine_bits<BIT_AND, true>(tgt, src, length_bytes, level);
+  }
+
+  /**
+   * Computes the bitwise OR of tgt and several arrays into tgt in one pass over tgt.
+   * @param tgt the array of bits into which the results are written
+   * @param srcs pointers to the arrays of bits to union into tgt
+   * @param num_srcs the number of arrays in srcs
+   * @param length_bytes the length of each array, in bytes
+   * @param level instruction set to use
+   * @return the number of bits set in the resulting array
+   */
+  static inline uint64_t union_many(uint8_t* tgt, const uint8_t* const* srcs, size_t num_srcs, size_t length_bytes,
+      simd_level level = get_simd_level()) {
+    uint64_t num_bits_set = 0;
+    for (size_t start = 0; start < length_bytes; start += MERGE_CHUNK_BYTES) {
+      const size_t length = std::min(MERGE_CHUNK_BYTES, length_bytes - start);
+      if (num_srcs == 0) {
+        // OR with itself leaves the chunk unchanged and counts its bits
+        num_bits_set += combine_bits<BIT_OR, true>(tgt + start, tgt + start, length, level);
+        continue;
+      }
+      for (size_t i = 0; i + 1 < num_srcs; ++i) {
+        combine_bits<BIT_OR, false>(tgt + start, srcs[i] + start, length, level);
+      }
+      num_bits_set += combine_bits<BIT_OR, true>(tgt + start, srcs[num_srcs - 1] + start, length, level);
+    }
+    return num_bits_set;
+  }
+
+  /**
+   * Compares a group of 8 keys with a given key and with zero at once.
+   * Uses SSE2, which every x86-64 CPU has, so there is no run-time dispatch
+   * and the comparison can be inlined into hash table probes.
+   * @param keys the array of 8 keys
+   * @param key the key to look for
+   * @return bit i set if keys[i] is equal to key, bit 8 + i set if keys[i] is zero
+   */
+  static inline uint32_t match_keys_8(const uint64_t* keys, uint64_t key) {
+#if defined(__SSE2__)
+    const __m128i k = _mm_set1_epi64x(static_cast<long long>(key));
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 2 * i));
+      // SSE2 compares 32-bit lanes, a 64-bit key matches if both of its halves do
+      __m128i matches = _mm_cmpeq_epi32(v, k);
+      __m128i empty = _mm_cmpeq_epi32(v, zero);
+      matches = _mm_and_si128(matches, _mm_shuffle_epi32(matches, 0xB1));
+      empty = _mm_and_si128(empty, _mm_shuffle_epi32(empty, 0xB1));
+      result |= static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(matches))) << (2 * i);
+      result |= static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(empty))) << (8 + 2 * i);
+    }
+    return result;
+#else
+    uint32_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+      result |= static_cast<uint32_t>(keys[i] == key) << i;
+      result |= static_cast<uint32_t>(keys[i] == 0) << (8 + i);
+    }
+    return result;
+#endif
+  }
+
+} // namespace simd_ops
+
+} // namespace datasketches
+
+#endif // _SIMD_OPS_HPP_
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "arena_allocator.hpp"
+#include "test_allocator.hpp"
+
+namespace datasketches {
+
+using arena_type = monotonic_arena_alloc<test_allocator<char>>;
+
+TEST_CASE("arena allocator: invalid block size", "[arena_allocator]") {
+  REQUIRE_THROWS_AS(monotonic_arena(0), std::invalid_argument);
+}
+
+TEST_CASE("arena allocator: no allocation until used", "[arena_allocator]") {
+  test_allocator_total_bytes = 0;
+  test_allocator_net_allocations = 0;
+  {
+    arena_type arena(1024, test_allocator<char>(0));
+    REQUIRE(arena.get_num_blocks() == 0);
+    REQUIRE(arena.get_capacity() == 0);
+    REQUIRE(arena.get_bytes_used() == 0);
+  }
+  REQUIRE(test_allocator_net_allocations == 0);
+}
+
+TEST_CASE("arena allocator: alignment", "[arena_allocator]") {
+  monotonic_arena arena(1024);
+  arena.allocate(1, 1);
+  for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+    const void* p = arena.allocate(3, alignment);
+    REQUIRE(reinterpret_cast<uintptr_t>(p) % alignment == 0);
+  }
+  REQUIRE(arena.get_num_blocks() == 1);
+}
+
+TEST_CASE("arena allocator: growth and reuse after reset", "[arena_allocator]") {
+  test_allocator_total_bytes = 0;
+  test_allocator_net_allocations = 0;
+  {
+    arena_type arena(1024, test_allocator<char>(0));
+    std::vector<char*> pointers;
+    for (int i = 0; i < 100; ++i) pointers.push_back(static_cast<char*>(arena.allocate(100, 8)));
+    REQUIRE(arena.get_num_blocks() > 1);
+    REQUIRE(arena.get_capacity() >= 100 * 100);
+    REQUIRE(arena.get_bytes_used() >= 100 * 100);
+    // larger than any block so far
+    const size_t large_size = arena.get_capacity() * 4;
+    arena.allocate(large_size, 8);
+
+    const size_t num_blocks = arena.get_num_blocks();
+    const long long num_allocations = test_allocator_net_allocations;
+    for (int pass = 0; pass < 3; ++pass) {
+      arena.reset();
+      REQUIRE(arena.get_bytes_used() == 0);
+      // the same sequence of allocations gets the same memory
+      for (int i = 0; i < 100; ++i) REQUIRE(arena.allocate(100, 8) == pointers[i]);
+      arena.allocate(large_size, 8);
+      REQUIRE(arena.get_num_blocks() == num_blocks);
+      REQUIRE(test_allocator_net_allocations == num_allocations);
+    }
+
+    arena.release();
+    REQUIRE(arena.get_num_blocks() == 0);
+    REQUIRE(test_allocator_net_allocations == 0);
+    arena.allocate(10, 1);
+    REQUIRE(arena.get_num_blocks() == 1);
+  }
+  REQUIRE(test_allocator_total_bytes == 0);
+  REQUIRE(test_allocator_net_allocations == 0);
+}
+
+TEST_CASE("arena allocator: containers", "[arena_allocator]") {
+  monotonic_arena arena;
+  using allocator = arena_allocator<uint64_t>;
+  const allocator alloc(arena);
+  REQUIRE(&alloc.get_arena() == &arena);
+
+  std::vector<uint64_t, allocator> v(alloc);
+  for (uint64_t i = 0; i < 1000; ++i) v.push_back(i);
+  REQUIRE(v.size() == 1000);
+  REQUIRE(v[999] == 999);
+  REQUIRE(v.get_allocator() == alloc);
+
+  // rebound copies take memory from the same arena
+  using AllocDouble = std::allocator_traits<allocator>::rebind_alloc<double>;
+  std::vector<double, AllocDouble> d(10, 1.5, AllocDouble(alloc));
+  REQUIRE(d.get_allocator() == alloc);
+  REQUIRE(reinterpret_cast<uintptr_t>(d.data()) % alignof(double) == 0);
+
+  monotonic_arena other_arena;
+  REQUIRE(allocator(other_arena) != alloc);
+}
+
+} /* namespace datasketches */
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <bitset>
+#include <vector>
+
+#include "simd_ops.hpp"
+
+namespace datasketches {
+
+using namespace simd_ops;
+
+template<typename T>
+static void check_add(simd_level level) {
+  // odd sizes and offsets exercise the scalar tails and unaligned access
+  for (size_t n: {0, 1, 7, 33, 1000, 20001}) {
+    std::vector<T> tgt(n + 1), src(n + 1), expected(n + 1);
+    for (size_t i = 0; i <= n; ++i) {
+      tgt[i] = static_cast<T>(i % 100);
+      src[i] = static_cast<T>(i % 7 + 1);
+      expected[i] = static_cast<T>(tgt[i] + src[i]);
+    }
+    add(tgt.data() + 1, src.data() + 1, n, level);
+    REQUIRE(tgt[0] == 0);
+    for (size_t i = 1; i <= n; ++i) REQUIRE(tgt[i] == expected[i]);
+  }
+}
+
+TEST_CASE("simd_ops: add", "[simd_ops]") {
+  for (int level = SCALAR; level <= get_simd_level(); ++level) {
+    check_add<uint8_t>(static_cast<simd_level>(level));
+    check_add<uint16_t>(static_cast<simd_level>(level));
+    check_add<int32_t>(static_cast<simd_level>(level));
+    check_add<uint64_t>(static_cast<simd_level>(level));
+    check_add<float>(static_cast<simd_level>(level));
+    check_add<double>(static_cast<simd_level>(level));
+  }
+}
+
+TEST_CASE("simd_ops: add many", "[simd_ops]") {
+  const size_t n = 5000;
+  const size_t num_srcs = 5;
+  std::vector<std::vector<int64_t>> srcs(num_srcs, std::vector<int64_t>(n));
+  std::vector<const int64_t*> ptrs;
+  for (size_t j = 0; j < num_srcs; ++j) {
+    for (size_t i = 0; i < n; ++i) srcs[j][i] = static_cast<int64_t>(i * j) - 100;
+    ptrs.push_back(srcs[j].data());
+  }
+  for (int level = SCALAR; level <= get_simd_level(); ++level) {
+    std::vector<int64_t> tgt(n, 1);
+    add_many(tgt.data(), ptrs.data(), num_srcs, n, static_cast<simd_level>(level));
+    for (size_t i = 0; i < n; ++i) REQUIRE(tgt[i] == static_cast<int64_t>(1 + i * 10 - 500));
+  }
+}
+
+static uint64_t count_bits(const std::vector<uint8_t>& bytes) {
+  uint64_t count = 0;
+  for (auto byte: bytes) count += std::bitset<8>(byte).count();
+  return count;
+}
+
+TEST_CASE("simd_ops: union and intersect", "[simd_ops]") {
+  for (size_t length: {0, 8, 24, 1000, 4104, 20000}) {
+    std::vector<uint8_t> a(length), b(length);
+    for (size_t i = 0; i < length; ++i) {
+      a[i] = static_cast<uint8_t>(i * 37);
+      b[i] = static_cast<uint8_t>(i * 11 + 3);
+    }
+    for (int level = SCALAR; level <= get_simd_level(); ++level) {
+      std::vector<uint8_t> u(a), x(a);
+      const uint64_t u_bits = union_with(u.data(), b.data(), length, static_cast<simd_level>(level));
+      const uint64_t x_bits = intersect(x.data(), b.data(), length, static_cast<simd_level>(level));
+      for (size_t i = 0; i < length; ++i) {
+        REQUIRE(u[i] == (a[i] | b[i]));
+        REQUIRE(x[i] == (a[i] & b[i]));
+      }
+      REQUIRE(u_bits == count_bits(u));
+      REQUIRE(x_bits == count_bits(x));
+    }
+  }
+}
+
+TEST_CASE("simd_ops: union many", "[simd_ops]") {
+  const size_t length = 3 * MERGE_CHUNK_BYTES + 40;
+  std::vector<std::vector<uint8_t>> srcs(4, std::vector<uint8_t>(length, 0));
+  std::vector<const uint8_t*> ptrs;
+  for (size_t j = 0; j < srcs.size(); ++j) {
+    for (size_t i = j; i < length; i += 5) srcs[j][i] = static_cast<uint8_t>(1 << (i % 8));
+    ptrs.push_back(srcs[j].data());
+  }
+  for (int level = SCALAR; level <= get_simd_level(); ++level) {
+    std::vector<uint8_t> tgt(length, 0);
+    tgt[length - 1] = 0x80;
+    std::vector<uint8_t> expected(tgt);
+    for (const auto& src: srcs) union_with(expected.data(), src.data(), length, SCALAR);
+    const uint64_t num_bits = union_many(tgt.data(), ptrs.data(), ptrs.size(), length, static_cast<simd_level>(level));
+    REQUIRE(tgt == expected);
+    REQUIRE(num_bits == count_bits(expected));
+  }
+}
+
+} /* namespace datasketches */
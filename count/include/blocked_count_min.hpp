@@ -0,0 +1,393 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BLOCKED_COUNT_MIN_HPP_
+#define BLOCKED_COUNT_MIN_HPP_
+
+#include <vector>
+#include "common_defs.hpp"
+
+namespace datasketches {
+
+/**
+ * Cache-line-blocked variant of the CountMin sketch.
+ *
+ * The counters are grouped in blocks of 64 bytes (one cache line).
+ * A single 128-bit hash of an item selects one block, and all of the counters of the item
+ * are located inside that block, similar to blocked Bloom filters.
+ * An update or a query touches exactly one cache line regardless of the number of hashes,
+ * whereas count_min_sketch touches one cache line per row.
+ *
+ * The price is accuracy: all counters of an item share the same block, so they collide
+ * with the same set of other items and the confidence does not improve exponentially with
+ * the number of hashes as it does in count_min_sketch.
+ * Every hash also adds load to the block, so a small number of hashes (2 to 4) is usually best.
+ *
+ * For an item x with true frequency f(x) and total weight N (with non-negative weights)
+ * f(x) <= get_estimate(x) and, with probability at least 1 - 1/e,
+ * get_estimate(x) <= f(x) + get_relative_error() * N, where
+ * get_relative_error() = e * num_hashes / (num_blocks * cells_per_block).
+ *
+ * The template type W is the type of the counters, not the type of the items.
+ * It also determines the number of counters per block: 64 / sizeof(W).
+ */
+template <typename W,
+          typename Allocator = std::allocator<W>>
+class blocked_count_min_sketch {
+  static_assert(std::is_arithmetic<W>::value, "Arithmetic type expected");
+  static_assert(64 % sizeof(W) == 0, "Counter size must divide the block size");
+public:
+  using allocator_type = Allocator;
+  using const_iterator = const W*;
+
+  /// size of a block in bytes
+  static const size_t BLOCK_SIZE_BYTES = 64;
+  /// number of counters in a block
+  static const uint8_t CELLS_PER_BLOCK = BLOCK_SIZE_BYTES / sizeof(W);
+
+  /**
+   * Creates an instance of the sketch
+   * @param num_hashes number of counters per item within its block, from 1 to get_max_num_hashes()
+   * @param num_blocks number of 64-byte blocks
+   * @param seed for hash function
+   * @param allocator to acquire and release memory
+   */
+  blocked_count_min_sketch(uint8_t num_hashes, uint32_t num_blocks, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * Copy constructor
+   * @param other sketch to be copied
+   */
+  blocked_count_min_sketch(const blocked_count_min_sketch& other);
+
+  /**
+   * Move constructor
+   * @param other sketch to be moved
+   */
+  blocked_count_min_sketch(blocked_count_min_sketch&& other) noexcept = default;
+
+  /**
+   * Copy assignment
+   * @param other sketch to be copied
+   * @return reference to this sketch
+   */
+  blocked_count_min_sketch& operator=(const blocked_count_min_sketch& other);
+
+  /**
+   * Move assignment
+   * @param other sketch to be moved
+   * @return reference to this sketch
+   */
+  blocked_count_min_sketch& operator=(blocked_count_min_sketch&& other) = default;
+
+  /**
+   * @return configured number of hashes of this sketch
+   */
+  uint8_t get_num_hashes() const;
+
+  /**
+   * @return configured number of blocks of this sketch
+   */
+  uint32_t get_num_blocks() const;
+
+  /**
+   * @return configured seed of this sketch
+   */
+  uint64_t get_seed() const;
+
+  /**
+   * @return epsilon
+   * The maximum permissible error for any frequency estimate query relative to the total weight.
+   * epsilon = e * num_hashes / (num_blocks * cells_per_block)
+   */
+  double get_relative_error() const;
+
+  /**
+   * @return the total weight currently inserted into the stream.
+   */
+  W get_total_weight() const;
+
+  /**
+   * @return the largest number of hashes supported for the counter type W
+   */
+  static uint8_t get_max_num_hashes();
+
+  /**
+   * Suggests the number of blocks required to achieve the given relative error
+   * @param relative_error the desired accuracy within which estimates should lie
+   * @param num_hashes the number of hashes the sketch will be configured with
+   * @return the number of blocks
+   */
+  static uint32_t suggest_num_blocks(double relative_error, uint8_t num_hashes);
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return an estimate of the item's frequency.
+   */
+  W get_estimate(uint64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return an estimate of the item's frequency.
+   */
+  W get_estimate(int64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given string.
+   * @param item to query
+   * @return an estimate of the item's frequency.
+   */
+  W get_estimate(const std::string& item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item of any type.
+   * @param item pointer to the data item to be queried
+   * @param size of the item in bytes
+   * @return an estimate of the item's frequency.
+   */
+  W get_estimate(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given string.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(const std::string& item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given string.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(const std::string& item) const;
+
+  /**
+   * Update this sketch with given data of any type.
+   * @param item pointer to the data item to be inserted into the sketch.
+   * @param size of the data in bytes
+   * @param weight arithmetic type
+   */
+  void update(const void* item, size_t size, W weight);
+
+  /**
+   * Update this sketch with a given item.
+   * @param item to update the sketch with
+   * @param weight arithmetic type
+   */
+  void update(uint64_t item, W weight = 1);
+
+  /**
+   * Update this sketch with a given item.
+   * @param item to update the sketch with
+   * @param weight arithmetic type
+   */
+  void update(int64_t item, W weight = 1);
+
+  /**
+   * Update this sketch with a given string.
+   * @param item string to update the sketch with
+   * @param weight arithmetic type
+   */
+  void update(const std::string& item, W weight = 1);
+
+  /**
+   * Merges another blocked_count_min_sketch into this one.
+   * @param other sketch with the same configuration
+   */
+  void merge(const blocked_count_min_sketch& other);
+
+  /**
+   * Returns true if this sketch is empty.
+   * @return empty flag
+   */
+  bool is_empty() const;
+
+  /**
+   * @brief Returns a string describing the sketch
+   * @return A string with a human-readable description of the sketch
+   */
+  string<Allocator> to_string() const;
+
+  /**
+   * Iterator pointing to the first counter in the sketch.
+   * @return iterator pointing to the first counter in the sketch
+   */
+  const_iterator begin() const;
+
+  /**
+   * Iterator pointing to the past-the-end counter in the sketch.
+   * @return iterator pointing to the past-the-end counter in the sketch
+   */
+  const_iterator end() const;
+
+  /*
+   * The serialized sketch binary form has the same header as count_min_sketch,
+   * with the blocked flag set and the number of counters per block in the last byte of long 1.
+
+  0   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||preLongs|ser__ver|familyId| flags  |xxxxxxxx|xxxxxxxx|xxxxxxxx|xxxxxxxx|
+
+  1   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||----------- _num_blocks -----------|num_hash|__seed__ __hash__|cells/bk|
+
+  2   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||---------------------------- total  weight ----------------------------|
+
+  3   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||-------------------- counters, block after block ----------------------|
+ ...
+
+   */
+
+  /**
+   * Computes size needed to serialize the current state of the sketch.
+   * @return size in bytes needed to serialize this sketch
+   */
+  size_t get_serialized_size_bytes() const;
+
+  /**
+   * This method serializes the sketch into a given stream in a binary form
+   * @param os output stream
+   */
+  void serialize(std::ostream& os) const;
+
+  // This is a convenience alias for users
+  // The type returned by the following serialize method
+  using vector_bytes = std::vector<uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>>;
+
+  /**
+   * This method serializes the sketch as a vector of bytes.
+   * An optional header can be reserved in front of the sketch.
+   * @param header_size_bytes space to reserve in front of the sketch
+   */
+  vector_bytes serialize(unsigned header_size_bytes = 0) const;
+
+  /**
+   * This method deserializes a sketch from a given stream.
+   * @param is input stream
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of a sketch
+   */
+  static blocked_count_min_sketch deserialize(std::istream& is, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * This method deserializes a sketch from a given array of bytes.
+   * @param bytes pointer to the array of bytes
+   * @param size the size of the array
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of the sketch
+   */
+  static blocked_count_min_sketch deserialize(const void* bytes, size_t size, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * @return allocator
+   */
+  allocator_type get_allocator() const;
+
+private:
+  Allocator _allocator;
+  uint8_t _num_hashes;
+  uint32_t _num_blocks;
+  uint32_t _block_mask; // _num_blocks - 1 if _num_blocks is a power of 2, zero otherwise
+  uint64_t _seed;
+  W _total_weight;
+  // Over-allocated by one block so that the counters can start on a 64-byte boundary
+  // whatever the alignment the allocator provides. See get_cells().
+  std::vector<W, Allocator> _cells;
+
+  enum flags {IS_EMPTY, IS_DOUBLE_HASHED, IS_BLOCKED};
+  static const uint8_t PREAMBLE_LONGS = 2;
+  static const uint8_t SERIAL_VERSION_1 = 1;
+  static const uint8_t FAMILY_ID = 18;
+  static const uint32_t NULL_32 = 0;
+  static const uint8_t LG_CELLS_PER_BLOCK = log2(CELLS_PER_BLOCK);
+
+  W* get_cells();
+  const W* get_cells() const;
+  size_t get_num_cells() const;
+
+  static void check_header_validity(uint8_t preamble_longs, uint8_t serial_version, uint8_t family_id,
+      uint8_t flags_byte, uint8_t cells_per_block);
+
+  /*
+   * Compute the location of the block and of the counters within the block for an input item
+   * @param item pointer to the data item to be inserted into or queried from the sketch.
+   * @param size of the data in bytes
+   * @param callback function to invoke with the index of each counter of the item
+   */
+  template<typename F>
+  void foreach_cell(const void* item, size_t size, F callback) const;
+};
+
+} /* namespace datasketches */
+
+#include "blocked_count_min_impl.hpp"
+
+#endif
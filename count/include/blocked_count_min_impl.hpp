@@ -0,0 +1,458 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BLOCKED_COUNT_MIN_IMPL_HPP_
+#define BLOCKED_COUNT_MIN_IMPL_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "MurmurHash3.h"
+#include "blocked_count_min.hpp"
+#include "memory_operations.hpp"
+#include "simd_ops.hpp"
+
+namespace datasketches {
+
+template<typename W, typename A>
+const size_t blocked_count_min_sketch<W,A>::BLOCK_SIZE_BYTES;
+
+template<typename W, typename A>
+const uint8_t blocked_count_min_sketch<W,A>::CELLS_PER_BLOCK;
+
+template<typename W, typename A>
+blocked_count_min_sketch<W,A>::blocked_count_min_sketch(uint8_t num_hashes, uint32_t num_blocks, uint64_t seed,
+    const A& allocator):
+_allocator(allocator),
+_num_hashes(num_hashes),
+_num_blocks(num_blocks),
+_block_mask((num_blocks & (num_blocks - 1)) == 0 ? num_blocks - 1 : 0),
+_seed(seed),
+_total_weight(0),
+_cells(allocator) {
+  if (num_hashes < 1 || num_hashes > get_max_num_hashes()) {
+    throw std::invalid_argument("Number of hashes must be between 1 and " + std::to_string(get_max_num_hashes()));
+  }
+  if (num_blocks < 1) {
+    throw std::invalid_argument("Number of blocks must be at least 1");
+  }
+  // Same limit on the number of counters as count_min_sketch
+  if (static_cast<uint64_t>(num_blocks) * CELLS_PER_BLOCK >= 1 << 30) {
+    throw std::invalid_argument("These parameters generate a sketch that exceeds 2^30 elements. "
+                                "Try reducing the number of blocks.");
+  }
+  _cells.resize(get_num_cells() + CELLS_PER_BLOCK, 0);
+}
+
+template<typename W, typename A>
+blocked_count_min_sketch<W,A>::blocked_count_min_sketch(const blocked_count_min_sketch& other):
+_allocator(other._allocator),
+_num_hashes(other._num_hashes),
+_num_blocks(other._num_blocks),
+_block_mask(other._block_mask),
+_seed(other._seed),
+_total_weight(other._total_weight),
+_cells(other._cells.size(), 0, other._allocator) {
+  // the new array may have a different alignment, so copy the aligned counters rather than the raw array
+  std::copy(other.begin(), other.end(), get_cells());
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::operator=(const blocked_count_min_sketch& other) -> blocked_count_min_sketch& {
+  blocked_count_min_sketch copy(other);
+  *this = std::move(copy);
+  return *this;
+}
+
+template<typename W, typename A>
+uint8_t blocked_count_min_sketch<W,A>::get_num_hashes() const {
+  return _num_hashes;
+}
+
+template<typename W, typename A>
+uint32_t blocked_count_min_sketch<W,A>::get_num_blocks() const {
+  return _num_blocks;
+}
+
+template<typename W, typename A>
+uint64_t blocked_count_min_sketch<W,A>::get_seed() const {
+  return _seed;
+}
+
+template<typename W, typename A>
+double blocked_count_min_sketch<W,A>::get_relative_error() const {
+  return exp(1.0) * _num_hashes / static_cast<double>(get_num_cells());
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_total_weight() const {
+  return _total_weight;
+}
+
+template<typename W, typename A>
+uint8_t blocked_count_min_sketch<W,A>::get_max_num_hashes() {
+  // the offsets of all counters within the block are taken from the 64 bits of the second half of the hash
+  return std::min<uint8_t>(CELLS_PER_BLOCK, 64 / LG_CELLS_PER_BLOCK);
+}
+
+template<typename W, typename A>
+uint32_t blocked_count_min_sketch<W,A>::suggest_num_blocks(double relative_error, uint8_t num_hashes) {
+  if (relative_error <= 0.) {
+    throw std::invalid_argument("Relative error must be greater than 0.");
+  }
+  return static_cast<uint32_t>(ceil(exp(1.0) * num_hashes / (relative_error * CELLS_PER_BLOCK)));
+}
+
+template<typename W, typename A>
+W* blocked_count_min_sketch<W,A>::get_cells() {
+  return const_cast<W*>(static_cast<const blocked_count_min_sketch*>(this)->get_cells());
+}
+
+template<typename W, typename A>
+const W* blocked_count_min_sketch<W,A>::get_cells() const {
+  // skip to the first 64-byte boundary in the over-allocated array
+  const uintptr_t address = reinterpret_cast<uintptr_t>(_cells.data());
+  const uintptr_t misalignment = address % BLOCK_SIZE_BYTES;
+  return _cells.data() + (misalignment == 0 ? 0 : (BLOCK_SIZE_BYTES - misalignment) / sizeof(W));
+}
+
+template<typename W, typename A>
+size_t blocked_count_min_sketch<W,A>::get_num_cells() const {
+  return static_cast<size_t>(_num_blocks) * CELLS_PER_BLOCK;
+}
+
+template<typename W, typename A>
+template<typename F>
+void blocked_count_min_sketch<W,A>::foreach_cell(const void* item, size_t size, F callback) const {
+  /*
+   * The first half of the hash selects the block, and consecutive groups of
+   * LG_CELLS_PER_BLOCK bits of the second half select the counters within the block.
+   */
+  HashState hashes;
+  MurmurHash3_x64_128(item, size, _seed, hashes);
+  const uint64_t block_index = _block_mask != 0 ? hashes.h1 & _block_mask : hashes.h1 % _num_blocks;
+  const size_t block_offset = static_cast<size_t>(block_index) * CELLS_PER_BLOCK;
+  uint64_t offsets = hashes.h2;
+  for (uint8_t i = 0; i < _num_hashes; ++i) {
+    callback(block_offset + (offsets & (CELLS_PER_BLOCK - 1)));
+    offsets >>= LG_CELLS_PER_BLOCK;
+  }
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_estimate(uint64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_estimate(int64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_estimate(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_estimate(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_estimate(const void* item, size_t size) const {
+  const W* cells = get_cells();
+  W estimate = std::numeric_limits<W>::max();
+  foreach_cell(item, size, [cells, &estimate](size_t i) {
+    estimate = std::min(estimate, cells[i]);
+  });
+  return estimate;
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::update(uint64_t item, W weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::update(int64_t item, W weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::update(const std::string& item, W weight) {
+  if (item.empty()) { return; }
+  update(item.c_str(), item.length(), weight);
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::update(const void* item, size_t size, W weight) {
+  _total_weight += weight >= 0 ? weight : -weight;
+  W* cells = get_cells();
+  // a counter selected by more than one hash is incremented only once
+  uint64_t updated = 0;
+  foreach_cell(item, size, [cells, weight, &updated](size_t i) {
+    const uint64_t bit = static_cast<uint64_t>(1) << (i % CELLS_PER_BLOCK);
+    if (!(updated & bit)) cells[i] += weight;
+    updated |= bit;
+  });
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_upper_bound(uint64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_upper_bound(int64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_upper_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_upper_bound(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_upper_bound(const void* item, size_t size) const {
+  return static_cast<W>(get_estimate(item, size) + get_relative_error() * get_total_weight());
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_lower_bound(uint64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_lower_bound(int64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_lower_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_lower_bound(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W blocked_count_min_sketch<W,A>::get_lower_bound(const void* item, size_t size) const {
+  return get_estimate(item, size);
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::merge(const blocked_count_min_sketch& other) {
+  if (this == &other) { throw std::invalid_argument("Cannot merge a sketch with itself."); }
+
+  const bool acceptable_config =
+    (get_num_hashes() == other.get_num_hashes()) &&
+    (get_num_blocks() == other.get_num_blocks()) &&
+    (get_seed() == other.get_seed());
+  if (!acceptable_config) { throw std::invalid_argument("Incompatible sketch configuration."); }
+
+  simd_ops::add(get_cells(), other.get_cells(), get_num_cells());
+  _total_weight += other.get_total_weight();
+}
+
+template<typename W, typename A>
+bool blocked_count_min_sketch<W,A>::is_empty() const {
+  return _total_weight == 0;
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::begin() const -> const_iterator {
+  return get_cells();
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::end() const -> const_iterator {
+  return get_cells() + get_num_cells();
+}
+
+template<typename W, typename A>
+size_t blocked_count_min_sketch<W,A>::get_serialized_size_bytes() const {
+  return PREAMBLE_LONGS * sizeof(uint64_t) + (is_empty() ? 0 : sizeof(W) * (1 + get_num_cells()));
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::serialize(std::ostream& os) const {
+  // Long 0
+  write(os, PREAMBLE_LONGS);
+  write(os, SERIAL_VERSION_1);
+  write(os, FAMILY_ID);
+  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0) | (1 << flags::IS_BLOCKED);
+  write(os, flags_byte);
+  write(os, NULL_32);
+
+  // Long 1
+  write(os, _num_blocks);
+  write(os, _num_hashes);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  write(os, seed_hash);
+  write(os, CELLS_PER_BLOCK);
+  if (is_empty()) { return; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  write(os, _total_weight);
+
+  // Long 3 onwards
+  write(os, get_cells(), sizeof(W) * get_num_cells());
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::serialize(unsigned header_size_bytes) const -> vector_bytes {
+  vector_bytes bytes(header_size_bytes + get_serialized_size_bytes(), 0, _allocator);
+  uint8_t* ptr = bytes.data() + header_size_bytes;
+
+  // Long 0
+  const uint8_t preamble_longs = PREAMBLE_LONGS;
+  ptr += copy_to_mem(preamble_longs, ptr);
+  const uint8_t ser_ver = SERIAL_VERSION_1;
+  ptr += copy_to_mem(ser_ver, ptr);
+  const uint8_t family_id = FAMILY_ID;
+  ptr += copy_to_mem(family_id, ptr);
+  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0) | (1 << flags::IS_BLOCKED);
+  ptr += copy_to_mem(flags_byte, ptr);
+  const uint32_t unused32 = NULL_32;
+  ptr += copy_to_mem(unused32, ptr);
+
+  // Long 1
+  ptr += copy_to_mem(_num_blocks, ptr);
+  ptr += copy_to_mem(_num_hashes, ptr);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  ptr += copy_to_mem(seed_hash, ptr);
+  const uint8_t cells_per_block = CELLS_PER_BLOCK;
+  ptr += copy_to_mem(cells_per_block, ptr);
+  if (is_empty()) { return bytes; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  ptr += copy_to_mem(_total_weight, ptr);
+
+  // Long 3 onwards
+  copy_to_mem(get_cells(), ptr, sizeof(W) * get_num_cells());
+  return bytes;
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::deserialize(std::istream& is, uint64_t seed, const A& allocator) -> blocked_count_min_sketch {
+  const auto preamble_longs = read<uint8_t>(is);
+  const auto serial_version = read<uint8_t>(is);
+  const auto family_id = read<uint8_t>(is);
+  const auto flags_byte = read<uint8_t>(is);
+  read<uint32_t>(is); // 4 unused bytes
+
+  const auto nblocks = read<uint32_t>(is);
+  const auto nhashes = read<uint8_t>(is);
+  const auto seed_hash = read<uint16_t>(is);
+  const auto cells_per_block = read<uint8_t>(is);
+
+  check_header_validity(preamble_longs, serial_version, family_id, flags_byte, cells_per_block);
+  if (seed_hash != compute_seed_hash(seed)) {
+    throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
+                                + std::to_string(compute_seed_hash(seed)));
+  }
+  blocked_count_min_sketch c(nhashes, nblocks, seed, allocator);
+  const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
+  if (is_empty) { return c; } // sketch is empty, no need to read further.
+
+  c._total_weight = read<W>(is);
+  read(is, c.get_cells(), sizeof(W) * c.get_num_cells());
+  if (!is.good()) throw std::runtime_error("error reading from std::istream");
+  return c;
+}
+
+template<typename W, typename A>
+auto blocked_count_min_sketch<W,A>::deserialize(const void* bytes, size_t size, uint64_t seed, const A& allocator) -> blocked_count_min_sketch {
+  ensure_minimum_memory(size, PREAMBLE_LONGS * sizeof(uint64_t));
+
+  const char* ptr = static_cast<const char*>(bytes);
+  uint8_t preamble_longs;
+  ptr += copy_from_mem(ptr, preamble_longs);
+  uint8_t serial_version;
+  ptr += copy_from_mem(ptr, serial_version);
+  uint8_t family_id;
+  ptr += copy_from_mem(ptr, family_id);
+  uint8_t flags_byte;
+  ptr += copy_from_mem(ptr, flags_byte);
+  ptr += sizeof(uint32_t);
+
+  uint32_t nblocks;
+  ptr += copy_from_mem(ptr, nblocks);
+  uint8_t nhashes;
+  ptr += copy_from_mem(ptr, nhashes);
+  uint16_t seed_hash;
+  ptr += copy_from_mem(ptr, seed_hash);
+  uint8_t cells_per_block;
+  ptr += copy_from_mem(ptr, cells_per_block);
+
+  check_header_validity(preamble_longs, serial_version, family_id, flags_byte, cells_per_block);
+  if (seed_hash != compute_seed_hash(seed)) {
+    throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
+                                + std::to_string(compute_seed_hash(seed)));
+  }
+  blocked_count_min_sketch c(nhashes, nblocks, seed, allocator);
+  const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
+  if (is_empty) { return c; } // sketch is empty, no need to read further.
+
+  ensure_minimum_memory(size, PREAMBLE_LONGS * sizeof(uint64_t) + sizeof(W) * (1 + c.get_num_cells()));
+  ptr += copy_from_mem(ptr, c._total_weight);
+  copy_from_mem(ptr, c.get_cells(), sizeof(W) * c.get_num_cells());
+  return c;
+}
+
+template<typename W, typename A>
+string<A> blocked_count_min_sketch<W,A>::to_string() const {
+  uint64_t num_nonzero = 0;
+  for (const auto entry: *this) {
+    if (entry != static_cast<W>(0.0)) { ++num_nonzero; }
+  }
+
+  // Using a temporary stream for implementation here does not comply with AllocatorAwareContainer requirements.
+  // The stream does not support passing an allocator instance, and alternatives are complicated.
+  std::ostringstream os;
+  os << "### Blocked Count Min sketch summary:" << std::endl;
+  os << "   num hashes     : " << static_cast<uint32_t>(_num_hashes) << std::endl;
+  os << "   num blocks     : " << _num_blocks << std::endl;
+  os << "   cells per block: " << static_cast<uint32_t>(CELLS_PER_BLOCK) << std::endl;
+  os << "   capacity bins  : " << get_num_cells() << std::endl;
+  os << "   filled bins    : " << num_nonzero << std::endl;
+  os << "   pct filled     : " << std::setprecision(3) << (num_nonzero * 100.0) / get_num_cells() << "%" << std::endl;
+  os << "### End sketch summary" << std::endl;
+
+  return string<A>(os.str().c_str(), _allocator);
+}
+
+template<typename W, typename A>
+A blocked_count_min_sketch<W,A>::get_allocator() const {
+  return _allocator;
+}
+
+template<typename W, typename A>
+void blocked_count_min_sketch<W,A>::check_header_validity(uint8_t preamble_longs, uint8_t serial_version,
+    uint8_t family_id, uint8_t flags_byte, uint8_t cells_per_block) {
+  if (family_id != FAMILY_ID) {
+    throw std::invalid_argument("Family ID mismatch: expected " + std::to_string(FAMILY_ID)
+        + ", actual " + std::to_string(family_id));
+  }
+  if (serial_version != SERIAL_VERSION_1) {
+    throw std::invalid_argument("Serial version mismatch: expected " + std::to_string(SERIAL_VERSION_1)
+        + ", actual " + std::to_string(serial_version));
+  }
+  if (preamble_longs != PREAMBLE_LONGS) {
+    throw std::invalid_argument("Possible sketch corruption. Inconsistent state: preamble_longs = "
+        + std::to_string(preamble_longs));
+  }
+  if (!(flags_byte & (1 << flags::IS_BLOCKED))) {
+    throw std::invalid_argument("Not a blocked count min sketch");
+  }
+  if (cells_per_block != CELLS_PER_BLOCK) {
+    throw std::invalid_argument("Cells per block mismatch: expected " + std::to_string(CELLS_PER_BLOCK)
+        + ", actual " + std::to_string(cells_per_block) + ". Incompatible counter type.");
+  }
+}
+
+} /* namespace datasketches */
+
+#endif
@@ -0,0 +1,337 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CONCURRENT_COUNT_MIN_HPP_
+#define CONCURRENT_COUNT_MIN_HPP_
+
+#include <atomic>
+#include <vector>
+
+#include "common_defs.hpp"
+#include "count_min.hpp"
+
+namespace datasketches {
+
+/**
+ * CountMin sketch that can be updated and queried from many threads at once.
+ *
+ * The counters are atomics incremented with relaxed memory ordering, so updates from
+ * different threads never block each other and need no merge afterwards.
+ * The total weight is spread over several padded atomics selected by the hash of the item,
+ * so that threads do not all contend on one cache line.
+ *
+ * Any query may run concurrently with updates. It reflects some subset of the concurrent updates,
+ * and each counter only grows with non-negative weights, so estimates stay upper bounds
+ * of the frequencies of the items whose updates have completed.
+ * Only the move constructor must not run concurrently with other methods.
+ *
+ * Rows are located with double hashing (see count_min_hash_type::DOUBLE_HASHING) and the serialized form
+ * is that of count_min_sketch, so a serialized sketch can be deserialized by either class.
+ * The template type W is the type of the counters and must be integral.
+ */
+template <typename W,
+          typename Allocator = std::allocator<W>>
+class concurrent_count_min_sketch {
+  static_assert(std::is_integral<W>::value, "Integral type expected");
+public:
+  using allocator_type = Allocator;
+  using sketch_type = count_min_sketch<W, Allocator>;
+
+  /**
+   * Creates an instance of the sketch
+   * @param num_hashes number of hash functions in the sketch. Equivalently the number of rows in the array
+   * @param num_buckets number of buckets that hash functions map into. Equivalently the number of columns in the array
+   * @param seed for hash function
+   * @param allocator to acquire and release memory
+   */
+  concurrent_count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * Move constructor. Must not run concurrently with any other method of the source sketch.
+   * @param other sketch to be moved
+   */
+  concurrent_count_min_sketch(concurrent_count_min_sketch&& other) noexcept;
+
+  // The counters are shared by threads, get_result() gives a copy
+  concurrent_count_min_sketch(const concurrent_count_min_sketch&) = delete;
+  concurrent_count_min_sketch& operator=(const concurrent_count_min_sketch&) = delete;
+
+  /**
+   * @return configured number of hashes of this sketch
+   */
+  uint8_t get_num_hashes() const;
+
+  /**
+   * @return configured number of buckets of this sketch
+   */
+  uint32_t get_num_buckets() const;
+
+  /**
+   * @return configured seed of this sketch
+   */
+  uint64_t get_seed() const;
+
+  /**
+   * @return epsilon, the maximum permissible error relative to the total weight.
+   * epsilon = e / _num_buckets
+   */
+  double get_relative_error() const;
+
+  /**
+   * @return the total weight currently inserted into the stream.
+   */
+  W get_total_weight() const;
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return the estimated frequency of the item
+   */
+  W get_estimate(uint64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return the estimated frequency of the item
+   */
+  W get_estimate(int64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given string.
+   * @param item to query
+   * @return the estimated frequency of the item
+   */
+  W get_estimate(const std::string& item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item of any type.
+   * @param item pointer to the data item to be queried
+   * @param size of the item in bytes
+   * @return the estimated frequency of the item
+   */
+  W get_estimate(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given string.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item
+   */
+  W get_upper_bound(const std::string& item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given string.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  W get_lower_bound(const std::string& item) const;
+
+  /**
+   * Update this sketch with given data of any type. Safe to call from many threads.
+   * @param item pointer to the data item to be inserted into the sketch.
+   * @param size of the data in bytes
+   * @param weight of the item
+   */
+  void update(const void* item, size_t size, W weight);
+
+  /**
+   * Update this sketch with a given item. Safe to call from many threads.
+   * @param item to update the sketch with
+   * @param weight of the item
+   */
+  void update(uint64_t item, W weight = 1);
+
+  /**
+   * Update this sketch with a given item. Safe to call from many threads.
+   * @param item to update the sketch with
+   * @param weight of the item
+   */
+  void update(int64_t item, W weight = 1);
+
+  /**
+   * Update this sketch with a given string. Safe to call from many threads.
+   * @param item string to update the sketch with
+   * @param weight of the item
+   */
+  void update(const std::string& item, W weight = 1);
+
+  /**
+   * Merges a count_min_sketch into this sketch.
+   * The other sketch must use double hashing and the same parameters.
+   * Safe to call concurrently with updates.
+   * @param other_sketch sketch to merge
+   */
+  void merge(const sketch_type& other_sketch);
+
+  /**
+   * Returns true if this sketch is empty.
+   * @return empty flag
+   */
+  bool is_empty() const;
+
+  /**
+   * Copies the current state into a count_min_sketch.
+   * @return a count_min_sketch with double hashing and the counters of this sketch
+   */
+  sketch_type get_result() const;
+
+  /**
+   * @brief Returns a string describing the sketch
+   * @return A string with a human-readable description of the sketch
+   */
+  string<Allocator> to_string() const;
+
+  /**
+   * Computes size needed to serialize the current state of the sketch.
+   * @return size in bytes needed to serialize this sketch
+   */
+  size_t get_serialized_size_bytes() const;
+
+  /**
+   * This method serializes the sketch into a given stream in the binary form of count_min_sketch
+   * @param os output stream
+   */
+  void serialize(std::ostream& os) const;
+
+  // This is a convenience alias for users
+  // The type returned by the following serialize method
+  using vector_bytes = typename sketch_type::vector_bytes;
+
+  /**
+   * This method serializes the sketch as a vector of bytes in the binary form of count_min_sketch.
+   * An optional header can be reserved in front of the sketch.
+   * @param header_size_bytes space to reserve in front of the sketch
+   */
+  vector_bytes serialize(unsigned header_size_bytes = 0) const;
+
+  /**
+   * This method deserializes a sketch from a given stream.
+   * The serialized count_min_sketch must use double hashing.
+   * @param is input stream
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of a sketch
+   */
+  static concurrent_count_min_sketch deserialize(std::istream& is, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * This method deserializes a sketch from a given array of bytes.
+   * The serialized count_min_sketch must use double hashing.
+   * @param bytes pointer to the array of bytes
+   * @param size the size of the array
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of the sketch
+   */
+  static concurrent_count_min_sketch deserialize(const void* bytes, size_t size, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * @return allocator
+   */
+  allocator_type get_allocator() const;
+
+private:
+  using AllocAtomic = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<W>>;
+
+  // Padded to keep the stripes of the total weight in separate cache lines
+  struct weight_stripe {
+    std::atomic<W> value;
+    char padding[64 - sizeof(std::atomic<W>)];
+  };
+
+  static const uint8_t LG_NUM_WEIGHT_STRIPES = 6;
+
+  Allocator _allocator;
+  uint8_t _num_hashes;
+  uint32_t _num_buckets;
+  uint32_t _bucket_mask; // _num_buckets - 1 if _num_buckets is a power of 2, zero otherwise
+  uint64_t _seed;
+  std::vector<std::atomic<W>, AllocAtomic> _sketch_array;
+  weight_stripe _total_weight[1 << LG_NUM_WEIGHT_STRIPES];
+
+  static const uint8_t PREAMBLE_LONGS = 2;
+  static const uint8_t SERIAL_VERSION_1 = 1;
+  static const uint8_t FAMILY_ID = 18;
+
+  void check_compatibility(const sketch_type& other_sketch) const;
+  static uint8_t get_flags_byte(W total_weight);
+  static concurrent_count_min_sketch from_sketch(const sketch_type& sketch);
+
+  /*
+   * Compute the hash locations for an input item
+   * @param item pointer to the data item to be inserted into or queried from the sketch.
+   * @param size of the data in bytes
+   * @param callback function to invoke for each sketch array location
+   * @return the index of the total weight stripe of the item
+   */
+  template<typename F>
+  size_t foreach_hash_location(const void* item, size_t size, F callback) const;
+};
+
+} /* namespace datasketches */
+
+#include "concurrent_count_min_impl.hpp"
+
+#endif
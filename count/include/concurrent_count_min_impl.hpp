@@ -0,0 +1,361 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CONCURRENT_COUNT_MIN_IMPL_HPP_
+#define CONCURRENT_COUNT_MIN_IMPL_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "MurmurHash3.h"
+#include "concurrent_count_min.hpp"
+#include "memory_operations.hpp"
+
+namespace datasketches {
+
+template<typename W, typename A>
+concurrent_count_min_sketch<W,A>::concurrent_count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed,
+    const A& allocator):
+_allocator(allocator),
+_num_hashes(num_hashes),
+_num_buckets(num_buckets),
+_bucket_mask((num_buckets & (num_buckets - 1)) == 0 ? num_buckets - 1 : 0),
+_seed(seed),
+// std::atomic cannot be copied, so the counters are value-initialized (zero) in place
+_sketch_array(static_cast<uint64_t>(num_buckets) * num_hashes < 1 << 30 ? static_cast<size_t>(num_buckets) * num_hashes : 0,
+    AllocAtomic(allocator)) {
+  if (num_hashes < 1) {
+    throw std::invalid_argument("Must have at least 1 hash function");
+  }
+  if (num_buckets < 3) {
+    throw std::invalid_argument("Using fewer than 3 buckets incurs relative error greater than 1.");
+  }
+  // Same limit on the number of counters as count_min_sketch
+  if (static_cast<uint64_t>(num_buckets) * num_hashes >= 1 << 30) {
+    throw std::invalid_argument("These parameters generate a sketch that exceeds 2^30 elements."
+                                "Try reducing either the number of buckets or the number of hash functions.");
+  }
+  for (auto& stripe: _total_weight) stripe.value.store(0, std::memory_order_relaxed);
+}
+
+template<typename W, typename A>
+concurrent_count_min_sketch<W,A>::concurrent_count_min_sketch(concurrent_count_min_sketch&& other) noexcept:
+_allocator(std::move(other._allocator)),
+_num_hashes(other._num_hashes),
+_num_buckets(other._num_buckets),
+_bucket_mask(other._bucket_mask),
+_seed(other._seed),
+_sketch_array(std::move(other._sketch_array)) {
+  for (size_t i = 0; i < (1 << LG_NUM_WEIGHT_STRIPES); ++i) {
+    _total_weight[i].value.store(other._total_weight[i].value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+template<typename W, typename A>
+uint8_t concurrent_count_min_sketch<W,A>::get_num_hashes() const {
+  return _num_hashes;
+}
+
+template<typename W, typename A>
+uint32_t concurrent_count_min_sketch<W,A>::get_num_buckets() const {
+  return _num_buckets;
+}
+
+template<typename W, typename A>
+uint64_t concurrent_count_min_sketch<W,A>::get_seed() const {
+  return _seed;
+}
+
+template<typename W, typename A>
+double concurrent_count_min_sketch<W,A>::get_relative_error() const {
+  return exp(1.0) / static_cast<double>(_num_buckets);
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_total_weight() const {
+  W total_weight = 0;
+  for (const auto& stripe: _total_weight) total_weight += stripe.value.load(std::memory_order_relaxed);
+  return total_weight;
+}
+
+template<typename W, typename A>
+template<typename F>
+size_t concurrent_count_min_sketch<W,A>::foreach_hash_location(const void* item, size_t size, F callback) const {
+  // Same locations as count_min_sketch with count_min_hash_type::DOUBLE_HASHING
+  HashState hashes;
+  MurmurHash3_x64_128(item, size, _seed, hashes);
+  const uint64_t h2 = hashes.h2 | 1;
+  uint64_t hash = hashes.h1;
+  uint64_t row_offset = 0;
+  for (uint8_t i = 0; i < _num_hashes; ++i) {
+    callback(row_offset + (_bucket_mask != 0 ? hash & _bucket_mask : hash % _num_buckets));
+    hash += h2;
+    row_offset += _num_buckets;
+  }
+  return hashes.h2 >> (64 - LG_NUM_WEIGHT_STRIPES);
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_estimate(uint64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_estimate(int64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_estimate(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_estimate(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_estimate(const void* item, size_t size) const {
+  W estimate = std::numeric_limits<W>::max();
+  foreach_hash_location(item, size, [this, &estimate](uint64_t h) {
+    estimate = std::min(estimate, _sketch_array[h].load(std::memory_order_relaxed));
+  });
+  return estimate;
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::update(uint64_t item, W weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::update(int64_t item, W weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::update(const std::string& item, W weight) {
+  if (item.empty()) { return; }
+  update(item.c_str(), item.length(), weight);
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::update(const void* item, size_t size, W weight) {
+  const size_t stripe = foreach_hash_location(item, size, [this, weight](uint64_t h) {
+    _sketch_array[h].fetch_add(weight, std::memory_order_relaxed);
+  });
+  _total_weight[stripe].value.fetch_add(weight >= 0 ? weight : -weight, std::memory_order_relaxed);
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_upper_bound(uint64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_upper_bound(int64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_upper_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_upper_bound(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_upper_bound(const void* item, size_t size) const {
+  return static_cast<W>(get_estimate(item, size) + get_relative_error() * get_total_weight());
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_lower_bound(uint64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_lower_bound(int64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_lower_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_lower_bound(item.c_str(), item.length());
+}
+
+template<typename W, typename A>
+W concurrent_count_min_sketch<W,A>::get_lower_bound(const void* item, size_t size) const {
+  return get_estimate(item, size);
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::check_compatibility(const sketch_type& other_sketch) const {
+  const bool acceptable_config =
+    (get_num_hashes() == other_sketch.get_num_hashes()) &&
+    (get_num_buckets() == other_sketch.get_num_buckets()) &&
+    (get_seed() == other_sketch.get_seed()) &&
+    (other_sketch.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  if (!acceptable_config) { throw std::invalid_argument("Incompatible sketch configuration."); }
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::merge(const sketch_type& other_sketch) {
+  check_compatibility(other_sketch);
+  auto it = _sketch_array.begin();
+  for (const W value: other_sketch) {
+    if (value != 0) it->fetch_add(value, std::memory_order_relaxed);
+    ++it;
+  }
+  _total_weight[0].value.fetch_add(other_sketch.get_total_weight(), std::memory_order_relaxed);
+}
+
+template<typename W, typename A>
+bool concurrent_count_min_sketch<W,A>::is_empty() const {
+  return get_total_weight() == 0;
+}
+
+template<typename W, typename A>
+auto concurrent_count_min_sketch<W,A>::get_result() const -> sketch_type {
+  const auto bytes = serialize();
+  return sketch_type::deserialize(bytes.data(), bytes.size(), _seed, _allocator);
+}
+
+template<typename W, typename A>
+size_t concurrent_count_min_sketch<W,A>::get_serialized_size_bytes() const {
+  return PREAMBLE_LONGS * sizeof(uint64_t) + (is_empty() ? 0 : sizeof(W) * (1 + _sketch_array.size()));
+}
+
+template<typename W, typename A>
+void concurrent_count_min_sketch<W,A>::serialize(std::ostream& os) const {
+  // the total weight is read once so that the header and the size agree
+  const W total_weight = get_total_weight();
+
+  // Long 0
+  const uint8_t preamble_longs = PREAMBLE_LONGS;
+  write(os, preamble_longs);
+  const uint8_t ser_ver = SERIAL_VERSION_1;
+  write(os, ser_ver);
+  const uint8_t family_id = FAMILY_ID;
+  write(os, family_id);
+  const uint8_t flags_byte = get_flags_byte(total_weight);
+  write(os, flags_byte);
+  const uint32_t unused32 = 0;
+  write(os, unused32);
+
+  // Long 1
+  write(os, _num_buckets);
+  write(os, _num_hashes);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  write(os, seed_hash);
+  const uint8_t unused8 = 0;
+  write(os, unused8);
+  if (total_weight == 0) { return; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  write(os, total_weight);
+
+  // Long 3 onwards
+  for (const auto& counter: _sketch_array) {
+    write(os, counter.load(std::memory_order_relaxed));
+  }
+}
+
+template<typename W, typename A>
+auto concurrent_count_min_sketch<W,A>::serialize(unsigned header_size_bytes) const -> vector_bytes {
+  // the total weight is read once so that the header and the size agree
+  const W total_weight = get_total_weight();
+  const size_t size_bytes = PREAMBLE_LONGS * sizeof(uint64_t) + (total_weight == 0 ? 0 : sizeof(W) * (1 + _sketch_array.size()));
+  vector_bytes bytes(header_size_bytes + size_bytes, 0, _allocator);
+  uint8_t* ptr = bytes.data() + header_size_bytes;
+
+  // Long 0
+  const uint8_t preamble_longs = PREAMBLE_LONGS;
+  ptr += copy_to_mem(preamble_longs, ptr);
+  const uint8_t ser_ver = SERIAL_VERSION_1;
+  ptr += copy_to_mem(ser_ver, ptr);
+  const uint8_t family_id = FAMILY_ID;
+  ptr += copy_to_mem(family_id, ptr);
+  const uint8_t flags_byte = get_flags_byte(total_weight);
+  ptr += copy_to_mem(flags_byte, ptr);
+  const uint32_t unused32 = 0;
+  ptr += copy_to_mem(unused32, ptr);
+
+  // Long 1
+  ptr += copy_to_mem(_num_buckets, ptr);
+  ptr += copy_to_mem(_num_hashes, ptr);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  ptr += copy_to_mem(seed_hash, ptr);
+  const uint8_t unused8 = 0;
+  ptr += copy_to_mem(unused8, ptr);
+  if (total_weight == 0) { return bytes; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  ptr += copy_to_mem(total_weight, ptr);
+
+  // Long 3 onwards
+  for (const auto& counter: _sketch_array) {
+    const W value = counter.load(std::memory_order_relaxed);
+    ptr += copy_to_mem(value, ptr);
+  }
+  return bytes;
+}
+
+template<typename W, typename A>
+uint8_t concurrent_count_min_sketch<W,A>::get_flags_byte(W total_weight) {
+  return (total_weight == 0 ? 1 << sketch_type::flags::IS_EMPTY : 0) | 1 << sketch_type::flags::IS_DOUBLE_HASHED;
+}
+
+template<typename W, typename A>
+auto concurrent_count_min_sketch<W,A>::from_sketch(const sketch_type& sketch) -> concurrent_count_min_sketch {
+  if (sketch.get_hash_type() != count_min_hash_type::DOUBLE_HASHING) {
+    throw std::invalid_argument("Concurrent count min sketch requires double hashing");
+  }
+  concurrent_count_min_sketch c(sketch.get_num_hashes(), sketch.get_num_buckets(), sketch.get_seed(), sketch.get_allocator());
+  c.merge(sketch);
+  return c;
+}
+
+template<typename W, typename A>
+auto concurrent_count_min_sketch<W,A>::deserialize(std::istream& is, uint64_t seed, const A& allocator) -> concurrent_count_min_sketch {
+  return from_sketch(sketch_type::deserialize(is, seed, allocator));
+}
+
+template<typename W, typename A>
+auto concurrent_count_min_sketch<W,A>::deserialize(const void* bytes, size_t size, uint64_t seed, const A& allocator) -> concurrent_count_min_sketch {
+  // not wrapped, the counters of an arbitrary image may not be aligned for W
+  return from_sketch(sketch_type::deserialize(bytes, size, seed, allocator));
+}
+
+template<typename W, typename A>
+string<A> concurrent_count_min_sketch<W,A>::to_string() const {
+  uint64_t num_nonzero = 0;
+  for (const auto& counter: _sketch_array) {
+    if (counter.load(std::memory_order_relaxed) != 0) { ++num_nonzero; }
+  }
+
+  // Using a temporary stream for implementation here does not comply with AllocatorAwareContainer requirements.
+  // The stream does not support passing an allocator instance, and alternatives are complicated.
+  std::ostringstream os;
+  os << "### Concurrent Count Min sketch summary:" << std::endl;
+  os << "   num hashes     : " << static_cast<uint32_t>(_num_hashes) << std::endl;
+  os << "   num buckets    : " << _num_buckets << std::endl;
+  os << "   capacity bins  : " << _sketch_array.size() << std::endl;
+  os << "   filled bins    : " << num_nonzero << std::endl;
+  os << "   pct filled     : " << std::setprecision(3) << (num_nonzero * 100.0) / _sketch_array.size() << "%" << std::endl;
+  os << "### End sketch summary" << std::endl;
+
+  return string<A>(os.str().c_str(), _allocator);
+}
+
+template<typename W, typename A>
+A concurrent_count_min_sketch<W,A>::get_allocator() const {
+  return _allocator;
+}
+
+} /* namespace datasketches */
+
+#endif
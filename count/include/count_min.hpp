@@ -25,6 +25,21 @@
 
 namespace datasketches {
 
+/// Count Min hashing scheme
+enum count_min_hash_type {
+  PER_ROW_HASHING, ///< one MurmurHash3 call per row, each with its own seed (original scheme)
+  DOUBLE_HASHING ///< all row locations derived from one 128-bit MurmurHash3 call (Kirsch and Mitzenmacher)
+};
+
+/// Count Min update policy
+enum count_min_update_type {
+  STANDARD_UPDATE, ///< add the weight to the counter of the item in every row
+  CONSERVATIVE_UPDATE ///< raise only the counters of the item that are below its new estimate (non-negative weights only)
+};
+
+// forward declaration
+template<typename W, typename A> class concurrent_count_min_sketch;
+
 /**
  * C++ implementation of the CountMin sketch data structure of Cormode and Muthukrishnan.
  * [1] - http://dimacs.rutgers.edu/~graham/pubs/papers/cm-full.pdf
@@ -38,7 +53,7 @@ class count_min_sketch{
   static_assert(std::is_arithmetic<W>::value, "Arithmetic type expected");
 public:
   using allocator_type = Allocator;
-  using const_iterator = typename std::vector<W, Allocator>::const_iterator;
+  using const_iterator = const W*;
 
   /**
    * Creates an instance of the sketch given parameters _num_hashes, _num_buckets and hash seed, `seed`.
@@ -52,6 +67,37 @@ public:
    */
   count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed = DEFAULT_SEED, const Allocator& allocator = Allocator());
 
+  /**
+   * Creates an instance of the sketch with a given hashing scheme.
+   * @param num_hashes number of hash functions in the sketch. Equivalently the number of rows in the array
+   * @param num_buckets number of buckets that hash functions map into. Equivalently the number of columns in the array
+   * @param hash_type scheme used to compute the location of an item in every row.
+   * DOUBLE_HASHING computes a single 128-bit hash per item and derives all row locations from it,
+   * which is considerably faster than PER_ROW_HASHING for sketches with many rows.
+   * Sketches with different hashing schemes cannot be merged.
+   * @param seed for hash function
+   * @param allocator to acquire and release memory
+   */
+  count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+      uint64_t seed = DEFAULT_SEED, const Allocator& allocator = Allocator());
+
+  /**
+   * Creates an instance of the sketch with a given hashing scheme and update policy.
+   * @param num_hashes number of hash functions in the sketch. Equivalently the number of rows in the array
+   * @param num_buckets number of buckets that hash functions map into. Equivalently the number of columns in the array
+   * @param hash_type scheme used to compute the location of an item in every row
+   * @param update_type policy used to update the counters.
+   * With CONSERVATIVE_UPDATE an update first computes the estimate of the item across all rows and then
+   * raises only the counters that are below the estimate plus the weight, leaving the others untouched.
+   * No counter ever gets larger than with STANDARD_UPDATE, so the error guarantees still hold while the
+   * observed error is typically much smaller, which allows a smaller number of buckets for the same accuracy.
+   * Conservative update requires non-negative weights.
+   * @param seed for hash function
+   * @param allocator to acquire and release memory
+   */
+  count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+      count_min_update_type update_type, uint64_t seed = DEFAULT_SEED, const Allocator& allocator = Allocator());
+
   /**
    * @return configured _num_hashes of this sketch
    */
@@ -67,6 +113,16 @@ public:
    */
   uint64_t get_seed()  const;
 
+  /**
+   * @return hashing scheme of this sketch
+   */
+  count_min_hash_type get_hash_type() const;
+
+  /**
+   * @return update policy of this sketch
+   */
+  count_min_update_type get_update_type() const;
+
   /**
    * @return epsilon
    * The maximum permissible error for any frequency estimate query.
@@ -92,6 +148,17 @@ public:
    */
   static uint32_t suggest_num_buckets(double relative_error);
 
+  /**
+   * Suggests a power of 2 number of buckets that achieves at least the given relative error.
+   * Sketches with a power of 2 number of buckets map hashes to buckets with a bit mask
+   * rather than an integer division, which makes updates and queries cheaper.
+   * The bucket locations are identical to the ones computed with the division,
+   * so such sketches are fully compatible with the serialized format.
+   * @param relative_error the desired accuracy within which estimates should lie.
+   * @return the smallest power of 2 number of buckets not less than suggest_num_buckets(relative_error)
+   */
+  static uint32_t suggest_num_buckets_pow2(double relative_error);
+
   /**
    * Suggests the number of hash functions required to achieve the given confidence
    * @param confidence the desired confidence with which estimates should be correct.
@@ -137,6 +204,26 @@ public:
    */
   W get_estimate(const void* item, size_t size) const;
 
+  /**
+   * Estimates the frequencies of a batch of items.
+   * Equivalent to calling get_estimate(items[i]) for every item, but hash locations are computed
+   * for a block of items before the counters are read so that cache misses overlap.
+   * @param items pointer to the array of items
+   * @param estimates pointer to the array of size num_items to write the estimates to
+   * @param num_items number of items in the batch
+   */
+  void get_estimates(const uint64_t* items, W* estimates, size_t num_items) const;
+
+  /**
+   * Estimates the frequencies of a batch of strings.
+   * Equivalent to calling get_estimate(items[i]) for every item, but hash locations are computed
+   * for a block of items before the counters are read so that cache misses overlap.
+   * @param items pointer to the array of strings
+   * @param estimates pointer to the array of size num_items to write the estimates to
+   * @param num_items number of items in the batch
+   */
+  void get_estimates(const std::string* items, W* estimates, size_t num_items) const;
+
   /**
    * Query the sketch for the upper bound of a given item.
    * @param item to query
@@ -209,7 +296,7 @@ public:
    * but may produce different hashes compared to specialized update methods.
    * @param item pointer to the data item to be inserted into the sketch.
    * @param size of the data in bytes
-   * @param weight arithmetic type
+   * @param weight arithmetic type, must not be negative with CONSERVATIVE_UPDATE
    */
   void update(const void* item, size_t size, W weight);
 
@@ -234,12 +321,41 @@ public:
    */
   void update(const std::string& item, W weight = 1);
 
+  /**
+   * Update this sketch with a batch of items.
+   * Equivalent to calling update(items[i], weights[i]) for every item, but hash locations are computed
+   * for a block of items before the counters are touched so that cache misses overlap.
+   * @param items pointer to the array of items
+   * @param weights pointer to the array of num_items weights, or nullptr for a weight of 1 for every item
+   * @param num_items number of items in the batch
+   */
+  void update_batch(const uint64_t* items, const W* weights, size_t num_items);
+
+  /**
+   * Update this sketch with a batch of strings.
+   * Equivalent to calling update(items[i], weights[i]) for every item, but hash locations are computed
+   * for a block of items before the counters are touched so that cache misses overlap.
+   * @param items pointer to the array of strings
+   * @param weights pointer to the array of num_items weights, or nullptr for a weight of 1 for every item
+   * @param num_items number of items in the batch
+   */
+  void update_batch(const std::string* items, const W* weights, size_t num_items);
+
   /**
    * Merges another count_min_sketch into this count_min_sketch.
    * @param other_sketch
    */
   void merge(const count_min_sketch& other_sketch);
 
+  /**
+   * Merges several count_min_sketches into this count_min_sketch.
+   * The result is the same as merging them one by one, but the counters of this sketch
+   * are traversed once, so merging many sketches is bound by reading the other sketches.
+   * @param other_sketches pointers to the sketches to merge
+   * @param num_sketches number of sketches to merge
+   */
+  void merge_many(const count_min_sketch* const* other_sketches, size_t num_sketches);
+
   /**
    * Returns true if this sketch is empty.
    * A Count Min Sketch is defined to be empty iff weight == 0
@@ -276,7 +392,10 @@ public:
    * 0 - otherwise
    *
    * Byte 1 (serial version), byte 2 (family id), byte 3 (flags):
-   * 00000001 - default for now.
+   * bit 0 - is empty
+   * bit 1 - uses double hashing (see count_min_hash_type)
+   * bit 2 - blocked layout, reserved for blocked_count_min_sketch
+   * bit 3 - uses conservative update (see count_min_update_type)
    *
    * Bytes 4 - 7:
    * uint8_t zero corresponding to ``empty''
@@ -358,6 +477,45 @@ public:
   */
   static count_min_sketch deserialize(const void* bytes, size_t size, uint64_t seed=DEFAULT_SEED, const Allocator& allocator = Allocator());
 
+  /**
+   * Wraps a serialized sketch as a read-only sketch. The counters are read in place from the given memory,
+   * which must outlive the sketch and be aligned for W. Estimates, bounds, merging into other sketches
+   * and serialization are supported, updates throw.
+   * An empty image has no counters to wrap, so the sketch allocates its own.
+   * Copies of a wrapped sketch refer to the same memory.
+   * @param bytes pointer to the serialized sketch
+   * @param size the size of the serialized sketch in bytes
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return a read-only sketch wrapping the given memory
+   */
+  static const count_min_sketch wrap(const void* bytes, size_t size, uint64_t seed=DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * Wraps a serialized sketch as a writable sketch. Updates and merges modify the counters and
+   * the total weight in place, so the memory remains a valid serialized sketch.
+   * The memory must outlive the sketch and be aligned for W. An empty image cannot be wrapped for writing.
+   * Copies of a wrapped sketch refer to the same memory.
+   * @param bytes pointer to the serialized sketch
+   * @param size the size of the serialized sketch in bytes
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return a sketch wrapping the given memory
+   */
+  static count_min_sketch writable_wrap(void* bytes, size_t size, uint64_t seed=DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * @return true if this sketch cannot be updated
+   */
+  bool is_read_only() const;
+
+  /**
+   * @return true if the counters of this sketch are read from memory given to wrap() or writable_wrap()
+   */
+  bool is_wrapped() const;
+
   /**
    * @return allocator
    */
@@ -367,18 +525,41 @@ private:
   Allocator _allocator;
   uint8_t _num_hashes;
   uint32_t _num_buckets;
-  std::vector<W, Allocator> _sketch_array; // the array stored by the sketch
+  std::vector<W, Allocator> _sketch_array; // the array stored by the sketch, empty if wrapped
   uint64_t _seed;
   W _total_weight;
   std::vector<uint64_t> hash_seeds;
+  count_min_hash_type _hash_type;
+  uint32_t _bucket_mask; // _num_buckets - 1 if _num_buckets is a power of 2, zero otherwise
+  count_min_update_type _update_type;
+  uint8_t* _memory; // start of the wrapped serialized sketch, nullptr if not wrapped
+  bool _is_read_only;
 
-  enum flags {IS_EMPTY};
+  // writes the same serialized form, so builds its flags byte from these bits
+  friend class concurrent_count_min_sketch<W, Allocator>;
+
+  enum flags {IS_EMPTY, IS_DOUBLE_HASHED, IS_BLOCKED, IS_CONSERVATIVE, IS_SATURATING};
   static const uint8_t PREAMBLE_LONGS_SHORT = 2; // Empty -> need second byte for sketch parameters
   static const uint8_t PREAMBLE_LONGS_FULL = 3; // Not empty -> need (at least) third byte for total weight.
   static const uint8_t SERIAL_VERSION_1 = 1;
   static const uint8_t FAMILY_ID = 18;
   static const uint8_t NULL_8 = 0;
   static const uint32_t NULL_32 = 0;
+  static const size_t BATCH_LOCATIONS = 512; // hash locations buffered per block by batch methods
+  static const size_t TOTAL_WEIGHT_OFFSET_BYTES = PREAMBLE_LONGS_SHORT * sizeof(uint64_t);
+  static const size_t COUNTERS_OFFSET_BYTES = TOTAL_WEIGHT_OFFSET_BYTES + sizeof(W);
+
+  // used by the public constructors and wrap methods, does not allocate counters if memory is given
+  count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+      count_min_update_type update_type, uint64_t seed, uint8_t* memory, bool read_only, const Allocator& allocator);
+
+  static count_min_sketch internal_wrap(void* bytes, size_t size, uint64_t seed, bool read_only, const Allocator& allocator);
+
+  W* get_counters();
+  const W* get_counters() const;
+  size_t get_num_counters() const;
+  void check_writable() const;
+  void write_total_weight();
 
   /**
    * Throws an error if the header is not valid.
@@ -388,6 +569,26 @@ private:
    */
   static void check_header_validity(uint8_t preamble_longs, uint8_t serial_version, uint8_t family_id, uint8_t flags_byte);
 
+  void check_merge_compatibility(const count_min_sketch& other_sketch) const;
+
+  static count_min_hash_type hash_type_from_flags(uint8_t flags_byte);
+  static count_min_update_type update_type_from_flags(uint8_t flags_byte);
+  uint8_t get_flags_byte() const;
+
+  /*
+   * Adds the weight to the counters at the given locations of an item according to the update policy
+   * @param locations array of _num_hashes locations in the sketch array
+   * @param weight of the item
+   */
+  void update_locations(const uint64_t* locations, W weight);
+
+  /*
+   * Maps a hash to a bucket index within a row
+   * @param hash 64-bit hash value
+   * @return bucket index in the range [0, _num_buckets)
+   */
+  uint64_t get_bucket_index(uint64_t hash) const;
+
   /*
    * Compute the hash locations for an input item
    * @param item pointer to the data item to be inserted into or queried from the sketch.
@@ -397,6 +598,29 @@ private:
   template<typename F>
   void foreach_hash_location(const void* item, size_t size, F callback) const;
 
+  /*
+   * Computes and prefetches the hash locations for a block of items before invoking
+   * the callback for each item of the block in order
+   * @param items pointer to the array of items
+   * @param num_items number of items
+   * @param callback function to invoke with the index of an item and a pointer to its _num_hashes locations
+   */
+  template<typename T, typename F>
+  void foreach_batch_hash_locations(const T* items, size_t num_items, F callback) const;
+
+  template<typename T>
+  void update_batch_impl(const T* items, const W* weights, size_t num_items);
+
+  template<typename T>
+  void get_estimates_impl(const T* items, W* estimates, size_t num_items) const;
+
+  static const void* item_data(const uint64_t& item) { return &item; }
+  static size_t item_size(const uint64_t& item) { return sizeof(item); }
+  static bool is_ignored(const uint64_t&) { return false; }
+  static const void* item_data(const std::string& item) { return item.c_str(); }
+  static size_t item_size(const std::string& item) { return item.length(); }
+  static bool is_ignored(const std::string& item) { return item.empty(); } // Empty strings are not inserted into the sketch.
+
 };
 
 } /* namespace datasketches */
@@ -26,19 +26,41 @@
 #include <sstream>
 
 #include "MurmurHash3.h"
+#include "ceiling_power_of_2.hpp"
 #include "count_min.hpp"
 #include "memory_operations.hpp"
+#include "simd_ops.hpp"
 
 namespace datasketches {
 
 template<typename W, typename A>
 count_min_sketch<W,A>::count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed, const A& allocator):
+count_min_sketch(num_hashes, num_buckets, count_min_hash_type::PER_ROW_HASHING, seed, allocator) {}
+
+template<typename W, typename A>
+count_min_sketch<W,A>::count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+    uint64_t seed, const A& allocator):
+count_min_sketch(num_hashes, num_buckets, hash_type, count_min_update_type::STANDARD_UPDATE, seed, allocator) {}
+
+template<typename W, typename A>
+count_min_sketch<W,A>::count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+    count_min_update_type update_type, uint64_t seed, const A& allocator):
+count_min_sketch(num_hashes, num_buckets, hash_type, update_type, seed, nullptr, false, allocator) {}
+
+template<typename W, typename A>
+count_min_sketch<W,A>::count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, count_min_hash_type hash_type,
+    count_min_update_type update_type, uint64_t seed, uint8_t* memory, bool read_only, const A& allocator):
 _allocator(allocator),
 _num_hashes(num_hashes),
 _num_buckets(num_buckets),
-_sketch_array((num_hashes*num_buckets < 1<<30) ? num_hashes*num_buckets : 0, 0, _allocator),
+_sketch_array((memory == nullptr && num_hashes*num_buckets < 1<<30) ? num_hashes*num_buckets : 0, 0, _allocator),
 _seed(seed),
-_total_weight(0) {
+_total_weight(0),
+_hash_type(hash_type),
+_bucket_mask((num_buckets & (num_buckets - 1)) == 0 ? num_buckets - 1 : 0),
+_update_type(update_type),
+_memory(memory),
+_is_read_only(read_only) {
   if (num_buckets < 3) {
     throw std::invalid_argument("Using fewer than 3 buckets incurs relative error greater than 1.");
   }
@@ -50,6 +72,9 @@ _total_weight(0) {
                                 "Try reducing either the number of buckets or the number of hash functions.");
   }
 
+  // Double hashing derives every row from a single hash computed with the global seed.
+  if (_hash_type == count_min_hash_type::DOUBLE_HASHING) return;
+
   std::default_random_engine rng(_seed);
   std::uniform_int_distribution<uint64_t> extra_hash_seeds(0, std::numeric_limits<uint64_t>::max());
   hash_seeds.reserve(num_hashes);
@@ -74,6 +99,16 @@ uint64_t count_min_sketch<W,A>::get_seed() const {
   return _seed;
 }
 
+template<typename W, typename A>
+count_min_hash_type count_min_sketch<W,A>::get_hash_type() const {
+  return _hash_type;
+}
+
+template<typename W, typename A>
+count_min_update_type count_min_sketch<W,A>::get_update_type() const {
+  return _update_type;
+}
+
 template<typename W, typename A>
 double count_min_sketch<W,A>::get_relative_error() const {
   return exp(1.0) / static_cast<double>(_num_buckets);
@@ -88,7 +123,7 @@ template<typename W, typename A>
 uint32_t count_min_sketch<W,A>::suggest_num_buckets(double relative_error) {
   /*
    * Function to help users select a number of buckets for a given error.
-   * TODO: Change this when we use only power of 2 buckets.
+   * See suggest_num_buckets_pow2 for a power of 2 number of buckets.
    */
   if (relative_error < 0.) {
     throw std::invalid_argument("Relative error must be at least 0.");
@@ -96,6 +131,15 @@ uint32_t count_min_sketch<W,A>::suggest_num_buckets(double relative_error) {
   return static_cast<uint32_t>(ceil(exp(1.0) / relative_error));
 }
 
+template<typename W, typename A>
+uint32_t count_min_sketch<W,A>::suggest_num_buckets_pow2(double relative_error) {
+  const uint32_t num_buckets = suggest_num_buckets(relative_error);
+  if (num_buckets > (1U << 31)) {
+    throw std::invalid_argument("Relative error is too small for a power of 2 number of buckets.");
+  }
+  return ceiling_power_of_2(num_buckets);
+}
+
 template<typename W, typename A>
 uint8_t count_min_sketch<W,A>::suggest_num_hashes(double confidence) {
   /*
@@ -113,19 +157,32 @@ template<typename W, typename A>
 template<typename F>
 void count_min_sketch<W,A>::foreach_hash_location(const void* item, size_t size, F callback) const {
   /*
-   * Computes the hash locations for the input item using the original hashing
-   * scheme from [1].
-   * Generate _num_hashes separate hashes from calls to murmurmhash.
-   * This could be optimized by keeping both of the 64bit parts of the hash
-   * function, rather than generating a new one for every level.
+   * Computes the hash locations for the input item.
    *
+   * PER_ROW_HASHING is the original hashing scheme from [1]:
+   * generate _num_hashes separate hashes from calls to murmurhash, one per row,
+   * each with its own seed.
    *
-   * Postscript.
-   * Note that a tradeoff can be achieved over the update time and space
-   * complexity of the sketch by using a combinatorial hashing scheme from
-   * https://github.com/Claudenw/BloomFilter/wiki/Bloom-Filters----An-overview
+   * DOUBLE_HASHING keeps both of the 64bit parts of a single murmurhash call
+   * and derives the location in row i as h1 + i * h2, following
    * https://www.eecs.harvard.edu/~michaelm/postscripts/tr-02-05.pdf
+   * h2 is forced to be odd so that the rows do not collapse onto the same
+   * bucket when the number of buckets is even.
    */
+  if (_hash_type == count_min_hash_type::DOUBLE_HASHING) {
+    HashState hashes;
+    MurmurHash3_x64_128(item, size, _seed, hashes);
+    const uint64_t h2 = hashes.h2 | 1;
+    uint64_t hash = hashes.h1;
+    uint64_t row_offset = 0;
+    for (uint8_t i = 0; i < _num_hashes; ++i) {
+      callback(row_offset + get_bucket_index(hash));
+      hash += h2;
+      row_offset += _num_buckets;
+    }
+    return;
+  }
+
   uint64_t bucket_index;
 
   uint64_t hash_seed_index = 0;
@@ -133,12 +190,18 @@ void count_min_sketch<W,A>::foreach_hash_location(const void* item, size_t size,
     HashState hashes;
     MurmurHash3_x64_128(item, size, it, hashes); // ? BEWARE OVERFLOW.
     uint64_t hash = hashes.h1;
-    bucket_index = hash % _num_buckets;
+    bucket_index = get_bucket_index(hash);
     callback((hash_seed_index * _num_buckets) + bucket_index);
     hash_seed_index += 1;
   }
 }
 
+template<typename W, typename A>
+uint64_t count_min_sketch<W,A>::get_bucket_index(uint64_t hash) const {
+  // for a power of 2 number of buckets the mask gives the same result as the remainder
+  return _bucket_mask != 0 ? hash & _bucket_mask : hash % _num_buckets;
+}
+
 template<typename W, typename A>
 W count_min_sketch<W,A>::get_estimate(uint64_t item) const {return get_estimate(&item, sizeof(item));}
 
@@ -156,13 +219,65 @@ W count_min_sketch<W,A>::get_estimate(const void* item, size_t size) const {
   /*
    * Returns the estimated frequency of the item
    */
+  const W* counters = get_counters();
   W estimate = std::numeric_limits<W>::max();
-  foreach_hash_location(item, size, [this, &estimate](uint64_t h) {
-    estimate = std::min(estimate, _sketch_array[h]);
+  foreach_hash_location(item, size, [counters, &estimate](uint64_t h) {
+    estimate = std::min(estimate, counters[h]);
   });
   return estimate;
 }
 
+template<typename W, typename A>
+void count_min_sketch<W,A>::get_estimates(const uint64_t* items, W* estimates, size_t num_items) const {
+  get_estimates_impl(items, estimates, num_items);
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::get_estimates(const std::string* items, W* estimates, size_t num_items) const {
+  get_estimates_impl(items, estimates, num_items);
+}
+
+template<typename W, typename A>
+template<typename T>
+void count_min_sketch<W,A>::get_estimates_impl(const T* items, W* estimates, size_t num_items) const {
+  const W* counters = get_counters();
+  foreach_batch_hash_locations(items, num_items, [this, counters, items, estimates](size_t i, const uint64_t* locations) {
+    if (is_ignored(items[i])) {
+      estimates[i] = 0;
+      return;
+    }
+    W estimate = std::numeric_limits<W>::max();
+    for (uint8_t j = 0; j < _num_hashes; ++j) estimate = std::min(estimate, counters[locations[j]]);
+    estimates[i] = estimate;
+  });
+}
+
+template<typename W, typename A>
+template<typename T, typename F>
+void count_min_sketch<W,A>::foreach_batch_hash_locations(const T* items, size_t num_items, F callback) const {
+  /*
+   * Hashing a block of items first and prefetching all of their counters lets
+   * the cache misses of different items overlap instead of running one after another.
+   */
+  uint64_t locations[BATCH_LOCATIONS];
+  const W* counters = get_counters();
+  // without hash functions there are no locations, but the callback still runs for every item
+  const size_t block_size = _num_hashes > 0 ? BATCH_LOCATIONS / _num_hashes : num_items;
+  for (size_t start = 0; start < num_items; start += block_size) {
+    const size_t end = std::min(start + block_size, num_items);
+    uint64_t* location = locations;
+    for (size_t i = start; i < end; ++i) {
+      foreach_hash_location(item_data(items[i]), item_size(items[i]), [counters, &location](uint64_t h) {
+        prefetch(&counters[h]);
+        *location++ = h;
+      });
+    }
+    for (size_t i = start; i < end; ++i) {
+      callback(i, locations + (i - start) * _num_hashes);
+    }
+  }
+}
+
 template<typename W, typename A>
 void count_min_sketch<W,A>::update(uint64_t item, W weight) {
   update(&item, sizeof(item), weight);
@@ -185,10 +300,73 @@ void count_min_sketch<W,A>::update(const void* item, size_t size, W weight) {
    * Gets the item's hash locations and then increments the sketch in those
    * locations by the weight.
    */
+  check_writable();
+  if (_update_type == count_min_update_type::CONSERVATIVE_UPDATE) {
+    uint64_t locations[UINT8_MAX];
+    uint64_t* location = locations;
+    foreach_hash_location(item, size, [&location](uint64_t h) { *location++ = h; });
+    update_locations(locations, weight);
+  } else {
+    _total_weight += weight >= 0 ? weight : -weight;
+    W* counters = get_counters();
+    foreach_hash_location(item, size, [counters, weight](uint64_t h) {
+      counters[h] += weight;
+    });
+  }
+  write_total_weight();
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::update_locations(const uint64_t* locations, W weight) {
+  if (_update_type == count_min_update_type::CONSERVATIVE_UPDATE) {
+    /*
+     * Conservative update: read all rows to get the current estimate, then
+     * raise only the counters that are below the new estimate.
+     * See Estan and Varghese, "New Directions in Traffic Measurement and Accounting", 2002.
+     */
+    if (weight < 0) throw std::invalid_argument("Conservative update requires non-negative weights.");
+    _total_weight += weight;
+    W* counters = get_counters();
+    W estimate = std::numeric_limits<W>::max();
+    for (uint8_t j = 0; j < _num_hashes; ++j) estimate = std::min(estimate, counters[locations[j]]);
+    const W new_estimate = estimate + weight;
+    for (uint8_t j = 0; j < _num_hashes; ++j) {
+      // branchless: storing back an unchanged counter is cheaper than a mispredicted branch
+      W& counter = counters[locations[j]];
+      counter = std::max(counter, new_estimate);
+    }
+    return;
+  }
   _total_weight += weight >= 0 ? weight : -weight;
-  foreach_hash_location(item, size, [this, weight](uint64_t h) {
-    _sketch_array[h] += weight;
+  W* counters = get_counters();
+  for (uint8_t j = 0; j < _num_hashes; ++j) counters[locations[j]] += weight;
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::update_batch(const uint64_t* items, const W* weights, size_t num_items) {
+  update_batch_impl(items, weights, num_items);
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::update_batch(const std::string* items, const W* weights, size_t num_items) {
+  update_batch_impl(items, weights, num_items);
+}
+
+template<typename W, typename A>
+template<typename T>
+void count_min_sketch<W,A>::update_batch_impl(const T* items, const W* weights, size_t num_items) {
+  check_writable();
+  if (_update_type == count_min_update_type::CONSERVATIVE_UPDATE && weights != nullptr) {
+    // reject the whole batch rather than leave it partially applied
+    for (size_t i = 0; i < num_items; ++i) {
+      if (weights[i] < 0) throw std::invalid_argument("Conservative update requires non-negative weights.");
+    }
+  }
+  foreach_batch_hash_locations(items, num_items, [this, items, weights](size_t i, const uint64_t* locations) {
+    if (is_ignored(items[i])) return;
+    update_locations(locations, weights == nullptr ? 1 : weights[i]);
   });
+  write_total_weight();
 }
 
 template<typename W, typename A>
@@ -229,35 +407,55 @@ template<typename W, typename A>
 void count_min_sketch<W,A>::merge(const count_min_sketch &other_sketch) {
   /*
   * Merges this sketch into other_sketch sketch by elementwise summing of buckets
+  * The sum of conservatively updated counters is still an upper bound on the true
+  * frequencies, so sketches with different update policies can be merged.
   */
   if (this == &other_sketch) { throw std::invalid_argument( "Cannot merge a sketch with itself." ); }
 
+  check_writable();
+  check_merge_compatibility(other_sketch);
+  simd_ops::add(get_counters(), other_sketch.get_counters(), get_num_counters());
+  _total_weight += other_sketch.get_total_weight();
+  write_total_weight();
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::merge_many(const count_min_sketch* const* other_sketches, size_t num_sketches) {
+  check_writable();
+  using AllocPtr = typename std::allocator_traits<A>::template rebind_alloc<const W*>;
+  std::vector<const W*, AllocPtr> arrays{AllocPtr(_allocator)};
+  arrays.reserve(num_sketches);
+  W total_weight = 0;
+  for (size_t i = 0; i < num_sketches; ++i) {
+    if (this == other_sketches[i]) { throw std::invalid_argument( "Cannot merge a sketch with itself." ); }
+    check_merge_compatibility(*other_sketches[i]);
+    arrays.push_back(other_sketches[i]->get_counters());
+    total_weight += other_sketches[i]->get_total_weight();
+  }
+  simd_ops::add_many(get_counters(), arrays.data(), arrays.size(), get_num_counters());
+  _total_weight += total_weight;
+  write_total_weight();
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::check_merge_compatibility(const count_min_sketch& other_sketch) const {
   bool acceptable_config =
     (get_num_hashes() == other_sketch.get_num_hashes())   &&
     (get_num_buckets() == other_sketch.get_num_buckets()) &&
-    (get_seed() == other_sketch.get_seed());
+    (get_seed() == other_sketch.get_seed()) &&
+    (get_hash_type() == other_sketch.get_hash_type());
   if (!acceptable_config) { throw std::invalid_argument( "Incompatible sketch configuration." ); }
-
-  // Merge step - iterate over the other vector and add the weights to this sketch
-  auto it = _sketch_array.begin(); // This is a std::vector iterator.
-  auto other_it = other_sketch.begin(); //This is a const iterator over the other sketch.
-  while (it != _sketch_array.end()) {
-    *it += *other_it;
-    ++it;
-    ++other_it;
-  }
-  _total_weight += other_sketch.get_total_weight();
 }
 
 // Iterators
 template<typename W, typename A>
 typename count_min_sketch<W,A>::const_iterator count_min_sketch<W,A>::begin() const {
-  return _sketch_array.begin();
+  return get_counters();
 }
 
 template<typename W, typename A>
 typename count_min_sketch<W,A>::const_iterator count_min_sketch<W,A>::end() const {
-return _sketch_array.end();
+  return get_counters() + get_num_counters();
 }
 
 template<typename W, typename A>
@@ -267,7 +465,7 @@ void count_min_sketch<W,A>::serialize(std::ostream& os) const {
   const uint8_t preamble_longs = PREAMBLE_LONGS_SHORT;
   const uint8_t ser_ver = SERIAL_VERSION_1;
   const uint8_t family_id = FAMILY_ID;
-  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0);
+  const uint8_t flags_byte = get_flags_byte();
   const uint32_t unused32 = NULL_32;
   write(os, preamble_longs);
   write(os, ser_ver);
@@ -290,8 +488,8 @@ void count_min_sketch<W,A>::serialize(std::ostream& os) const {
   write(os, _total_weight);
 
   // Long 3 onwards: remaining bytes are consumed by writing the weight and the array values.
-  auto it = _sketch_array.begin();
-  while (it != _sketch_array.end()) {
+  auto it = begin();
+  while (it != end()) {
     write(os, *it);
     ++it;
   }
@@ -319,7 +517,8 @@ auto count_min_sketch<W,A>::deserialize(std::istream& is, uint64_t seed, const A
     throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
                                 + std::to_string(compute_seed_hash(seed)));
   }
-  count_min_sketch c(nhashes, nbuckets, seed, allocator);
+  count_min_sketch c(nhashes, nbuckets, hash_type_from_flags(flags_byte), update_type_from_flags(flags_byte),
+      seed, allocator);
   const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
   if (is_empty == 1) { return c; } // sketch is empty, no need to read further.
 
@@ -353,7 +552,7 @@ auto count_min_sketch<W,A>::serialize(unsigned header_size_bytes) const -> vecto
   ptr += copy_to_mem(ser_ver, ptr);
   const uint8_t family_id = FAMILY_ID;
   ptr += copy_to_mem(family_id, ptr);
-  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0);
+  const uint8_t flags_byte = get_flags_byte();
   ptr += copy_to_mem(flags_byte, ptr);
   const uint32_t unused32 = NULL_32;
   ptr += copy_to_mem(unused32, ptr);
@@ -374,8 +573,8 @@ auto count_min_sketch<W,A>::serialize(unsigned header_size_bytes) const -> vecto
   ptr += copy_to_mem(t_weight, ptr);
 
   // Long  3 onwards: remaining bytes are consumed by writing the weight and the array values.
-  auto it = _sketch_array.begin();
-  while (it != _sketch_array.end()) {
+  auto it = begin();
+  while (it != end()) {
     ptr += copy_to_mem(*it, ptr);
     ++it;
   }
@@ -415,7 +614,8 @@ auto count_min_sketch<W,A>::deserialize(const void* bytes, size_t size, uint64_t
     throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
                                 + std::to_string(compute_seed_hash(seed)));
   }
-  count_min_sketch c(nhashes, nbuckets, seed, allocator);
+  count_min_sketch c(nhashes, nbuckets, hash_type_from_flags(flags_byte), update_type_from_flags(flags_byte),
+      seed, allocator);
   const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
   if (is_empty) { return c; } // sketch is empty, no need to read further.
 
@@ -433,16 +633,129 @@ auto count_min_sketch<W,A>::deserialize(const void* bytes, size_t size, uint64_t
   return c;
 }
 
+template<typename W, typename A>
+auto count_min_sketch<W,A>::wrap(const void* bytes, size_t size, uint64_t seed, const A& allocator) -> const count_min_sketch {
+  // read-only flag means we won't modify the memory, but cast away the const
+  return internal_wrap(const_cast<void*>(bytes), size, seed, true, allocator);
+}
+
+template<typename W, typename A>
+auto count_min_sketch<W,A>::writable_wrap(void* bytes, size_t size, uint64_t seed, const A& allocator) -> count_min_sketch {
+  return internal_wrap(bytes, size, seed, false, allocator);
+}
+
+template<typename W, typename A>
+auto count_min_sketch<W,A>::internal_wrap(void* bytes, size_t size, uint64_t seed, bool read_only, const A& allocator) -> count_min_sketch {
+  ensure_minimum_memory(size, PREAMBLE_LONGS_SHORT * sizeof(uint64_t));
+  if (bytes == nullptr) {
+    throw std::invalid_argument("Input data is null");
+  }
+
+  uint8_t* memory = static_cast<uint8_t*>(bytes);
+  const uint8_t* ptr = memory;
+
+  // First 8 bytes are 4 bytes of preamble and 4 unused bytes.
+  uint8_t preamble_longs;
+  ptr += copy_from_mem(ptr, preamble_longs);
+  uint8_t serial_version;
+  ptr += copy_from_mem(ptr, serial_version);
+  uint8_t family_id;
+  ptr += copy_from_mem(ptr, family_id);
+  uint8_t flags_byte;
+  ptr += copy_from_mem(ptr, flags_byte);
+  ptr += sizeof(uint32_t);
+
+  check_header_validity(preamble_longs, serial_version, family_id, flags_byte);
+
+  // Second 8 bytes are the sketch parameters with a final, unused byte.
+  uint32_t nbuckets;
+  uint8_t nhashes;
+  uint16_t seed_hash;
+  ptr += copy_from_mem(ptr, nbuckets);
+  ptr += copy_from_mem(ptr, nhashes);
+  ptr += copy_from_mem(ptr, seed_hash);
+
+  if (seed_hash != compute_seed_hash(seed)) {
+    throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
+                                + std::to_string(compute_seed_hash(seed)));
+  }
+
+  const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
+  if (is_empty && !read_only) {
+    throw std::invalid_argument("Cannot wrap an empty sketch for writing");
+  }
+  if (is_empty) {
+    // an empty image has no counters, so allocate them
+    return count_min_sketch(nhashes, nbuckets, hash_type_from_flags(flags_byte), update_type_from_flags(flags_byte),
+        seed, nullptr, true, allocator);
+  }
+
+  ensure_minimum_memory(size, COUNTERS_OFFSET_BYTES + sizeof(W) * nbuckets * nhashes);
+  if (reinterpret_cast<uintptr_t>(memory + COUNTERS_OFFSET_BYTES) % alignof(W) != 0) {
+    throw std::invalid_argument("Wrapped memory is not aligned for the counter type");
+  }
+
+  count_min_sketch c(nhashes, nbuckets, hash_type_from_flags(flags_byte), update_type_from_flags(flags_byte),
+      seed, memory, read_only, allocator);
+  copy_from_mem(memory + TOTAL_WEIGHT_OFFSET_BYTES, c._total_weight);
+  return c;
+}
+
+template<typename W, typename A>
+bool count_min_sketch<W,A>::is_read_only() const {
+  return _is_read_only;
+}
+
+template<typename W, typename A>
+bool count_min_sketch<W,A>::is_wrapped() const {
+  return _memory != nullptr;
+}
+
+template<typename W, typename A>
+W* count_min_sketch<W,A>::get_counters() {
+  return _memory != nullptr ? reinterpret_cast<W*>(_memory + COUNTERS_OFFSET_BYTES) : _sketch_array.data();
+}
+
+template<typename W, typename A>
+const W* count_min_sketch<W,A>::get_counters() const {
+  return _memory != nullptr ? reinterpret_cast<const W*>(_memory + COUNTERS_OFFSET_BYTES) : _sketch_array.data();
+}
+
+template<typename W, typename A>
+size_t count_min_sketch<W,A>::get_num_counters() const {
+  return static_cast<size_t>(_num_hashes) * _num_buckets;
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::check_writable() const {
+  if (_is_read_only) {
+    throw std::logic_error("Cannot update a read-only sketch");
+  }
+}
+
+template<typename W, typename A>
+void count_min_sketch<W,A>::write_total_weight() {
+  // keeps a writable wrapped image consistent with the counters
+  if (_memory != nullptr) {
+    copy_to_mem(_total_weight, _memory + TOTAL_WEIGHT_OFFSET_BYTES);
+  }
+}
+
 template<typename W, typename A>
 bool count_min_sketch<W,A>::is_empty() const {
   return _total_weight == 0;
 }
 
+template<typename W, typename A>
+A count_min_sketch<W,A>::get_allocator() const {
+  return _allocator;
+}
+
 template<typename W, typename A>
 string<A> count_min_sketch<W,A>::to_string() const {
   // count the number of used entries in the sketch
   uint64_t num_nonzero = 0;
-  for (const auto entry: _sketch_array) {
+  for (const auto entry: *this) {
     if (entry != static_cast<W>(0.0)) { ++num_nonzero; }
   }
 
@@ -452,9 +765,12 @@ string<A> count_min_sketch<W,A>::to_string() const {
   os << "### Count Min sketch summary:" << std::endl;
   os << "   num hashes     : " << static_cast<uint32_t>(_num_hashes) << std::endl;
   os << "   num buckets    : " << _num_buckets << std::endl;
-  os << "   capacity bins  : " << _sketch_array.size() << std::endl;
+  os << "   hash type      : " << (_hash_type == count_min_hash_type::DOUBLE_HASHING ? "double" : "per row") << std::endl;
+  os << "   update type    : " << (_update_type == count_min_update_type::CONSERVATIVE_UPDATE ? "conservative" : "standard") << std::endl;
+  os << "   capacity bins  : " << get_num_counters() << std::endl;
+  os << "   wrapped        : " << (is_wrapped() ? (is_read_only() ? "read-only" : "writable") : "no") << std::endl;
   os << "   filled bins    : " << num_nonzero << std::endl;
-  os << "   pct filled     : " << std::setprecision(3) << (num_nonzero * 100.0) / _sketch_array.size() << "%" << std::endl;
+  os << "   pct filled     : " << std::setprecision(3) << (num_nonzero * 100.0) / get_num_counters() << "%" << std::endl;
   os << "### End sketch summary" << std::endl;
 
   return string<A>(os.str().c_str(), _allocator);
@@ -467,6 +783,13 @@ void count_min_sketch<W,A>::check_header_validity(uint8_t preamble_longs, uint8_
   const uint8_t sw = (empty ? 1 : 0) + (2 * serial_version) + (4 * family_id) + (32 * (preamble_longs & 0x3F));
   bool valid = true;
 
+  if (flags_byte & (1 << flags::IS_BLOCKED)) {
+    throw std::invalid_argument("Blocked count min sketch image, use blocked_count_min_sketch to deserialize");
+  }
+  if (flags_byte & (1 << flags::IS_SATURATING)) {
+    throw std::invalid_argument("Saturating count min sketch image, use saturating_count_min_sketch to deserialize");
+  }
+
   switch (sw) { // exhaustive list and description of all valid cases
     case 138 : break; // !empty, ser_ver==1, family==18, preLongs=2;
     case 139 : break; // empty, ser_ver==1, family==18, preLongs=2;
@@ -485,6 +808,23 @@ void count_min_sketch<W,A>::check_header_validity(uint8_t preamble_longs, uint8_
   }
 }
 
+template<typename W, typename A>
+count_min_hash_type count_min_sketch<W,A>::hash_type_from_flags(uint8_t flags_byte) {
+  return (flags_byte & (1 << flags::IS_DOUBLE_HASHED)) ? count_min_hash_type::DOUBLE_HASHING : count_min_hash_type::PER_ROW_HASHING;
+}
+
+template<typename W, typename A>
+count_min_update_type count_min_sketch<W,A>::update_type_from_flags(uint8_t flags_byte) {
+  return (flags_byte & (1 << flags::IS_CONSERVATIVE)) ? count_min_update_type::CONSERVATIVE_UPDATE : count_min_update_type::STANDARD_UPDATE;
+}
+
+template<typename W, typename A>
+uint8_t count_min_sketch<W,A>::get_flags_byte() const {
+  return (is_empty() ? 1 << flags::IS_EMPTY : 0)
+    | (_hash_type == count_min_hash_type::DOUBLE_HASHING ? 1 << flags::IS_DOUBLE_HASHED : 0)
+    | (_update_type == count_min_update_type::CONSERVATIVE_UPDATE ? 1 << flags::IS_CONSERVATIVE : 0);
+}
+
 } /* namespace datasketches */
 
 #endif
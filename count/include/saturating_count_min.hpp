@@ -0,0 +1,358 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SATURATING_COUNT_MIN_HPP_
+#define SATURATING_COUNT_MIN_HPP_
+
+#include <limits>
+#include <vector>
+#include "common_defs.hpp"
+
+namespace datasketches {
+
+/**
+ * CountMin sketch with narrow saturating counters.
+ *
+ * count_min_sketch uses the weight type for its counters, so count_min_sketch<uint64_t> spends
+ * 8 bytes per counter even though most counters hold small values.
+ * This variant stores its counters in a narrow unsigned integral type C, typically uint8_t or uint16_t,
+ * while the total weight is kept in 64 bits.
+ * A counter that would overflow sticks at the largest value of C instead of wrapping around.
+ *
+ * Estimates are capped at get_max_counter(). A capped estimate only tells that the true frequency is
+ * at least that large, so get_upper_bound() returns the largest uint64_t for such items.
+ * For items below the cap the guarantees of count_min_sketch hold unchanged.
+ *
+ * Weights are unsigned. Row locations are computed with double hashing
+ * (see count_min_hash_type::DOUBLE_HASHING), so for the same parameters and seed an item
+ * maps to the same counters as in count_min_sketch with double hashing.
+ *
+ * The template type C is the type of the counters, not the type of the items.
+ */
+template <typename C,
+          typename Allocator = std::allocator<C>>
+class saturating_count_min_sketch {
+  static_assert(std::is_integral<C>::value && std::is_unsigned<C>::value, "Unsigned integral type expected");
+  static_assert(sizeof(C) <= sizeof(uint32_t), "Counter type must be narrower than 64 bits");
+public:
+  using allocator_type = Allocator;
+  using const_iterator = typename std::vector<C, Allocator>::const_iterator;
+
+  /**
+   * Creates an instance of the sketch
+   * @param num_hashes number of hash functions in the sketch. Equivalently the number of rows in the array
+   * @param num_buckets number of buckets that hash functions map into. Equivalently the number of columns in the array
+   * @param seed for hash function
+   * @param allocator to acquire and release memory
+   */
+  saturating_count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * @return configured number of hashes of this sketch
+   */
+  uint8_t get_num_hashes() const;
+
+  /**
+   * @return configured number of buckets of this sketch
+   */
+  uint32_t get_num_buckets() const;
+
+  /**
+   * @return configured seed of this sketch
+   */
+  uint64_t get_seed() const;
+
+  /**
+   * @return epsilon, the maximum permissible error relative to the total weight for unsaturated estimates.
+   * epsilon = e / _num_buckets
+   */
+  double get_relative_error() const;
+
+  /**
+   * @return the total weight currently inserted into the stream.
+   */
+  uint64_t get_total_weight() const;
+
+  /**
+   * @return the value at which counters saturate
+   */
+  static constexpr C get_max_counter() { return std::numeric_limits<C>::max(); }
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return an estimate of the item's frequency, capped at get_max_counter()
+   */
+  uint64_t get_estimate(uint64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item.
+   * @param item to query
+   * @return an estimate of the item's frequency, capped at get_max_counter()
+   */
+  uint64_t get_estimate(int64_t item) const;
+
+  /**
+   * Query the sketch for the estimate of a given string.
+   * @param item to query
+   * @return an estimate of the item's frequency, capped at get_max_counter()
+   */
+  uint64_t get_estimate(const std::string& item) const;
+
+  /**
+   * Query the sketch for the estimate of a given item of any type.
+   * @param item pointer to the data item to be queried
+   * @param size of the item in bytes
+   * @return an estimate of the item's frequency, capped at get_max_counter()
+   */
+  uint64_t get_estimate(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the upper bound on the true frequency of the item,
+   * or the largest uint64_t if the estimate is saturated
+   */
+  uint64_t get_upper_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item,
+   * or the largest uint64_t if the estimate is saturated
+   */
+  uint64_t get_upper_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given item.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item,
+   * or the largest uint64_t if the estimate is saturated
+   */
+  uint64_t get_upper_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the upper bound of a given string.
+   * @param item to query
+   * @return the upper bound on the true frequency of the item,
+   * or the largest uint64_t if the estimate is saturated
+   */
+  uint64_t get_upper_bound(const std::string& item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @param size of the item in bytes
+   * @return the lower bound on the true frequency of the item
+   */
+  uint64_t get_lower_bound(const void* item, size_t size) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  uint64_t get_lower_bound(int64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given item.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  uint64_t get_lower_bound(uint64_t item) const;
+
+  /**
+   * Query the sketch for the lower bound of a given string.
+   * @param item to query
+   * @return the lower bound on the true frequency of the item
+   */
+  uint64_t get_lower_bound(const std::string& item) const;
+
+  /**
+   * Update this sketch with given data of any type.
+   * @param item pointer to the data item to be inserted into the sketch.
+   * @param size of the data in bytes
+   * @param weight of the item
+   */
+  void update(const void* item, size_t size, uint64_t weight);
+
+  /**
+   * Update this sketch with a given item.
+   * @param item to update the sketch with
+   * @param weight of the item
+   */
+  void update(uint64_t item, uint64_t weight = 1);
+
+  /**
+   * Update this sketch with a given item.
+   * @param item to update the sketch with
+   * @param weight of the item
+   */
+  void update(int64_t item, uint64_t weight = 1);
+
+  /**
+   * Update this sketch with a given string.
+   * @param item string to update the sketch with
+   * @param weight of the item
+   */
+  void update(const std::string& item, uint64_t weight = 1);
+
+  /**
+   * Merges another saturating_count_min_sketch into this one.
+   * Counters are added with saturation.
+   * @param other sketch with the same configuration
+   */
+  void merge(const saturating_count_min_sketch& other);
+
+  /**
+   * Returns true if this sketch is empty.
+   * @return empty flag
+   */
+  bool is_empty() const;
+
+  /**
+   * @return the number of counters that reached get_max_counter()
+   */
+  uint64_t get_num_saturated() const;
+
+  /**
+   * @brief Returns a string describing the sketch
+   * @return A string with a human-readable description of the sketch
+   */
+  string<Allocator> to_string() const;
+
+  /**
+   * Iterator pointing to the first counter in the sketch.
+   * @return iterator pointing to the first counter in the sketch
+   */
+  const_iterator begin() const;
+
+  /**
+   * Iterator pointing to the past-the-end counter in the sketch.
+   * @return iterator pointing to the past-the-end counter in the sketch
+   */
+  const_iterator end() const;
+
+  /*
+   * The serialized sketch binary form has the same header as count_min_sketch,
+   * with the double hashing and saturating flags set and the size of a counter in bytes
+   * in the last byte of long 1. The total weight is always 8 bytes, and the counters
+   * take sizeof(C) bytes each.
+
+  0   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||preLongs|ser__ver|familyId| flags  |xxxxxxxx|xxxxxxxx|xxxxxxxx|xxxxxxxx|
+
+  1   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||---------- _num_buckets -----------|num_hash|__seed__ __hash__|ctr_size|
+
+  2   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||---------------------------- total  weight ----------------------------|
+
+  3   ||    0   |    1   |    2   |    3   |    4   |    5   |    6   |    7   |
+      ||---------------------------- sketch entries ---------------------------|
+ ...
+
+   */
+
+  /**
+   * Computes size needed to serialize the current state of the sketch.
+   * @return size in bytes needed to serialize this sketch
+   */
+  size_t get_serialized_size_bytes() const;
+
+  /**
+   * This method serializes the sketch into a given stream in a binary form
+   * @param os output stream
+   */
+  void serialize(std::ostream& os) const;
+
+  // This is a convenience alias for users
+  // The type returned by the following serialize method
+  using vector_bytes = std::vector<uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>>;
+
+  /**
+   * This method serializes the sketch as a vector of bytes.
+   * An optional header can be reserved in front of the sketch.
+   * @param header_size_bytes space to reserve in front of the sketch
+   */
+  vector_bytes serialize(unsigned header_size_bytes = 0) const;
+
+  /**
+   * This method deserializes a sketch from a given stream.
+   * @param is input stream
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of a sketch
+   */
+  static saturating_count_min_sketch deserialize(std::istream& is, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * This method deserializes a sketch from a given array of bytes.
+   * @param bytes pointer to the array of bytes
+   * @param size the size of the array
+   * @param seed the seed for the hash function that was used to create the sketch
+   * @param allocator instance of an Allocator
+   * @return an instance of the sketch
+   */
+  static saturating_count_min_sketch deserialize(const void* bytes, size_t size, uint64_t seed = DEFAULT_SEED,
+      const Allocator& allocator = Allocator());
+
+  /**
+   * @return allocator
+   */
+  allocator_type get_allocator() const;
+
+private:
+  Allocator _allocator;
+  uint8_t _num_hashes;
+  uint32_t _num_buckets;
+  uint32_t _bucket_mask; // _num_buckets - 1 if _num_buckets is a power of 2, zero otherwise
+  uint64_t _seed;
+  uint64_t _total_weight;
+  std::vector<C, Allocator> _sketch_array;
+
+  enum flags {IS_EMPTY, IS_DOUBLE_HASHED, IS_BLOCKED, IS_CONSERVATIVE, IS_SATURATING};
+  static const uint8_t PREAMBLE_LONGS = 2;
+  static const uint8_t SERIAL_VERSION_1 = 1;
+  static const uint8_t FAMILY_ID = 18;
+  static const uint32_t NULL_32 = 0;
+
+  static void check_header_validity(uint8_t preamble_longs, uint8_t serial_version, uint8_t family_id,
+      uint8_t flags_byte, uint8_t counter_size);
+
+  static C saturating_add(C counter, uint64_t weight);
+
+  /*
+   * Compute the hash locations for an input item
+   * @param item pointer to the data item to be inserted into or queried from the sketch.
+   * @param size of the data in bytes
+   * @param callback function to invoke for each sketch array location
+   */
+  template<typename F>
+  void foreach_hash_location(const void* item, size_t size, F callback) const;
+};
+
+} /* namespace datasketches */
+
+#include "saturating_count_min_impl.hpp"
+
+#endif
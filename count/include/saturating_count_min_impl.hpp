@@ -0,0 +1,414 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SATURATING_COUNT_MIN_IMPL_HPP_
+#define SATURATING_COUNT_MIN_IMPL_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "MurmurHash3.h"
+#include "saturating_count_min.hpp"
+#include "memory_operations.hpp"
+
+namespace datasketches {
+
+template<typename C, typename A>
+saturating_count_min_sketch<C,A>::saturating_count_min_sketch(uint8_t num_hashes, uint32_t num_buckets, uint64_t seed,
+    const A& allocator):
+_allocator(allocator),
+_num_hashes(num_hashes),
+_num_buckets(num_buckets),
+_bucket_mask((num_buckets & (num_buckets - 1)) == 0 ? num_buckets - 1 : 0),
+_seed(seed),
+_total_weight(0),
+_sketch_array(allocator) {
+  if (num_hashes < 1) {
+    throw std::invalid_argument("Must have at least 1 hash function");
+  }
+  if (num_buckets < 3) {
+    throw std::invalid_argument("Using fewer than 3 buckets incurs relative error greater than 1.");
+  }
+  // Same limit on the number of counters as count_min_sketch
+  if (static_cast<uint64_t>(num_buckets) * num_hashes >= 1 << 30) {
+    throw std::invalid_argument("These parameters generate a sketch that exceeds 2^30 elements."
+                                "Try reducing either the number of buckets or the number of hash functions.");
+  }
+  _sketch_array.resize(static_cast<size_t>(num_buckets) * num_hashes, 0);
+}
+
+template<typename C, typename A>
+uint8_t saturating_count_min_sketch<C,A>::get_num_hashes() const {
+  return _num_hashes;
+}
+
+template<typename C, typename A>
+uint32_t saturating_count_min_sketch<C,A>::get_num_buckets() const {
+  return _num_buckets;
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_seed() const {
+  return _seed;
+}
+
+template<typename C, typename A>
+double saturating_count_min_sketch<C,A>::get_relative_error() const {
+  return exp(1.0) / static_cast<double>(_num_buckets);
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_total_weight() const {
+  return _total_weight;
+}
+
+template<typename C, typename A>
+C saturating_count_min_sketch<C,A>::saturating_add(C counter, uint64_t weight) {
+  return weight >= static_cast<uint64_t>(get_max_counter() - counter) ? get_max_counter() : static_cast<C>(counter + weight);
+}
+
+template<typename C, typename A>
+template<typename F>
+void saturating_count_min_sketch<C,A>::foreach_hash_location(const void* item, size_t size, F callback) const {
+  // Same locations as count_min_sketch with count_min_hash_type::DOUBLE_HASHING
+  HashState hashes;
+  MurmurHash3_x64_128(item, size, _seed, hashes);
+  const uint64_t h2 = hashes.h2 | 1;
+  uint64_t hash = hashes.h1;
+  uint64_t row_offset = 0;
+  for (uint8_t i = 0; i < _num_hashes; ++i) {
+    callback(row_offset + (_bucket_mask != 0 ? hash & _bucket_mask : hash % _num_buckets));
+    hash += h2;
+    row_offset += _num_buckets;
+  }
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_estimate(uint64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_estimate(int64_t item) const {return get_estimate(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_estimate(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_estimate(item.c_str(), item.length());
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_estimate(const void* item, size_t size) const {
+  C estimate = get_max_counter();
+  foreach_hash_location(item, size, [this, &estimate](uint64_t h) {
+    estimate = std::min(estimate, _sketch_array[h]);
+  });
+  return estimate;
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::update(uint64_t item, uint64_t weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::update(int64_t item, uint64_t weight) {
+  update(&item, sizeof(item), weight);
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::update(const std::string& item, uint64_t weight) {
+  if (item.empty()) { return; }
+  update(item.c_str(), item.length(), weight);
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::update(const void* item, size_t size, uint64_t weight) {
+  _total_weight += weight;
+  foreach_hash_location(item, size, [this, weight](uint64_t h) {
+    _sketch_array[h] = saturating_add(_sketch_array[h], weight);
+  });
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_upper_bound(uint64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_upper_bound(int64_t item) const {return get_upper_bound(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_upper_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_upper_bound(item.c_str(), item.length());
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_upper_bound(const void* item, size_t size) const {
+  const uint64_t estimate = get_estimate(item, size);
+  if (estimate == get_max_counter()) return std::numeric_limits<uint64_t>::max();
+  return static_cast<uint64_t>(estimate + get_relative_error() * get_total_weight());
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_lower_bound(uint64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_lower_bound(int64_t item) const {return get_lower_bound(&item, sizeof(item));}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_lower_bound(const std::string& item) const {
+  if (item.empty()) { return 0; } // Empty strings are not inserted into the sketch.
+  return get_lower_bound(item.c_str(), item.length());
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_lower_bound(const void* item, size_t size) const {
+  return get_estimate(item, size);
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::merge(const saturating_count_min_sketch& other) {
+  if (this == &other) { throw std::invalid_argument("Cannot merge a sketch with itself."); }
+
+  const bool acceptable_config =
+    (get_num_hashes() == other.get_num_hashes()) &&
+    (get_num_buckets() == other.get_num_buckets()) &&
+    (get_seed() == other.get_seed());
+  if (!acceptable_config) { throw std::invalid_argument("Incompatible sketch configuration."); }
+
+  for (size_t i = 0; i < _sketch_array.size(); ++i) {
+    _sketch_array[i] = saturating_add(_sketch_array[i], other._sketch_array[i]);
+  }
+  _total_weight += other.get_total_weight();
+}
+
+template<typename C, typename A>
+bool saturating_count_min_sketch<C,A>::is_empty() const {
+  return _total_weight == 0;
+}
+
+template<typename C, typename A>
+uint64_t saturating_count_min_sketch<C,A>::get_num_saturated() const {
+  return std::count(_sketch_array.begin(), _sketch_array.end(), get_max_counter());
+}
+
+template<typename C, typename A>
+auto saturating_count_min_sketch<C,A>::begin() const -> const_iterator {
+  return _sketch_array.begin();
+}
+
+template<typename C, typename A>
+auto saturating_count_min_sketch<C,A>::end() const -> const_iterator {
+  return _sketch_array.end();
+}
+
+template<typename C, typename A>
+size_t saturating_count_min_sketch<C,A>::get_serialized_size_bytes() const {
+  return PREAMBLE_LONGS * sizeof(uint64_t)
+      + (is_empty() ? 0 : sizeof(_total_weight) + sizeof(C) * _sketch_array.size());
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::serialize(std::ostream& os) const {
+  // Long 0
+  const uint8_t preamble_longs = PREAMBLE_LONGS;
+  write(os, preamble_longs);
+  const uint8_t ser_ver = SERIAL_VERSION_1;
+  write(os, ser_ver);
+  const uint8_t family_id = FAMILY_ID;
+  write(os, family_id);
+  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0)
+    | (1 << flags::IS_DOUBLE_HASHED) | (1 << flags::IS_SATURATING);
+  write(os, flags_byte);
+  const uint32_t unused32 = NULL_32;
+  write(os, unused32);
+
+  // Long 1
+  write(os, _num_buckets);
+  write(os, _num_hashes);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  write(os, seed_hash);
+  const uint8_t counter_size = sizeof(C);
+  write(os, counter_size);
+  if (is_empty()) { return; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  write(os, _total_weight);
+
+  // Long 3 onwards
+  write(os, _sketch_array.data(), sizeof(C) * _sketch_array.size());
+}
+
+template<typename C, typename A>
+auto saturating_count_min_sketch<C,A>::serialize(unsigned header_size_bytes) const -> vector_bytes {
+  vector_bytes bytes(header_size_bytes + get_serialized_size_bytes(), 0, _allocator);
+  uint8_t* ptr = bytes.data() + header_size_bytes;
+
+  // Long 0
+  const uint8_t preamble_longs = PREAMBLE_LONGS;
+  ptr += copy_to_mem(preamble_longs, ptr);
+  const uint8_t ser_ver = SERIAL_VERSION_1;
+  ptr += copy_to_mem(ser_ver, ptr);
+  const uint8_t family_id = FAMILY_ID;
+  ptr += copy_to_mem(family_id, ptr);
+  const uint8_t flags_byte = (is_empty() ? 1 << flags::IS_EMPTY : 0)
+    | (1 << flags::IS_DOUBLE_HASHED) | (1 << flags::IS_SATURATING);
+  ptr += copy_to_mem(flags_byte, ptr);
+  const uint32_t unused32 = NULL_32;
+  ptr += copy_to_mem(unused32, ptr);
+
+  // Long 1
+  ptr += copy_to_mem(_num_buckets, ptr);
+  ptr += copy_to_mem(_num_hashes, ptr);
+  const uint16_t seed_hash = compute_seed_hash(_seed);
+  ptr += copy_to_mem(seed_hash, ptr);
+  const uint8_t counter_size = sizeof(C);
+  ptr += copy_to_mem(counter_size, ptr);
+  if (is_empty()) { return bytes; } // sketch is empty, no need to write further bytes.
+
+  // Long 2
+  ptr += copy_to_mem(_total_weight, ptr);
+
+  // Long 3 onwards
+  copy_to_mem(_sketch_array.data(), ptr, sizeof(C) * _sketch_array.size());
+  return bytes;
+}
+
+template<typename C, typename A>
+auto saturating_count_min_sketch<C,A>::deserialize(std::istream& is, uint64_t seed, const A& allocator) -> saturating_count_min_sketch {
+  const auto preamble_longs = read<uint8_t>(is);
+  const auto serial_version = read<uint8_t>(is);
+  const auto family_id = read<uint8_t>(is);
+  const auto flags_byte = read<uint8_t>(is);
+  read<uint32_t>(is); // 4 unused bytes
+
+  const auto nbuckets = read<uint32_t>(is);
+  const auto nhashes = read<uint8_t>(is);
+  const auto seed_hash = read<uint16_t>(is);
+  const auto counter_size = read<uint8_t>(is);
+
+  check_header_validity(preamble_longs, serial_version, family_id, flags_byte, counter_size);
+  if (seed_hash != compute_seed_hash(seed)) {
+    throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
+                                + std::to_string(compute_seed_hash(seed)));
+  }
+  saturating_count_min_sketch c(nhashes, nbuckets, seed, allocator);
+  const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
+  if (is_empty) { return c; } // sketch is empty, no need to read further.
+
+  c._total_weight = read<uint64_t>(is);
+  read(is, c._sketch_array.data(), sizeof(C) * c._sketch_array.size());
+  if (!is.good()) throw std::runtime_error("error reading from std::istream");
+  return c;
+}
+
+template<typename C, typename A>
+auto saturating_count_min_sketch<C,A>::deserialize(const void* bytes, size_t size, uint64_t seed, const A& allocator) -> saturating_count_min_sketch {
+  ensure_minimum_memory(size, PREAMBLE_LONGS * sizeof(uint64_t));
+
+  const char* ptr = static_cast<const char*>(bytes);
+  uint8_t preamble_longs;
+  ptr += copy_from_mem(ptr, preamble_longs);
+  uint8_t serial_version;
+  ptr += copy_from_mem(ptr, serial_version);
+  uint8_t family_id;
+  ptr += copy_from_mem(ptr, family_id);
+  uint8_t flags_byte;
+  ptr += copy_from_mem(ptr, flags_byte);
+  ptr += sizeof(uint32_t);
+
+  uint32_t nbuckets;
+  ptr += copy_from_mem(ptr, nbuckets);
+  uint8_t nhashes;
+  ptr += copy_from_mem(ptr, nhashes);
+  uint16_t seed_hash;
+  ptr += copy_from_mem(ptr, seed_hash);
+  uint8_t counter_size;
+  ptr += copy_from_mem(ptr, counter_size);
+
+  check_header_validity(preamble_longs, serial_version, family_id, flags_byte, counter_size);
+  if (seed_hash != compute_seed_hash(seed)) {
+    throw std::invalid_argument("Incompatible seed hashes: " + std::to_string(seed_hash) + ", "
+                                + std::to_string(compute_seed_hash(seed)));
+  }
+  saturating_count_min_sketch c(nhashes, nbuckets, seed, allocator);
+  const bool is_empty = (flags_byte & (1 << flags::IS_EMPTY)) > 0;
+  if (is_empty) { return c; } // sketch is empty, no need to read further.
+
+  ensure_minimum_memory(size, PREAMBLE_LONGS * sizeof(uint64_t) + sizeof(uint64_t) + sizeof(C) * c._sketch_array.size());
+  ptr += copy_from_mem(ptr, c._total_weight);
+  copy_from_mem(ptr, c._sketch_array.data(), sizeof(C) * c._sketch_array.size());
+  return c;
+}
+
+template<typename C, typename A>
+string<A> saturating_count_min_sketch<C,A>::to_string() const {
+  uint64_t num_nonzero = 0;
+  for (const auto entry: _sketch_array) {
+    if (entry != 0) { ++num_nonzero; }
+  }
+
+  // Using a temporary stream for implementation here does not comply with AllocatorAwareContainer requirements.
+  // The stream does not support passing an allocator instance, and alternatives are complicated.
+  std::ostringstream os;
+  os << "### Saturating Count Min sketch summary:" << std::endl;
+  os << "   num hashes     : " << static_cast<uint32_t>(_num_hashes) << std::endl;
+  os << "   num buckets    : " << _num_buckets << std::endl;
+  os << "   counter bits   : " << sizeof(C) * 8 << std::endl;
+  os << "   capacity bins  : " << _sketch_array.size() << std::endl;
+  os << "   filled bins    : " << num_nonzero << std::endl;
+  os << "   saturated bins : " << get_num_saturated() << std::endl;
+  os << "   pct filled     : " << std::setprecision(3) << (num_nonzero * 100.0) / _sketch_array.size() << "%" << std::endl;
+  os << "### End sketch summary" << std::endl;
+
+  return string<A>(os.str().c_str(), _allocator);
+}
+
+template<typename C, typename A>
+A saturating_count_min_sketch<C,A>::get_allocator() const {
+  return _allocator;
+}
+
+template<typename C, typename A>
+void saturating_count_min_sketch<C,A>::check_header_validity(uint8_t preamble_longs, uint8_t serial_version,
+    uint8_t family_id, uint8_t flags_byte, uint8_t counter_size) {
+  if (family_id != FAMILY_ID) {
+    throw std::invalid_argument("Family ID mismatch: expected " + std::to_string(FAMILY_ID)
+        + ", actual " + std::to_string(family_id));
+  }
+  if (serial_version != SERIAL_VERSION_1) {
+    throw std::invalid_argument("Serial version mismatch: expected " + std::to_string(SERIAL_VERSION_1)
+        + ", actual " + std::to_string(serial_version));
+  }
+  if (preamble_longs != PREAMBLE_LONGS) {
+    throw std::invalid_argument("Possible sketch corruption. Inconsistent state: preamble_longs = "
+        + std::to_string(preamble_longs));
+  }
+  if (!(flags_byte & (1 << flags::IS_SATURATING))) {
+    throw std::invalid_argument("Not a saturating count min sketch");
+  }
+  if (counter_size != sizeof(C)) {
+    throw std::invalid_argument("Counter size mismatch: expected " + std::to_string(sizeof(C))
+        + ", actual " + std::to_string(counter_size));
+  }
+}
+
+} /* namespace datasketches */
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <sstream>
+
+#include "blocked_count_min.hpp"
+#include "count_min.hpp"
+
+namespace datasketches {
+
+TEST_CASE("blocked CM init - throws", "[blocked_cm]") {
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>(0, 16), std::invalid_argument);
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>(9, 16), std::invalid_argument);
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>(4, 0), std::invalid_argument);
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>(4, 1 << 27), std::invalid_argument);
+  REQUIRE(blocked_count_min_sketch<uint64_t>::get_max_num_hashes() == 8);
+  REQUIRE(blocked_count_min_sketch<uint32_t>::get_max_num_hashes() == 16);
+  REQUIRE(blocked_count_min_sketch<uint8_t>::get_max_num_hashes() == 10);
+}
+
+TEST_CASE("blocked CM init", "[blocked_cm]") {
+  blocked_count_min_sketch<uint64_t> c(4, 100, 1234567);
+  REQUIRE(c.get_num_hashes() == 4);
+  REQUIRE(c.get_num_blocks() == 100);
+  REQUIRE(c.get_seed() == 1234567);
+  REQUIRE(c.is_empty());
+  REQUIRE(c.end() - c.begin() == 800);
+  REQUIRE(reinterpret_cast<uintptr_t>(c.begin()) % 64 == 0);
+  for (auto x: c) REQUIRE(x == 0);
+}
+
+TEST_CASE("blocked CM parameter suggestions", "[blocked_cm]") {
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>::suggest_num_blocks(0, 2), std::invalid_argument);
+  const uint32_t num_blocks = blocked_count_min_sketch<uint64_t>::suggest_num_blocks(0.01, 2);
+  REQUIRE(num_blocks == 68);
+  REQUIRE(blocked_count_min_sketch<uint64_t>(2, num_blocks).get_relative_error() <= 0.01);
+}
+
+TEST_CASE("blocked CM estimates", "[blocked_cm]") {
+  blocked_count_min_sketch<uint64_t> c(3, 64);
+  c.update("x");
+  c.update("x", 9);
+  REQUIRE(c.get_estimate("x") >= 10);
+  REQUIRE(c.get_estimate("") == 0);
+
+  const uint64_t n = 1000;
+  for (uint64_t i = 0; i < n; ++i) c.update(i, i % 10 + 1);
+  REQUIRE(c.get_total_weight() == 10 + 5500);
+  uint64_t num_within_bound = 0;
+  for (uint64_t i = 0; i < n; ++i) {
+    REQUIRE(c.get_estimate(i) >= i % 10 + 1);
+    REQUIRE(c.get_lower_bound(i) == c.get_estimate(i));
+    if (c.get_estimate(i) <= i % 10 + 1 + c.get_relative_error() * c.get_total_weight()) ++num_within_bound;
+  }
+  // the bound holds with probability at least 1 - 1/e per item
+  REQUIRE(num_within_bound >= n / 2);
+}
+
+TEST_CASE("blocked CM merge", "[blocked_cm]") {
+  blocked_count_min_sketch<uint64_t> s(2, 32);
+  REQUIRE_THROWS_WITH(s.merge(s), "Cannot merge a sketch with itself.");
+  REQUIRE_THROWS_WITH(s.merge(blocked_count_min_sketch<uint64_t>(3, 32)), "Incompatible sketch configuration.");
+  REQUIRE_THROWS_WITH(s.merge(blocked_count_min_sketch<uint64_t>(2, 33)), "Incompatible sketch configuration.");
+  REQUIRE_THROWS_WITH(s.merge(blocked_count_min_sketch<uint64_t>(2, 32, 1)), "Incompatible sketch configuration.");
+
+  blocked_count_min_sketch<uint64_t> t(2, 32);
+  for (uint64_t i = 0; i < 4; ++i) {
+    s.update(i);
+    t.update(i);
+  }
+  s.merge(t);
+  REQUIRE(s.get_total_weight() == 8);
+  for (uint64_t i = 0; i < 4; ++i) REQUIRE(s.get_estimate(i) >= 2);
+}
+
+TEST_CASE("blocked CM serialize-deserialize", "[blocked_cm]") {
+  blocked_count_min_sketch<uint32_t> empty(4, 10);
+  auto empty_bytes = empty.serialize();
+  REQUIRE(empty_bytes.size() == empty.get_serialized_size_bytes());
+  auto empty_copy = blocked_count_min_sketch<uint32_t>::deserialize(empty_bytes.data(), empty_bytes.size());
+  REQUIRE(empty_copy.is_empty());
+  REQUIRE(empty_copy.get_num_hashes() == 4);
+  REQUIRE(empty_copy.get_num_blocks() == 10);
+
+  blocked_count_min_sketch<uint32_t> c(4, 10);
+  for (uint32_t i = 0; i < 100; ++i) c.update(static_cast<uint64_t>(i), i);
+  auto bytes = c.serialize();
+  REQUIRE(bytes.size() == c.get_serialized_size_bytes());
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint32_t>::deserialize(bytes.data(), bytes.size(), DEFAULT_SEED - 1), std::invalid_argument);
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint32_t>::deserialize(bytes.data(), bytes.size() - 1), std::out_of_range);
+  // different counter type
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size()), std::invalid_argument);
+  // not a regular count min sketch
+  REQUIRE_THROWS_AS(count_min_sketch<uint32_t>::deserialize(bytes.data(), bytes.size()), std::invalid_argument);
+  REQUIRE_THROWS_AS(blocked_count_min_sketch<uint32_t>::deserialize(count_min_sketch<uint32_t>(4, 10).serialize().data(), 16), std::invalid_argument);
+
+  auto d = blocked_count_min_sketch<uint32_t>::deserialize(bytes.data(), bytes.size());
+  std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+  c.serialize(s);
+  auto e = blocked_count_min_sketch<uint32_t>::deserialize(s);
+  REQUIRE(d.get_total_weight() == c.get_total_weight());
+  REQUIRE(e.get_total_weight() == c.get_total_weight());
+  REQUIRE(std::equal(c.begin(), c.end(), d.begin()));
+  REQUIRE(std::equal(c.begin(), c.end(), e.begin()));
+  for (uint32_t i = 0; i < 100; ++i) REQUIRE(d.get_estimate(static_cast<uint64_t>(i)) == c.get_estimate(static_cast<uint64_t>(i)));
+}
+
+TEST_CASE("blocked CM copy keeps alignment", "[blocked_cm]") {
+  blocked_count_min_sketch<uint16_t> c(4, 10);
+  for (uint64_t i = 0; i < 100; ++i) c.update(i);
+  auto d = c;
+  REQUIRE(reinterpret_cast<uintptr_t>(d.begin()) % 64 == 0);
+  REQUIRE(std::equal(c.begin(), c.end(), d.begin()));
+  for (uint64_t i = 0; i < 100; ++i) REQUIRE(d.get_estimate(i) == c.get_estimate(i));
+}
+
+} /* namespace datasketches */
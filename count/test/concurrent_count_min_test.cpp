@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "concurrent_count_min.hpp"
+
+namespace datasketches {
+
+TEST_CASE("concurrent CM init - throws", "[concurrent_cm]") {
+  REQUIRE_THROWS_AS(concurrent_count_min_sketch<uint64_t>(0, 16), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_count_min_sketch<uint64_t>(4, 2), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_count_min_sketch<uint64_t>(4, 1 << 28), std::invalid_argument);
+}
+
+TEST_CASE("concurrent CM matches count_min_sketch", "[concurrent_cm]") {
+  concurrent_count_min_sketch<int64_t> c(4, 37, 1234);
+  count_min_sketch<int64_t> s(4, 37, count_min_hash_type::DOUBLE_HASHING, 1234);
+  REQUIRE(c.is_empty());
+  for (uint64_t i = 0; i < 1000; ++i) {
+    c.update(i, i % 3 == 0 ? -1 : 2);
+    s.update(i, i % 3 == 0 ? -1 : 2);
+  }
+  c.update("x");
+  s.update("x");
+  REQUIRE(c.get_total_weight() == s.get_total_weight());
+  for (uint64_t i = 0; i < 1000; ++i) {
+    REQUIRE(c.get_estimate(i) == s.get_estimate(i));
+    REQUIRE(c.get_upper_bound(i) == s.get_upper_bound(i));
+    REQUIRE(c.get_lower_bound(i) == s.get_lower_bound(i));
+  }
+  REQUIRE(c.get_estimate("x") == s.get_estimate("x"));
+  REQUIRE(c.get_estimate("") == 0);
+
+  const auto result = c.get_result();
+  REQUIRE(result.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  REQUIRE(result.get_total_weight() == s.get_total_weight());
+  REQUIRE(std::equal(result.begin(), result.end(), s.begin()));
+}
+
+TEST_CASE("concurrent CM concurrent updates", "[concurrent_cm]") {
+  concurrent_count_min_sketch<uint64_t> c(3, 1024);
+  const size_t num_threads = 4;
+  const uint64_t n = 20000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&c, n]() {
+      for (uint64_t i = 0; i < n; ++i) c.update(i % 100);
+    });
+  }
+  // queries may run at the same time
+  uint64_t previous = 0;
+  for (int i = 0; i < 100; ++i) {
+    const uint64_t estimate = c.get_estimate(uint64_t(0));
+    REQUIRE(estimate >= previous);
+    previous = estimate;
+  }
+  for (auto& thread: threads) thread.join();
+
+  REQUIRE(c.get_total_weight() == num_threads * n);
+  for (uint64_t i = 0; i < 100; ++i) REQUIRE(c.get_estimate(i) >= num_threads * n / 100);
+}
+
+TEST_CASE("concurrent CM merge", "[concurrent_cm]") {
+  concurrent_count_min_sketch<uint64_t> c(3, 64);
+  REQUIRE_THROWS_WITH(c.merge(count_min_sketch<uint64_t>(3, 64, count_min_hash_type::PER_ROW_HASHING)),
+      "Incompatible sketch configuration.");
+  REQUIRE_THROWS_WITH(c.merge(count_min_sketch<uint64_t>(3, 65, count_min_hash_type::DOUBLE_HASHING)),
+      "Incompatible sketch configuration.");
+
+  count_min_sketch<uint64_t> s(3, 64, count_min_hash_type::DOUBLE_HASHING);
+  count_min_sketch<uint64_t> expected(3, 64, count_min_hash_type::DOUBLE_HASHING);
+  for (uint64_t i = 0; i < 100; ++i) {
+    s.update(i);
+    c.update(i + 1000);
+    expected.update(i);
+    expected.update(i + 1000);
+  }
+  c.merge(s);
+  const auto result = c.get_result();
+  REQUIRE(result.get_total_weight() == expected.get_total_weight());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("concurrent CM serialize-deserialize", "[concurrent_cm]") {
+  concurrent_count_min_sketch<uint64_t> empty(3, 32, 123);
+  auto empty_bytes = empty.serialize();
+  REQUIRE(empty_bytes.size() == empty.get_serialized_size_bytes());
+  auto d0 = concurrent_count_min_sketch<uint64_t>::deserialize(empty_bytes.data(), empty_bytes.size(), 123);
+  REQUIRE(d0.is_empty());
+  REQUIRE(d0.get_num_hashes() == 3);
+
+  concurrent_count_min_sketch<uint64_t> c(3, 32, 123);
+  for (uint64_t i = 0; i < 500; ++i) c.update(i, i);
+  auto bytes = c.serialize();
+  REQUIRE(bytes.size() == c.get_serialized_size_bytes());
+  std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+  c.serialize(s);
+  REQUIRE(s.str().size() == bytes.size());
+
+  // the image is that of count_min_sketch with double hashing
+  auto cm = count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size(), 123);
+  REQUIRE(cm.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  REQUIRE(cm.serialize() == bytes);
+
+  auto d1 = concurrent_count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size(), 123);
+  auto d2 = concurrent_count_min_sketch<uint64_t>::deserialize(s, 123);
+  REQUIRE(d1.serialize() == bytes);
+  REQUIRE(d2.serialize() == bytes);
+  for (uint64_t i = 0; i < 500; ++i) REQUIRE(d1.get_estimate(i) == c.get_estimate(i));
+
+  // the image does not need to be aligned for the counters
+  std::vector<uint8_t> unaligned(bytes.size() + 1);
+  std::copy(bytes.begin(), bytes.end(), unaligned.begin() + 1);
+  auto d3 = concurrent_count_min_sketch<uint64_t>::deserialize(unaligned.data() + 1, bytes.size(), 123);
+  REQUIRE(d3.serialize() == bytes);
+  auto with_header = c.serialize(3);
+  auto d4 = concurrent_count_min_sketch<uint64_t>::deserialize(with_header.data() + 3, bytes.size(), 123);
+  REQUIRE(d4.serialize() == bytes);
+
+  auto per_row = count_min_sketch<uint64_t>(3, 32, 123).serialize();
+  REQUIRE_THROWS_AS(concurrent_count_min_sketch<uint64_t>::deserialize(per_row.data(), per_row.size(), 123),
+      std::invalid_argument);
+}
+
+} /* namespace datasketches */
@@ -61,6 +61,14 @@ TEST_CASE("CM parameter suggestions", "[error parameters]") {
     REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets(0.05) == 55);
     REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets(0.01) == 272);
 
+    // Power of 2 bucket suggestions
+    REQUIRE_THROWS_WITH(count_min_sketch<uint64_t>::suggest_num_buckets_pow2(-1.0), "Relative error must be at least 0.");
+    REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets_pow2(0.2) == 16);
+    REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets_pow2(0.1) == 32);
+    REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets_pow2(0.05) == 64);
+    REQUIRE(count_min_sketch<uint64_t>::suggest_num_buckets_pow2(0.01) == 512);
+    REQUIRE(count_min_sketch<uint64_t>(3, 512).get_relative_error() <= 0.01);
+
     // Check that the sketch get_epsilon acts inversely to suggest_num_buckets
     uint8_t n_hashes = 3;
     REQUIRE(count_min_sketch<uint64_t>(n_hashes, 14).get_relative_error() <= 0.2);
@@ -197,6 +205,38 @@ TEST_CASE("CM merge - pass", "[acceptable cases]") {
     }
   }
 
+TEST_CASE("CM merge many", "[cm_merge_many]") {
+  for (auto hash_type: {count_min_hash_type::PER_ROW_HASHING, count_min_hash_type::DOUBLE_HASHING}) {
+    count_min_sketch<int64_t> s(3, 1000, hash_type);
+    count_min_sketch<int64_t> expected(3, 1000, hash_type);
+    std::vector<count_min_sketch<int64_t>> others(5, count_min_sketch<int64_t>(3, 1000, hash_type));
+    std::vector<const count_min_sketch<int64_t>*> ptrs;
+    for (uint64_t i = 0; i < 10000; ++i) {
+      s.update(i, 3);
+      others[i % others.size()].update(i * 7, i % 3 == 0 ? -1 : 2);
+    }
+    expected.merge(s);
+    for (const auto& other: others) {
+      expected.merge(other);
+      ptrs.push_back(&other);
+    }
+    s.merge_many(ptrs.data(), ptrs.size());
+    REQUIRE(s.get_total_weight() == expected.get_total_weight());
+    REQUIRE(std::equal(s.begin(), s.end(), expected.begin()));
+
+    s.merge_many(ptrs.data(), 0);
+    REQUIRE(s.get_total_weight() == expected.get_total_weight());
+
+    ptrs.push_back(&s);
+    REQUIRE_THROWS_WITH(s.merge_many(ptrs.data(), ptrs.size()), "Cannot merge a sketch with itself.");
+    count_min_sketch<int64_t> incompatible(3, 1001, hash_type);
+    ptrs.back() = &incompatible;
+    REQUIRE_THROWS_WITH(s.merge_many(ptrs.data(), ptrs.size()), "Incompatible sketch configuration.");
+    // nothing is merged if any sketch is rejected
+    REQUIRE(std::equal(s.begin(), s.end(), expected.begin()));
+  }
+}
+
 TEST_CASE("CountMin sketch: serialize-deserialize empty", "[cm_sketch]") {
     uint8_t n_hashes = 1;
     uint32_t n_buckets = 5;
@@ -300,4 +340,254 @@ TEST_CASE("CountMin sketch: bytes serialize-deserialize non-empty", "[cm_sketch]
 
 }
 
+TEST_CASE("CM wrap", "[cm_wrap]") {
+  for (auto hash_type: {count_min_hash_type::PER_ROW_HASHING, count_min_hash_type::DOUBLE_HASHING}) {
+    count_min_sketch<uint64_t> c(3, 100, hash_type, 1234);
+    for (uint64_t i = 0; i < 1000; ++i) c.update(i, i % 5 + 1);
+    auto bytes = c.serialize();
+
+    const auto w = count_min_sketch<uint64_t>::wrap(bytes.data(), bytes.size(), 1234);
+    REQUIRE(w.is_wrapped());
+    REQUIRE(w.is_read_only());
+    REQUIRE(w.get_hash_type() == hash_type);
+    REQUIRE(w.get_total_weight() == c.get_total_weight());
+    REQUIRE(w.begin() == reinterpret_cast<const uint64_t*>(bytes.data() + 24));
+    REQUIRE(std::equal(w.begin(), w.end(), c.begin()));
+    for (uint64_t i = 0; i < 1000; ++i) {
+      REQUIRE(w.get_estimate(i) == c.get_estimate(i));
+      REQUIRE(w.get_upper_bound(i) == c.get_upper_bound(i));
+    }
+    REQUIRE(w.serialize() == bytes);
+
+    // read-only
+    auto copy = w;
+    REQUIRE(copy.begin() == w.begin());
+    REQUIRE_THROWS_AS(copy.update(uint64_t(1)), std::logic_error);
+    REQUIRE_THROWS_AS(copy.merge(c), std::logic_error);
+
+    // a wrapped sketch can be merged into another one
+    count_min_sketch<uint64_t> m(3, 100, hash_type, 1234);
+    m.merge(w);
+    REQUIRE(std::equal(m.begin(), m.end(), c.begin()));
+
+    // writable: the memory stays a valid image of the updated sketch
+    auto ww = count_min_sketch<uint64_t>::writable_wrap(bytes.data(), bytes.size(), 1234);
+    REQUIRE(ww.is_wrapped());
+    REQUIRE_FALSE(ww.is_read_only());
+    const uint64_t key = 7;
+    ww.update(key, 10);
+    c.update(key, 10);
+    const uint64_t keys[] = {8, 9};
+    ww.update_batch(keys, nullptr, 2);
+    c.update_batch(keys, nullptr, 2);
+    ww.merge(m);
+    c.merge(m);
+    REQUIRE(ww.get_total_weight() == c.get_total_weight());
+    REQUIRE(w.get_estimate(key) == c.get_estimate(key));
+    auto d = count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size(), 1234);
+    REQUIRE(d.get_total_weight() == c.get_total_weight());
+    REQUIRE(std::equal(d.begin(), d.end(), c.begin()));
+  }
+}
+
+TEST_CASE("CM wrap - reject", "[cm_wrap]") {
+  count_min_sketch<uint64_t> c(3, 100);
+  auto empty_bytes = c.serialize();
+  REQUIRE_THROWS_AS(count_min_sketch<uint64_t>::writable_wrap(empty_bytes.data(), empty_bytes.size()), std::invalid_argument);
+  const auto e = count_min_sketch<uint64_t>::wrap(empty_bytes.data(), empty_bytes.size());
+  REQUIRE(e.is_empty());
+  REQUIRE(e.is_read_only());
+  REQUIRE_FALSE(e.is_wrapped());
+  REQUIRE(e.get_estimate(uint64_t(1)) == 0);
+
+  c.update(uint64_t(1));
+  auto bytes = c.serialize(1);
+  REQUIRE_THROWS_AS(count_min_sketch<uint64_t>::wrap(bytes.data() + 1, bytes.size() - 1), std::invalid_argument);
+  bytes = c.serialize();
+  REQUIRE_THROWS_AS(count_min_sketch<uint64_t>::wrap(bytes.data(), bytes.size() - 1), std::out_of_range);
+  REQUIRE_THROWS_AS(count_min_sketch<uint64_t>::wrap(bytes.data(), bytes.size(), 1), std::invalid_argument);
+}
+
+TEST_CASE("CM power of 2 buckets", "[cm_pow2]") {
+  // the bucket of an item must not depend on whether it was computed with a mask or a division,
+  // so a sketch with 2^k buckets folds exactly into a sketch with 2^(k-1) buckets
+  uint8_t n_hashes = 4;
+  for (auto hash_type: {count_min_hash_type::PER_ROW_HASHING, count_min_hash_type::DOUBLE_HASHING}) {
+    count_min_sketch<uint64_t> wide(n_hashes, 128, hash_type);
+    count_min_sketch<uint64_t> narrow(n_hashes, 64, hash_type);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      wide.update(i, i % 7 + 1);
+      narrow.update(i, i % 7 + 1);
+    }
+    REQUIRE(wide.get_total_weight() == narrow.get_total_weight());
+    auto wide_it = wide.begin();
+    auto narrow_it = narrow.begin();
+    for (uint8_t row = 0; row < n_hashes; ++row) {
+      for (uint32_t j = 0; j < 64; ++j) {
+        REQUIRE(narrow_it[j] == wide_it[j] + wide_it[j + 64]);
+      }
+      wide_it += 128;
+      narrow_it += 64;
+    }
+  }
+}
+
+TEST_CASE("CM batch update and estimates", "[cm_batch]") {
+  for (auto hash_type: {count_min_hash_type::PER_ROW_HASHING, count_min_hash_type::DOUBLE_HASHING}) {
+    count_min_sketch<uint64_t> c(7, 100, hash_type);
+    count_min_sketch<uint64_t> batch(7, 100, hash_type);
+    const size_t n = 1000; // more than one block
+    std::vector<uint64_t> items(n);
+    std::vector<uint64_t> weights(n);
+    for (size_t i = 0; i < n; ++i) {
+      items[i] = i % 300;
+      weights[i] = i % 5 + 1;
+      c.update(items[i], weights[i]);
+    }
+    batch.update_batch(items.data(), weights.data(), n);
+    REQUIRE(batch.get_total_weight() == c.get_total_weight());
+    REQUIRE(std::equal(c.begin(), c.end(), batch.begin()));
+
+    std::vector<uint64_t> estimates(n);
+    batch.get_estimates(items.data(), estimates.data(), n);
+    for (size_t i = 0; i < n; ++i) REQUIRE(estimates[i] == c.get_estimate(items[i]));
+
+    // unit weights
+    batch.update_batch(items.data(), nullptr, n);
+    for (size_t i = 0; i < n; ++i) c.update(items[i]);
+    REQUIRE(std::equal(c.begin(), c.end(), batch.begin()));
+
+    std::vector<std::string> strings = {"a", "", "b", "a", "c"};
+    std::vector<uint64_t> string_weights = {1, 2, 3, 4, 5};
+    batch.update_batch(strings.data(), string_weights.data(), strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) c.update(strings[i], string_weights[i]);
+    REQUIRE(batch.get_total_weight() == c.get_total_weight());
+    REQUIRE(std::equal(c.begin(), c.end(), batch.begin()));
+    std::vector<uint64_t> string_estimates(strings.size());
+    batch.get_estimates(strings.data(), string_estimates.data(), strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) REQUIRE(string_estimates[i] == c.get_estimate(strings[i]));
+    REQUIRE(string_estimates[1] == 0);
+  }
+}
+
+TEST_CASE("CM batch update without hash functions", "[cm_batch]") {
+  count_min_sketch<uint64_t> c(0, 64);
+  count_min_sketch<uint64_t> batch(0, 64);
+  std::vector<uint64_t> items = {1, 2, 3, 1};
+  std::vector<uint64_t> weights = {1, 2, 3, 4};
+  for (size_t i = 0; i < items.size(); ++i) c.update(items[i], weights[i]);
+  batch.update_batch(items.data(), weights.data(), items.size());
+  REQUIRE(batch.get_total_weight() == c.get_total_weight());
+  std::vector<uint64_t> estimates(items.size());
+  batch.get_estimates(items.data(), estimates.data(), items.size());
+  for (size_t i = 0; i < items.size(); ++i) REQUIRE(estimates[i] == c.get_estimate(items[i]));
+}
+
+TEST_CASE("CM conservative update", "[cm_conservative]") {
+  for (auto hash_type: {count_min_hash_type::PER_ROW_HASHING, count_min_hash_type::DOUBLE_HASHING}) {
+    count_min_sketch<uint64_t> standard(5, 32, hash_type);
+    count_min_sketch<uint64_t> conservative(5, 32, hash_type, count_min_update_type::CONSERVATIVE_UPDATE);
+    REQUIRE(standard.get_update_type() == count_min_update_type::STANDARD_UPDATE);
+    REQUIRE(conservative.get_update_type() == count_min_update_type::CONSERVATIVE_UPDATE);
+    count_min_sketch<int64_t> signed_conservative(5, 32, hash_type, count_min_update_type::CONSERVATIVE_UPDATE);
+    REQUIRE_THROWS_AS(signed_conservative.update(uint64_t(1), -1), std::invalid_argument);
+
+    const uint64_t n = 500;
+    for (uint64_t i = 0; i < n; ++i) {
+      standard.update(i, i % 3 + 1);
+      conservative.update(i, i % 3 + 1);
+    }
+    REQUIRE(conservative.get_total_weight() == standard.get_total_weight());
+
+    // conservative counters never exceed the standard ones but still bound the true frequencies
+    uint64_t standard_error = 0;
+    uint64_t conservative_error = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      REQUIRE(conservative.get_estimate(i) >= i % 3 + 1);
+      REQUIRE(conservative.get_estimate(i) <= standard.get_estimate(i));
+      standard_error += standard.get_estimate(i) - (i % 3 + 1);
+      conservative_error += conservative.get_estimate(i) - (i % 3 + 1);
+    }
+    REQUIRE(conservative_error < standard_error);
+    auto standard_it = standard.begin();
+    for (auto counter: conservative) REQUIRE(counter <= *standard_it++);
+
+    // batch update follows the same policy
+    count_min_sketch<uint64_t> batch(5, 32, hash_type, count_min_update_type::CONSERVATIVE_UPDATE);
+    std::vector<uint64_t> items(n);
+    std::vector<uint64_t> weights(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      items[i] = i;
+      weights[i] = i % 3 + 1;
+    }
+    batch.update_batch(items.data(), weights.data(), n);
+    REQUIRE(std::equal(conservative.begin(), conservative.end(), batch.begin()));
+    std::vector<int64_t> negative = {1, -1};
+    std::vector<uint64_t> negative_items = {1, 2};
+    count_min_sketch<int64_t> signed_batch(5, 32, hash_type, count_min_update_type::CONSERVATIVE_UPDATE);
+    REQUIRE_THROWS_AS(signed_batch.update_batch(negative_items.data(), negative.data(), 2), std::invalid_argument);
+    REQUIRE(signed_batch.is_empty());
+
+    // the policy survives serialization
+    auto bytes = conservative.serialize();
+    auto d = count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size());
+    REQUIRE(d.get_update_type() == count_min_update_type::CONSERVATIVE_UPDATE);
+    REQUIRE(d.get_hash_type() == hash_type);
+    REQUIRE(std::equal(conservative.begin(), conservative.end(), d.begin()));
+    std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+    conservative.serialize(s);
+    REQUIRE(count_min_sketch<uint64_t>::deserialize(s).get_update_type() == count_min_update_type::CONSERVATIVE_UPDATE);
+
+    // merged sketches keep bounding the true frequencies
+    conservative.merge(standard);
+    for (uint64_t i = 0; i < n; ++i) REQUIRE(conservative.get_estimate(i) >= 2 * (i % 3 + 1));
+  }
+}
+
+TEST_CASE("CM double hashing", "[cm_double_hashing]") {
+  uint8_t n_hashes = 7;
+  uint32_t n_buckets = 64;
+  count_min_sketch<uint64_t> c(n_hashes, n_buckets, count_min_hash_type::DOUBLE_HASHING);
+  REQUIRE(c.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  REQUIRE(c.get_seed() == DEFAULT_SEED);
+  REQUIRE(count_min_sketch<uint64_t>(n_hashes, n_buckets).get_hash_type() == count_min_hash_type::PER_ROW_HASHING);
+
+  for (uint64_t i = 0; i < 100; ++i) c.update(i, i + 1);
+  REQUIRE(c.get_total_weight() == 5050);
+  for (uint64_t i = 0; i < 100; ++i) {
+    REQUIRE(c.get_estimate(i) >= i + 1);
+    REQUIRE(c.get_estimate(i) <= c.get_upper_bound(i));
+  }
+
+  // every row holds the full weight
+  uint64_t row_sum = 0;
+  for (auto it = c.begin(); it != c.begin() + n_buckets; ++it) row_sum += *it;
+  REQUIRE(row_sum == c.get_total_weight());
+
+  // merging requires the same hashing scheme
+  count_min_sketch<uint64_t> per_row(n_hashes, n_buckets);
+  REQUIRE_THROWS_WITH(c.merge(per_row), "Incompatible sketch configuration.");
+  count_min_sketch<uint64_t> other(n_hashes, n_buckets, count_min_hash_type::DOUBLE_HASHING);
+  other.update(uint64_t(5), 10);
+  c.merge(other);
+  REQUIRE(c.get_estimate(uint64_t(5)) >= 16);
+
+  auto bytes = c.serialize();
+  auto d = count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size());
+  REQUIRE(d.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+  c.serialize(s);
+  auto e = count_min_sketch<uint64_t>::deserialize(s);
+  REQUIRE(e.get_hash_type() == count_min_hash_type::DOUBLE_HASHING);
+  for (uint64_t i = 0; i < 100; ++i) {
+    REQUIRE(c.get_estimate(i) == d.get_estimate(i));
+    REQUIRE(c.get_estimate(i) == e.get_estimate(i));
+  }
+
+  count_min_sketch<uint64_t> empty(n_hashes, n_buckets, count_min_hash_type::DOUBLE_HASHING);
+  auto empty_bytes = empty.serialize();
+  REQUIRE(count_min_sketch<uint64_t>::deserialize(empty_bytes.data(), empty_bytes.size()).get_hash_type()
+      == count_min_hash_type::DOUBLE_HASHING);
+}
+
 } /* namespace datasketches */
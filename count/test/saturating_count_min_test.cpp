@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <sstream>
+
+#include "saturating_count_min.hpp"
+#include "count_min.hpp"
+
+namespace datasketches {
+
+TEST_CASE("saturating CM init - throws", "[saturating_cm]") {
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint8_t>(0, 16), std::invalid_argument);
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint8_t>(4, 2), std::invalid_argument);
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint8_t>(4, 1 << 28), std::invalid_argument);
+}
+
+TEST_CASE("saturating CM init", "[saturating_cm]") {
+  saturating_count_min_sketch<uint16_t> c(3, 5, 1234567);
+  REQUIRE(c.get_num_hashes() == 3);
+  REQUIRE(c.get_num_buckets() == 5);
+  REQUIRE(c.get_seed() == 1234567);
+  REQUIRE(c.is_empty());
+  REQUIRE(c.end() - c.begin() == 15);
+  for (auto x: c) REQUIRE(x == 0);
+  REQUIRE(saturating_count_min_sketch<uint16_t>::get_max_counter() == 65535);
+}
+
+TEST_CASE("saturating CM matches count_min_sketch below saturation", "[saturating_cm]") {
+  for (uint32_t num_buckets: {37u, 64u}) {
+    saturating_count_min_sketch<uint16_t> s(4, num_buckets);
+    count_min_sketch<uint64_t> c(4, num_buckets, count_min_hash_type::DOUBLE_HASHING);
+    for (uint64_t i = 0; i < 1000; ++i) {
+      s.update(i, i % 7 + 1);
+      c.update(i, i % 7 + 1);
+    }
+    s.update("x", 3);
+    c.update("x", 3);
+    REQUIRE(s.get_total_weight() == c.get_total_weight());
+    REQUIRE(std::equal(s.begin(), s.end(), c.begin()));
+    for (uint64_t i = 0; i < 1000; ++i) {
+      REQUIRE(s.get_estimate(i) == c.get_estimate(i));
+      REQUIRE(s.get_lower_bound(i) == c.get_lower_bound(i));
+    }
+    REQUIRE(s.get_estimate("x") == c.get_estimate("x"));
+    REQUIRE(s.get_estimate("") == 0);
+    REQUIRE(s.get_num_saturated() == 0);
+  }
+}
+
+TEST_CASE("saturating CM saturation", "[saturating_cm]") {
+  saturating_count_min_sketch<uint8_t> c(3, 64);
+  c.update("a", 200);
+  c.update("a", 100);
+  c.update("b");
+  REQUIRE(c.get_total_weight() == 301);
+  REQUIRE(c.get_estimate("a") == 255);
+  REQUIRE(c.get_lower_bound("a") == 255);
+  REQUIRE(c.get_upper_bound("a") == std::numeric_limits<uint64_t>::max());
+  REQUIRE(c.get_num_saturated() >= 1);
+
+  c.update("c", 1000000);
+  REQUIRE(c.get_estimate("c") == 255);
+  REQUIRE(c.get_total_weight() == 1000301);
+
+  // an unsaturated estimate keeps the usual bound
+  const uint64_t estimate = c.get_estimate("b");
+  if (estimate < 255) {
+    REQUIRE(c.get_upper_bound("b") == static_cast<uint64_t>(estimate + c.get_relative_error() * c.get_total_weight()));
+  }
+}
+
+TEST_CASE("saturating CM merge", "[saturating_cm]") {
+  saturating_count_min_sketch<uint8_t> s(2, 32);
+  REQUIRE_THROWS_WITH(s.merge(s), "Cannot merge a sketch with itself.");
+  REQUIRE_THROWS_WITH(s.merge(saturating_count_min_sketch<uint8_t>(3, 32)), "Incompatible sketch configuration.");
+  REQUIRE_THROWS_WITH(s.merge(saturating_count_min_sketch<uint8_t>(2, 33)), "Incompatible sketch configuration.");
+  REQUIRE_THROWS_WITH(s.merge(saturating_count_min_sketch<uint8_t>(2, 32, 1)), "Incompatible sketch configuration.");
+
+  saturating_count_min_sketch<uint8_t> t(2, 32);
+  s.update("a", 100);
+  s.update("b", 5);
+  t.update("a", 200);
+  t.update("c", 7);
+  s.merge(t);
+  REQUIRE(s.get_total_weight() == 312);
+  REQUIRE(s.get_estimate("a") == 255);
+  REQUIRE(s.get_estimate("b") >= 5);
+  REQUIRE(s.get_estimate("c") >= 7);
+}
+
+TEST_CASE("saturating CM serialize-deserialize empty", "[saturating_cm]") {
+  saturating_count_min_sketch<uint8_t> c(3, 32, 1234);
+  std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+  c.serialize(s);
+  REQUIRE(static_cast<size_t>(s.tellp()) == c.get_serialized_size_bytes());
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint8_t>::deserialize(s, DEFAULT_SEED), std::invalid_argument);
+  s.seekg(0);
+  auto d = saturating_count_min_sketch<uint8_t>::deserialize(s, 1234);
+  REQUIRE(d.is_empty());
+  REQUIRE(d.get_num_hashes() == 3);
+  REQUIRE(d.get_num_buckets() == 32);
+
+  auto bytes = c.serialize();
+  REQUIRE(bytes.size() == c.get_serialized_size_bytes());
+  auto e = saturating_count_min_sketch<uint8_t>::deserialize(bytes.data(), bytes.size(), 1234);
+  REQUIRE(e.is_empty());
+}
+
+TEST_CASE("saturating CM serialize-deserialize non-empty", "[saturating_cm]") {
+  saturating_count_min_sketch<uint16_t> c(3, 50);
+  for (uint64_t i = 0; i < 1000; ++i) c.update(i, i * i);
+
+  std::stringstream s(std::ios::in | std::ios::out | std::ios::binary);
+  c.serialize(s);
+  REQUIRE(static_cast<size_t>(s.tellp()) == 24 + 2 * 150);
+  auto d = saturating_count_min_sketch<uint16_t>::deserialize(s);
+  REQUIRE(d.get_total_weight() == c.get_total_weight());
+  REQUIRE(std::equal(c.begin(), c.end(), d.begin()));
+
+  auto bytes = c.serialize();
+  REQUIRE(bytes.size() == c.get_serialized_size_bytes());
+  auto e = saturating_count_min_sketch<uint16_t>::deserialize(bytes.data(), bytes.size());
+  REQUIRE(e.get_total_weight() == c.get_total_weight());
+  REQUIRE(std::equal(c.begin(), c.end(), e.begin()));
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint16_t>::deserialize(bytes.data(), bytes.size() - 1), std::out_of_range);
+
+  // wrong counter width and wrong sketch type
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint8_t>::deserialize(bytes.data(), bytes.size()), std::invalid_argument);
+  REQUIRE_THROWS_AS(count_min_sketch<uint64_t>::deserialize(bytes.data(), bytes.size()), std::invalid_argument);
+  auto cm_bytes = count_min_sketch<uint64_t>(3, 50).serialize();
+  REQUIRE_THROWS_AS(saturating_count_min_sketch<uint16_t>::deserialize(cm_bytes.data(), cm_bytes.size()), std::invalid_argument);
+}
+
+} /* namespace datasketches */
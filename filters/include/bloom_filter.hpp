@@ -504,6 +504,14 @@ public:
    */
   void union_with(const bloom_filter_alloc& other);
 
+  /**
+   * Unions several Bloom Filters into this one. The result is the same as calling
+   * union_with() for each of them, but the bits of this filter are traversed once.
+   * @param others pointers to the Bloom Filters to union with this one
+   * @param num_filters number of Bloom Filters to union
+   */
+  void union_many(const bloom_filter_alloc* const* others, size_t num_filters);
+
   /**
    * Intersects two Bloom Filters by applying a logical AND. The result will recognize
    * only values seen by both filters (as well as false positives).
@@ -28,6 +28,7 @@
 #include "common_defs.hpp"
 #include "bit_array_ops.hpp"
 #include "memory_operations.hpp"
+#include "simd_ops.hpp"
 #include "xxhash64.h"
 
 // memory scenarios:
@@ -845,7 +846,22 @@ void bloom_filter_alloc<A>::union_with(const bloom_filter_alloc& other) {
   if (!is_compatible(other)) {
     throw std::invalid_argument("Incompatible bloom filters");
   }
-  uint64_t bits_set = bit_array_ops::union_with(bit_array_, other.bit_array_, capacity_bits_ >> 3);
+  uint64_t bits_set = simd_ops::union_with(bit_array_, other.bit_array_, capacity_bits_ >> 3);
+  update_num_bits_set(bits_set);
+}
+
+template<typename A>
+void bloom_filter_alloc<A>::union_many(const bloom_filter_alloc* const* others, size_t num_filters) {
+  using AllocPtr = typename std::allocator_traits<A>::template rebind_alloc<const uint8_t*>;
+  std::vector<const uint8_t*, AllocPtr> bit_arrays{AllocPtr(allocator_)};
+  bit_arrays.reserve(num_filters);
+  for (size_t i = 0; i < num_filters; ++i) {
+    if (!is_compatible(*others[i])) {
+      throw std::invalid_argument("Incompatible bloom filters");
+    }
+    bit_arrays.push_back(others[i]->bit_array_);
+  }
+  uint64_t bits_set = simd_ops::union_many(bit_array_, bit_arrays.data(), bit_arrays.size(), capacity_bits_ >> 3);
   update_num_bits_set(bits_set);
 }
 
@@ -854,7 +870,7 @@ void bloom_filter_alloc<A>::intersect(const bloom_filter_alloc& other) {
   if (!is_compatible(other)) {
     throw std::invalid_argument("Incompatible bloom filters");
   }
-  uint64_t bits_set = bit_array_ops::intersect(bit_array_, other.bit_array_, capacity_bits_ >> 3);
+  uint64_t bits_set = simd_ops::intersect(bit_array_, other.bit_array_, capacity_bits_ >> 3);
   update_num_bits_set(bits_set);
 }
 
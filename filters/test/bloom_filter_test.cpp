@@ -234,6 +234,37 @@ TEST_CASE("bloom_filter: basic union", "[bloom_filter]") {
   REQUIRE(num_found < num_bits / 10); // not being super strict
 }
 
+TEST_CASE("bloom_filter: union many", "[bloom_filter]") {
+  const uint64_t num_bits = 200000;
+  const uint16_t num_hashes = 3;
+
+  auto bf = bloom_filter::builder::create_by_size(num_bits, num_hashes);
+  auto expected = bloom_filter::builder::create_by_size(num_bits, num_hashes, bf.get_seed());
+  std::vector<bloom_filter> others;
+  for (int j = 0; j < 4; ++j) others.push_back(bloom_filter::builder::create_by_size(num_bits, num_hashes, bf.get_seed()));
+  std::vector<const bloom_filter*> ptrs;
+  for (uint64_t i = 0; i < 8000; ++i) {
+    bf.update(i);
+    expected.update(i);
+    others[i % others.size()].update(i + 1000000);
+  }
+  for (const auto& other: others) {
+    expected.union_with(other);
+    ptrs.push_back(&other);
+  }
+  bf.union_many(ptrs.data(), ptrs.size());
+  REQUIRE(bf.get_bits_used() == expected.get_bits_used());
+  REQUIRE(bf.serialize() == expected.serialize());
+  for (uint64_t i = 0; i < 8000; ++i) {
+    REQUIRE(bf.query(i));
+    REQUIRE(bf.query(i + 1000000));
+  }
+
+  auto incompatible = bloom_filter::builder::create_by_size(num_bits, num_hashes, bf.get_seed() + 1);
+  ptrs.push_back(&incompatible);
+  REQUIRE_THROWS_AS(bf.union_many(ptrs.data(), ptrs.size()), std::invalid_argument);
+}
+
 TEST_CASE("bloom_filter: basic intersection", "[bloom_filter]") {
   const uint64_t num_bits = 8192;
   const uint16_t num_hahes = 5;
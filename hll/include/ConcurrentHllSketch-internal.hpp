@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _CONCURRENTHLLSKETCH_INTERNAL_HPP_
+#define _CONCURRENTHLLSKETCH_INTERNAL_HPP_
+
+#include "concurrent_hll.hpp"
+#include "HllUtil.hpp"
+#include "HllArray.hpp"
+#include "Hll8Array.hpp"
+#include "HllEstimatorKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace datasketches {
+
+template<typename A>
+concurrent_hll_sketch_alloc<A>::concurrent_hll_sketch_alloc(uint8_t lg_config_k, const A& allocator):
+allocator_(allocator),
+lg_config_k_(HllUtil<A>::checkLgK(lg_config_k)),
+// std::atomic cannot be copied, so the registers are value-initialized (zero) in place
+registers_(1 << lg_config_k, AllocAtomic(allocator))
+{}
+
+template<typename A>
+concurrent_hll_sketch_alloc<A>::concurrent_hll_sketch_alloc(concurrent_hll_sketch_alloc&& that) noexcept:
+allocator_(std::move(that.allocator_)),
+lg_config_k_(that.lg_config_k_),
+registers_(std::move(that.registers_))
+{}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(const std::string& datum) {
+  if (datum.empty()) { return; }
+  hash_and_update(datum.c_str(), datum.length());
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(uint64_t datum) {
+  // no sign extension with 64 bits so no need to cast to signed value
+  hash_and_update(&datum, sizeof(uint64_t));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(uint32_t datum) {
+  update(static_cast<int32_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(uint16_t datum) {
+  update(static_cast<int16_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(uint8_t datum) {
+  update(static_cast<int8_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(int64_t datum) {
+  hash_and_update(&datum, sizeof(int64_t));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(int32_t datum) {
+  update(static_cast<int64_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(int16_t datum) {
+  update(static_cast<int64_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(int8_t datum) {
+  update(static_cast<int64_t>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(double datum) {
+  // same canonicalization as hll_sketch
+  union {
+    int64_t longBytes;
+    double doubleBytes;
+  } d;
+  d.doubleBytes = datum;
+  if (datum == 0.0) {
+    d.doubleBytes = 0.0; // canonicalize -0.0 to 0.0
+  } else if (std::isnan(d.doubleBytes)) {
+    d.longBytes = 0x7ff8000000000000L; // canonicalize NaN using value from Java's Double.doubleToLongBits()
+  }
+  hash_and_update(&d, sizeof(double));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(float datum) {
+  update(static_cast<double>(datum));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::update(const void* data, size_t length_bytes) {
+  if (data == nullptr) { return; }
+  hash_and_update(data, length_bytes);
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::hash_and_update(const void* data, size_t length_bytes) {
+  HashState hashResult;
+  HllUtil<A>::hash(data, length_bytes, DEFAULT_SEED, hashResult);
+  coupon_update(HllUtil<A>::coupon(hashResult));
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::coupon_update(uint32_t coupon) {
+  const uint32_t slot = HllUtil<A>::getLow26(coupon) & ((1 << lg_config_k_) - 1);
+  const uint8_t new_value = HllUtil<A>::getValue(coupon);
+  std::atomic<uint8_t>& reg = registers_[slot];
+  uint8_t cur_value = reg.load(std::memory_order_relaxed);
+  // a failed exchange reloads cur_value, the loop ends as soon as another thread stored a value at least as large
+  while (new_value > cur_value && !reg.compare_exchange_weak(cur_value, new_value, std::memory_order_relaxed)) {}
+}
+
+template<typename A>
+void concurrent_hll_sketch_alloc<A>::copy_registers(uint8_t* dst, uint32_t start, uint32_t num_registers) const {
+  for (uint32_t i = 0; i < num_registers; ++i) {
+    dst[i] = registers_[start + i].load(std::memory_order_relaxed);
+  }
+}
+
+template<typename A>
+hll_estimator::register_stats concurrent_hll_sketch_alloc<A>::get_register_stats() const {
+  // the registers are copied a chunk at a time into a buffer that stays in L1 cache for the kernels
+  const uint32_t num_slots = 1 << lg_config_k_;
+  const auto level = simd_ops::get_simd_level();
+  uint8_t values[hll_estimator::CHUNK_SIZE];
+  auto stats = hll_estimator::empty_stats();
+  for (uint32_t i = 0; i < num_slots; i += hll_estimator::CHUNK_SIZE) {
+    const uint32_t n = std::min(hll_estimator::CHUNK_SIZE, num_slots - i);
+    copy_registers(values, i, n);
+    hll_estimator::combine_stats(stats, hll_estimator::get_chunk_stats(values, n, level));
+  }
+  return stats;
+}
+
+template<typename A>
+double concurrent_hll_sketch_alloc<A>::get_estimate(const hll_estimator::register_stats& stats) const {
+  // only the sum kxq0 + kxq1 is used by the estimator
+  return HllArray<A>::compositeEstimate(lg_config_k_, stats.sum, 0, stats.min, stats.num_at_min);
+}
+
+template<typename A>
+double concurrent_hll_sketch_alloc<A>::get_estimate() const {
+  return get_estimate(get_register_stats());
+}
+
+template<typename A>
+double concurrent_hll_sketch_alloc<A>::get_lower_bound(uint8_t num_std_dev) const {
+  const auto stats = get_register_stats();
+  return HllArray<A>::lowerBound(lg_config_k_, get_estimate(stats), true, stats.min, stats.num_at_min, num_std_dev);
+}
+
+template<typename A>
+double concurrent_hll_sketch_alloc<A>::get_upper_bound(uint8_t num_std_dev) const {
+  return HllArray<A>::upperBound(lg_config_k_, get_estimate(), true, num_std_dev);
+}
+
+template<typename A>
+uint8_t concurrent_hll_sketch_alloc<A>::get_lg_config_k() const {
+  return lg_config_k_;
+}
+
+template<typename A>
+bool concurrent_hll_sketch_alloc<A>::is_empty() const {
+  for (const auto& reg: registers_) {
+    if (reg.load(std::memory_order_relaxed) != 0) { return false; }
+  }
+  return true;
+}
+
+template<typename A>
+hll_sketch_alloc<A> concurrent_hll_sketch_alloc<A>::get_result(target_hll_type tgt_type) const {
+  const uint32_t num_slots = 1 << lg_config_k_;
+  typename HllSketchImpl<A>::vector_bytes snapshot(num_slots, 0, allocator_);
+  copy_registers(snapshot.data(), 0, num_slots);
+  if (std::all_of(snapshot.begin(), snapshot.end(), [](uint8_t value) { return value == 0; })) {
+    return hll_sketch_alloc<A>(lg_config_k_, tgt_type, false, allocator_);
+  }
+
+  typedef typename std::allocator_traits<A>::template rebind_alloc<Hll8Array<A>> hll8Alloc;
+  Hll8Array<A>* hll8 = new (hll8Alloc(allocator_).allocate(1)) Hll8Array<A>(lg_config_k_, false, allocator_);
+  hll_sketch_alloc<A> result(hll8);
+  hll8->mergeHllArray(lg_config_k_, HLL_8, snapshot.data(), snapshot.size(), 0);
+  // like other HLL_8 arrays keeps curMin at zero with numAtCurMin as the number of zeros
+  hll8->check_rebuild_kxq_cur_min();
+  if (hll8->getCurMin() > 0) {
+    hll8->putCurMin(0);
+    hll8->putNumAtCurMin(0);
+  }
+  // there is no HIP accumulator, the composite estimate is used as for the result of a union
+  hll8->putHipAccum(0);
+  hll8->putOutOfOrderFlag(true);
+  if (tgt_type == HLL_8) { return result; }
+  return hll_sketch_alloc<A>(result, tgt_type);
+}
+
+template<typename A>
+A concurrent_hll_sketch_alloc<A>::get_allocator() const {
+  return allocator_;
+}
+
+}
+
+#endif // _CONCURRENTHLLSKETCH_INTERNAL_HPP_
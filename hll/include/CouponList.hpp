@@ -56,6 +56,11 @@ class CouponList : public HllSketchImpl<A> {
     virtual double getUpperBound(uint8_t numStdDev) const;
     virtual double getLowerBound(uint8_t numStdDev) const;
 
+    // estimators from the number of coupons, also used by wrapped serialized images
+    static double estimate(uint32_t couponCount);
+    static double lowerBound(uint32_t couponCount, uint8_t numStdDev);
+    static double upperBound(uint32_t couponCount, uint8_t numStdDev);
+
     virtual bool isEmpty() const;
     virtual uint32_t getCouponCount() const;
 
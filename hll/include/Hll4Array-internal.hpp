@@ -141,6 +141,13 @@ HllSketchImpl<A>* Hll4Array<A>::couponUpdate(uint32_t coupon) {
   return this;
 }
 
+template<typename A>
+void Hll4Array<A>::couponUpdate(const uint32_t* coupons, size_t numCoupons) {
+  for (size_t i = 0; i < numCoupons; ++i) {
+    internalCouponUpdate(coupons[i]);
+  }
+}
+
 template<typename A>
 void Hll4Array<A>::internalCouponUpdate(uint32_t coupon) {
   const uint8_t newValue = HllUtil<A>::getValue(coupon);
@@ -45,6 +45,7 @@ class Hll4Array final : public HllArray<A> {
     virtual uint32_t getHllByteArrBytes() const;
 
     virtual HllSketchImpl<A>* couponUpdate(uint32_t coupon) final;
+    virtual void couponUpdate(const uint32_t* coupons, size_t numCoupons) final;
 
     virtual AuxHashMap<A>* getAuxHashMap() const;
     // does *not* delete old map if overwriting
@@ -104,6 +104,13 @@ HllSketchImpl<A>* Hll6Array<A>::couponUpdate(uint32_t coupon) {
   return this;
 }
 
+template<typename A>
+void Hll6Array<A>::couponUpdate(const uint32_t* coupons, size_t numCoupons) {
+  for (size_t i = 0; i < numCoupons; ++i) {
+    internalCouponUpdate(coupons[i]);
+  }
+}
+
 template<typename A>
 void Hll6Array<A>::internalCouponUpdate(uint32_t coupon) {
   const uint32_t configKmask = (1 << this->lgConfigK_) - 1;
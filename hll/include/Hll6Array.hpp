@@ -42,6 +42,7 @@ class Hll6Array final : public HllArray<A> {
     inline void putSlot(uint32_t slotNo, uint8_t value);
 
     virtual HllSketchImpl<A>* couponUpdate(uint32_t coupon) final;
+    virtual void couponUpdate(const uint32_t* coupons, size_t numCoupons) final;
 
     virtual uint32_t getHllByteArrBytes() const;
 
@@ -21,6 +21,8 @@
 #define _HLL8ARRAY_INTERNAL_HPP_
 
 #include "Hll8Array.hpp"
+#include "HllEstimatorKernels.hpp"
+#include "HllMergeKernels.hpp"
 
 namespace datasketches {
 
@@ -39,14 +41,39 @@ Hll8Array<A>::Hll8Array(const HllArray<A>& other):
   const int numBytes = this->hll8ArrBytes(this->lgConfigK_);
   this->hllByteArr_.resize(numBytes, 0);
   this->oooFlag_ = other.isOutOfOrderFlag();
-  uint32_t num_zeros = 1 << this->lgConfigK_;
-  
-  for (const auto coupon : other) { // all = false, so skip empty values
-    num_zeros--;
-    internalCouponUpdate(coupon); // updates KxQ registers
+  const uint32_t num_slots = 1 << this->lgConfigK_;
+
+  // unpack the registers, then compute KxQ and the number of zeros in one pass over them
+  uint8_t* dst = this->hllByteArr_.data();
+  const uint8_t* src = other.getHllArray().data();
+  if (other.getTgtHllType() == target_hll_type::HLL_8) {
+    std::copy(src, src + num_slots, dst);
+  } else if (other.getTgtHllType() == target_hll_type::HLL_6) {
+    hll_merge::max_hll6(dst, src, num_slots, other.getHllArray().size());
+  } else { // HLL_4
+    hll_merge::max_hll4(dst, src, num_slots, other.getCurMin());
+    const AuxHashMap<A>* aux_map = other.getAuxHashMap();
+    if (aux_map != nullptr) {
+      for (const auto coupon: *aux_map) {
+        dst[HllUtil<A>::getLow26(coupon) & (num_slots - 1)] = HllUtil<A>::getValue(coupon);
+      }
+    }
+  }
+  const auto stats = hll_estimator::get_hll8_stats(dst, num_slots);
+  if (stats.max < 32) {
+    // the same sums as replaying the coupons, since they are exact in any order
+    this->kxq0_ = stats.sum;
+    this->numAtCurMin_ = stats.min == 0 ? stats.num_at_min : 0;
+  } else {
+    // with values of 32 and above kxq1 depends on the order of additions, so the coupons are replayed
+    std::fill(this->hllByteArr_.begin(), this->hllByteArr_.end(), 0);
+    uint32_t num_zeros = num_slots;
+    for (const auto coupon : other) { // all = false, so skip empty values
+      num_zeros--;
+      internalCouponUpdate(coupon); // updates KxQ registers
+    }
+    this->numAtCurMin_ = num_zeros;
   }
-  
-  this->numAtCurMin_ = num_zeros;
   this->hipAccum_ = other.getHipAccum();
   this->rebuild_kxq_curmin_ = false;
 }
@@ -90,6 +117,13 @@ HllSketchImpl<A>* Hll8Array<A>::couponUpdate(uint32_t coupon) {
   return this;
 }
 
+template<typename A>
+void Hll8Array<A>::couponUpdate(const uint32_t* coupons, size_t numCoupons) {
+  for (size_t i = 0; i < numCoupons; ++i) {
+    internalCouponUpdate(coupons[i]);
+  }
+}
+
 template<typename A>
 void Hll8Array<A>::internalCouponUpdate(uint32_t coupon) {
   const uint32_t configKmask = (1 << this->lgConfigK_) - 1;
@@ -113,84 +147,43 @@ void Hll8Array<A>::mergeList(const CouponList<A>& src) {
 
 template<typename A>
 void Hll8Array<A>::mergeHll(const HllArray<A>& src) {
+  mergeHllArray(src.getLgConfigK(), src.getTgtHllType(), src.getHllArray().data(), src.getHllArray().size(), src.getCurMin());
+  // registers with the aux token are skipped above, their values are in the aux hash map
+  const AuxHashMap<A>* aux_map = src.getAuxHashMap();
+  if (aux_map != nullptr) {
+    for (const auto coupon: *aux_map) mergeAuxCoupon(coupon);
+  }
+}
+
+template<typename A>
+void Hll8Array<A>::mergeHllArray(uint8_t srcLgConfigK, target_hll_type srcType, const uint8_t* srcBytes,
+    size_t numBytes, uint8_t curMin) {
   // at this point src_k >= dst_k
-  // we can optimize further when the k values are equal
-  if (this->getLgConfigK() == src.getLgConfigK()) {
-    if (src.getTgtHllType() == target_hll_type::HLL_8) {
-      uint32_t i = 0;
-      for (const auto value: src.getHllArray()) {
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], value);
-        ++i;
-      }
-    } else if (src.getTgtHllType() == target_hll_type::HLL_6) {
-      const uint32_t src_k = 1 << src.getLgConfigK();
-      uint32_t i = 0;
-      const uint8_t* ptr = src.getHllArray().data();
-      while (i < src_k) {
-        uint8_t value = *ptr & 0x3f;
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], value);
-        ++i;
-        value = *ptr++ >> 6;
-        value |= (*ptr & 0x0f) << 2;
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], value);
-        ++i;
-        value = *ptr++ >> 4;
-        value |= (*ptr & 3) << 4;
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], value);
-        ++i;
-        value = *ptr++ >> 2;
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], value);
-        ++i;
-      }
-    } else { // HLL_4
-      const auto& src4 = static_cast<const Hll4Array<A>&>(src);
-      uint32_t i = 0;
-      for (const auto byte: src.getHllArray()) {
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], src4.adjustRawValue(i, byte & hll_constants::loNibbleMask));
-        ++i;
-        this->hllByteArr_[i] = std::max(this->hllByteArr_[i], src4.adjustRawValue(i, byte >> 4));
-        ++i;
-      }
+  // the source is merged in blocks of dst_k registers, folding them onto the target if src_k > dst_k
+  const uint32_t dst_k = 1 << this->getLgConfigK();
+  const uint32_t src_k = 1 << srcLgConfigK;
+  uint8_t* dst = this->hllByteArr_.data();
+  if (srcType == target_hll_type::HLL_8) {
+    for (uint32_t i = 0; i < src_k; i += dst_k) {
+      hll_merge::max_hll8(dst, srcBytes + i, dst_k);
     }
-  } else {
-    // src_k > dst_k
-    const uint32_t dst_mask = (1 << this->getLgConfigK()) - 1;
-    // special treatment below to optimize performance
-    if (src.getTgtHllType() == target_hll_type::HLL_8) {
-      uint32_t i = 0;
-      for (const auto value: src.getHllArray()) {
-        processValue(i++, dst_mask, value);
-      }
-    } else if (src.getTgtHllType() == target_hll_type::HLL_6) {
-      const uint32_t src_k = 1 << src.getLgConfigK();
-      uint32_t i = 0;
-      const uint8_t* ptr = src.getHllArray().data();
-      while (i < src_k) {
-        uint8_t value = *ptr & 0x3f;
-        processValue(i++, dst_mask, value);
-        value = *ptr++ >> 6;
-        value |= (*ptr & 0x0f) << 2;
-        processValue(i++, dst_mask, value);
-        value = *ptr++ >> 4;
-        value |= (*ptr & 3) << 4;
-        processValue(i++, dst_mask, value);
-        value = *ptr++ >> 2;
-        processValue(i++, dst_mask, value);
-      }
-    } else { // HLL_4
-      const auto& src4 = static_cast<const Hll4Array<A>&>(src);
-      uint32_t i = 0;
-      for (const auto byte: src.getHllArray()) {
-        processValue(i, dst_mask, src4.adjustRawValue(i, byte & hll_constants::loNibbleMask));
-        ++i;
-        processValue(i, dst_mask, src4.adjustRawValue(i, byte >> 4));
-        ++i;
-      }
+  } else if (srcType == target_hll_type::HLL_6) {
+    for (uint32_t i = 0; i < src_k; i += dst_k) {
+      const size_t offset = i / 4 * 3;
+      hll_merge::max_hll6(dst, srcBytes + offset, dst_k, numBytes - offset);
+    }
+  } else { // HLL_4
+    for (uint32_t i = 0; i < src_k; i += dst_k) {
+      hll_merge::max_hll4(dst, srcBytes + i / 2, dst_k, curMin);
     }
   }
   this->setRebuildKxqCurminFlag(true);
 }
 
+template<typename A>
+void Hll8Array<A>::mergeAuxCoupon(uint32_t coupon) {
+  processValue(HllUtil<A>::getLow26(coupon), (1 << this->getLgConfigK()) - 1, HllUtil<A>::getValue(coupon));
+}
 
 template<typename A>
 void Hll8Array<A>::processValue(uint32_t slot, uint32_t mask, uint8_t new_val) {
@@ -42,8 +42,13 @@ class Hll8Array final : public HllArray<A> {
     inline void putSlot(uint32_t slotNo, uint8_t value);
 
     virtual HllSketchImpl<A>* couponUpdate(uint32_t coupon) final;
+    virtual void couponUpdate(const uint32_t* coupons, size_t numCoupons) final;
     void mergeList(const CouponList<A>& src);
     void mergeHll(const HllArray<A>& src);
+    // merges registers given as bytes in the layout of srcType, without the aux hash map of HLL_4
+    void mergeHllArray(uint8_t srcLgConfigK, target_hll_type srcType, const uint8_t* srcBytes, size_t numBytes, uint8_t curMin);
+    // merges a value from the aux hash map of HLL_4
+    inline void mergeAuxCoupon(uint32_t coupon);
 
     virtual uint32_t getHllByteArrBytes() const;
 
@@ -27,6 +27,7 @@
 #include "CompositeInterpolationXTable.hpp"
 #include "CouponList.hpp"
 #include "inv_pow2_table.hpp"
+#include "HllEstimatorKernels.hpp"
 #include <cstring>
 #include <cmath>
 #include <stdexcept>
@@ -343,18 +344,29 @@ double HllArray<A>::getEstimate() const {
  */
 template<typename A>
 double HllArray<A>::getLowerBound(uint8_t numStdDev) const {
-  HllUtil<A>::checkNumStdDev(numStdDev);
-  const uint32_t configK = 1 << this->lgConfigK_;
-  const double numNonZeros = ((curMin_ == 0) ? (configK - numAtCurMin_) : configK);
-  const double relErr = HllUtil<A>::getRelErr(false, this->oooFlag_, this->lgConfigK_, numStdDev);
-  return fmax(getEstimate() / (1.0 + relErr), numNonZeros);
+  return lowerBound(this->lgConfigK_, getEstimate(), this->oooFlag_, curMin_, numAtCurMin_, numStdDev);
 }
 
 template<typename A>
 double HllArray<A>::getUpperBound(uint8_t numStdDev) const {
+  return upperBound(this->lgConfigK_, getEstimate(), this->oooFlag_, numStdDev);
+}
+
+template<typename A>
+double HllArray<A>::lowerBound(uint8_t lgConfigK, double estimate, bool oooFlag, uint8_t curMin,
+                               uint32_t numAtCurMin, uint8_t numStdDev) {
   HllUtil<A>::checkNumStdDev(numStdDev);
-  const double relErr = HllUtil<A>::getRelErr(true, this->oooFlag_, this->lgConfigK_, numStdDev);
-  return getEstimate() / (1.0 + relErr);
+  const uint32_t configK = 1 << lgConfigK;
+  const double numNonZeros = ((curMin == 0) ? (configK - numAtCurMin) : configK);
+  const double relErr = HllUtil<A>::getRelErr(false, oooFlag, lgConfigK, numStdDev);
+  return fmax(estimate / (1.0 + relErr), numNonZeros);
+}
+
+template<typename A>
+double HllArray<A>::upperBound(uint8_t lgConfigK, double estimate, bool oooFlag, uint8_t numStdDev) {
+  HllUtil<A>::checkNumStdDev(numStdDev);
+  const double relErr = HllUtil<A>::getRelErr(true, oooFlag, lgConfigK, numStdDev);
+  return estimate / (1.0 + relErr);
 }
 
 /**
@@ -362,14 +374,19 @@ double HllArray<A>::getUpperBound(uint8_t numStdDev) const {
  * It is called "composite" because multiple estimators are pasted together.
  * @return the composite estimate
  */
-// Original C: again-two-registers.c hhb_get_composite_estimate L1489
 template<typename A>
 double HllArray<A>::getCompositeEstimate() const {
-  const double rawEst = getHllRawEstimate();
+  return compositeEstimate(this->lgConfigK_, kxq0_, kxq1_, curMin_, numAtCurMin_);
+}
 
-  const double* xArr = CompositeInterpolationXTable<A>::get_x_arr(this->lgConfigK_);
+// Original C: again-two-registers.c hhb_get_composite_estimate L1489
+template<typename A>
+double HllArray<A>::compositeEstimate(uint8_t lgConfigK, double kxq0, double kxq1, uint8_t curMin, uint32_t numAtCurMin) {
+  const double rawEst = hllRawEstimate(lgConfigK, kxq0, kxq1);
+
+  const double* xArr = CompositeInterpolationXTable<A>::get_x_arr(lgConfigK);
   const uint32_t xArrLen = CompositeInterpolationXTable<A>::get_x_arr_length();
-  const double yStride = CompositeInterpolationXTable<A>::get_y_stride(this->lgConfigK_);
+  const double yStride = CompositeInterpolationXTable<A>::get_y_stride(lgConfigK);
 
   if (rawEst < xArr[0]) {
     return 0;
@@ -388,9 +405,9 @@ double HllArray<A>::getCompositeEstimate() const {
   // We need to completely avoid the linear_counting estimator if it might have a crazy value.
   // Empirical evidence suggests that the threshold 3*k will keep us safe if 2^4 <= k <= 2^21.
 
-  if (adjEst > (3 << this->lgConfigK_)) { return adjEst; }
+  if (adjEst > (3 << lgConfigK)) { return adjEst; }
 
-  const double linEst = getHllBitMapEstimate();
+  const double linEst = hllBitMapEstimate(lgConfigK, curMin, numAtCurMin);
 
   // Bias is created when the value of an estimator is compared with a threshold to decide whether
   // to use that estimator or a different one.
@@ -402,10 +419,10 @@ double HllArray<A>::getCompositeEstimate() const {
   // The following constants comes from empirical measurements of the crossover point
   // between the average error of the linear estimator and the adjusted hll estimator
   double crossOver = 0.64;
-  if (this->lgConfigK_ == 4)      { crossOver = 0.718; }
-  else if (this->lgConfigK_ == 5) { crossOver = 0.672; }
+  if (lgConfigK == 4)      { crossOver = 0.718; }
+  else if (lgConfigK == 5) { crossOver = 0.672; }
 
-  return (avgEst > (crossOver * (1 << this->lgConfigK_))) ? adjEst : linEst;
+  return (avgEst > (crossOver * (1 << lgConfigK))) ? adjEst : linEst;
 }
 
 template<typename A>
@@ -560,9 +577,9 @@ void HllArray<A>::hipAndKxQIncrementalUpdate(uint8_t oldValue, uint8_t newValue)
  */
 //In C: again-two-registers.c hhb_get_improved_linear_counting_estimate L1274
 template<typename A>
-double HllArray<A>::getHllBitMapEstimate() const {
-  const uint32_t configK = 1 << this->lgConfigK_;
-  const uint32_t numUnhitBuckets = curMin_ == 0 ? numAtCurMin_ : 0;
+double HllArray<A>::hllBitMapEstimate(uint8_t lgConfigK, uint8_t curMin, uint32_t numAtCurMin) {
+  const uint32_t configK = 1 << lgConfigK;
+  const uint32_t numUnhitBuckets = curMin == 0 ? numAtCurMin : 0;
 
   //This will eventually go away.
   if (numUnhitBuckets == 0) {
@@ -575,14 +592,14 @@ double HllArray<A>::getHllBitMapEstimate() const {
 
 //In C: again-two-registers.c hhb_get_raw_estimate L1167
 template<typename A>
-double HllArray<A>::getHllRawEstimate() const {
-  const uint32_t configK = 1 << this->lgConfigK_;
+double HllArray<A>::hllRawEstimate(uint8_t lgConfigK, double kxq0, double kxq1) {
+  const uint32_t configK = 1 << lgConfigK;
   double correctionFactor;
-  if (this->lgConfigK_ == 4) { correctionFactor = 0.673; }
-  else if (this->lgConfigK_ == 5) { correctionFactor = 0.697; }
-  else if (this->lgConfigK_ == 6) { correctionFactor = 0.709; }
+  if (lgConfigK == 4) { correctionFactor = 0.673; }
+  else if (lgConfigK == 5) { correctionFactor = 0.697; }
+  else if (lgConfigK == 6) { correctionFactor = 0.709; }
   else { correctionFactor = 0.7213 / (1.0 + (1.079 / configK)); }
-  const double hyperEst = (correctionFactor * configK * configK) / (kxq0_ + kxq1_);
+  const double hyperEst = (correctionFactor * configK * configK) / (kxq0 + kxq1);
   return hyperEst;
 }
 
@@ -600,6 +617,22 @@ template<typename A>
 void HllArray<A>::check_rebuild_kxq_cur_min() {
   if (!rebuild_kxq_curmin_) { return; }
 
+  if (this->tgtHllType_ != target_hll_type::HLL_4) {
+    const uint32_t num_slots = 1 << this->lgConfigK_;
+    const auto stats = this->tgtHllType_ == target_hll_type::HLL_8
+        ? hll_estimator::get_hll8_stats(hllByteArr_.data(), num_slots)
+        : hll_estimator::get_hll6_stats(hllByteArr_.data(), num_slots, hllByteArr_.size());
+    // with values of 32 and above kxq1 depends on the order of additions, so the loop below is used
+    if (stats.max < 32) {
+      kxq0_ = stats.sum;
+      kxq1_ = 0;
+      curMin_ = stats.min;
+      numAtCurMin_ = stats.num_at_min;
+      rebuild_kxq_curmin_ = false;
+      return;
+    }
+  }
+
   uint8_t cur_min = 64;
   uint32_t num_at_cur_min = 0;
   double kxq0 = 1 << this->lgConfigK_;
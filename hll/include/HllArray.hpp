@@ -49,6 +49,8 @@ class HllArray : public HllSketchImpl<A> {
     virtual HllArray* copyAs(target_hll_type tgtHllType) const;
 
     virtual HllSketchImpl<A>* couponUpdate(uint32_t coupon) = 0;
+    // applies a batch of coupons with a single virtual call, HLL mode is never promoted
+    virtual void couponUpdate(const uint32_t* coupons, size_t numCoupons) = 0;
 
     virtual double getEstimate() const;
     virtual double getCompositeEstimate() const;
@@ -89,6 +91,11 @@ class HllArray : public HllSketchImpl<A> {
 
     virtual AuxHashMap<A>* getAuxHashMap() const;
 
+    // estimators from the state of an array, also used by wrapped serialized images
+    static double compositeEstimate(uint8_t lgConfigK, double kxq0, double kxq1, uint8_t curMin, uint32_t numAtCurMin);
+    static double lowerBound(uint8_t lgConfigK, double estimate, bool oooFlag, uint8_t curMin, uint32_t numAtCurMin, uint8_t numStdDev);
+    static double upperBound(uint8_t lgConfigK, double estimate, bool oooFlag, uint8_t numStdDev);
+
     void setRebuildKxqCurminFlag(bool rebuild);
     bool isRebuildKxqCurminFlag() const;
     void check_rebuild_kxq_cur_min();
@@ -103,8 +110,8 @@ class HllArray : public HllSketchImpl<A> {
 
   protected:
     void hipAndKxQIncrementalUpdate(uint8_t oldValue, uint8_t newValue);
-    double getHllBitMapEstimate() const;
-    double getHllRawEstimate() const;
+    static double hllBitMapEstimate(uint8_t lgConfigK, uint8_t curMin, uint32_t numAtCurMin);
+    static double hllRawEstimate(uint8_t lgConfigK, double kxq0, double kxq1);
 
     double hipAccum_;
     double kxq0_;
@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _HLLESTIMATORKERNELS_HPP_
+#define _HLLESTIMATORKERNELS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "HllMergeKernels.hpp"
+#include "inv_pow2_table.hpp"
+#include "simd_ops.hpp"
+
+#ifdef DATASKETCHES_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace datasketches {
+
+/**
+ * Kernels that compute in one pass over HLL registers what the estimators need:
+ * the sum of 2^-v, the minimum value and the number of registers at the minimum
+ * (the number of zeros if the minimum is zero).
+ *
+ * The registers are processed in chunks that stay in L1 cache while the number of registers
+ * at the minimum of the chunk is counted, so the array is read from memory once.
+ * On x86 with GCC or Clang, AVX2 versions are used if the CPU supports them.
+ *
+ * The sum is exact as long as all values are below 32: every partial sum is then a multiple
+ * of 2^-31 not greater than 2^21, which a double represents exactly, so the order of
+ * the additions does not matter. Callers that need bit-exact results check the maximum.
+ */
+namespace hll_estimator {
+
+  struct register_stats {
+    double sum;          // sum of 2^-v over the registers
+    uint8_t min;         // minimum value
+    uint8_t max;         // maximum value
+    uint32_t num_at_min; // number of registers with the minimum value
+  };
+
+  static const uint32_t CHUNK_SIZE = 4096;
+
+  static inline register_stats empty_stats() {
+    register_stats stats;
+    stats.sum = 0;
+    stats.min = UINT8_MAX;
+    stats.max = 0;
+    stats.num_at_min = 0;
+    return stats;
+  }
+
+  static inline void combine_stats(register_stats& stats, const register_stats& other) {
+    stats.sum += other.sum;
+    if (other.min < stats.min) {
+      stats.min = other.min;
+      stats.num_at_min = other.num_at_min;
+    } else if (other.min == stats.min) {
+      stats.num_at_min += other.num_at_min;
+    }
+    stats.max = std::max(stats.max, other.max);
+  }
+
+  static inline register_stats get_chunk_stats_scalar(const uint8_t* values, uint32_t n) {
+    register_stats stats = empty_stats();
+    for (uint32_t i = 0; i < n; ++i) {
+      stats.sum += INVERSE_POWERS_OF_2[values[i]];
+      stats.min = std::min(stats.min, values[i]);
+      stats.max = std::max(stats.max, values[i]);
+    }
+    for (uint32_t i = 0; i < n; ++i) stats.num_at_min += values[i] == stats.min;
+    return stats;
+  }
+
+#ifdef DATASKETCHES_SIMD_X86
+
+  // 2^-v for 4 values in the low 4 bytes of a vector, built from the exponent bits of a double
+  static DATASKETCHES_TARGET_AVX2 inline __m256d inverse_powers_of_2_avx2(__m128i values) {
+    const __m256i exponents = _mm256_sub_epi64(_mm256_set1_epi64x(1023), _mm256_cvtepu8_epi64(values));
+    return _mm256_castsi256_pd(_mm256_slli_epi64(exponents, 52));
+  }
+
+  // n is a multiple of 32
+  static DATASKETCHES_TARGET_AVX2 inline register_stats get_chunk_stats_avx2(const uint8_t* values, uint32_t n) {
+    __m256i min = _mm256_set1_epi8(static_cast<char>(UINT8_MAX));
+    __m256i max = _mm256_setzero_si256();
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd();
+    __m256d sum3 = _mm256_setzero_pd();
+    for (uint32_t i = 0; i < n; i += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+      min = _mm256_min_epu8(min, v);
+      max = _mm256_max_epu8(max, v);
+      const __m128i lo = _mm256_castsi256_si128(v);
+      const __m128i hi = _mm256_extracti128_si256(v, 1);
+      sum0 = _mm256_add_pd(sum0, inverse_powers_of_2_avx2(lo));
+      sum1 = _mm256_add_pd(sum1, inverse_powers_of_2_avx2(_mm_srli_si128(lo, 4)));
+      sum2 = _mm256_add_pd(sum2, inverse_powers_of_2_avx2(_mm_srli_si128(lo, 8)));
+      sum3 = _mm256_add_pd(sum3, inverse_powers_of_2_avx2(_mm_srli_si128(lo, 12)));
+      sum0 = _mm256_add_pd(sum0, inverse_powers_of_2_avx2(hi));
+      sum1 = _mm256_add_pd(sum1, inverse_powers_of_2_avx2(_mm_srli_si128(hi, 4)));
+      sum2 = _mm256_add_pd(sum2, inverse_powers_of_2_avx2(_mm_srli_si128(hi, 8)));
+      sum3 = _mm256_add_pd(sum3, inverse_powers_of_2_avx2(_mm_srli_si128(hi, 12)));
+    }
+    register_stats stats;
+    double sums[4];
+    _mm256_storeu_pd(sums, _mm256_add_pd(_mm256_add_pd(sum0, sum1), _mm256_add_pd(sum2, sum3)));
+    stats.sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    uint8_t mins[32];
+    uint8_t maxs[32];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs), max);
+    stats.min = *std::min_element(mins, mins + 32);
+    stats.max = *std::max_element(maxs, maxs + 32);
+    // the chunk is still in cache
+    const __m256i target = _mm256_set1_epi8(static_cast<char>(stats.min));
+    uint32_t num_at_min = 0;
+    for (uint32_t i = 0; i < n; i += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+      num_at_min += static_cast<uint32_t>(__builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, target))));
+    }
+    stats.num_at_min = num_at_min;
+    return stats;
+  }
+
+#endif // DATASKETCHES_SIMD_X86
+
+  static inline register_stats get_chunk_stats(const uint8_t* values, uint32_t n, simd_ops::simd_level level) {
+#ifdef DATASKETCHES_SIMD_X86
+    if (level != simd_ops::SCALAR && n % 32 == 0) return get_chunk_stats_avx2(values, n);
+#else
+    (void) level;
+#endif
+    return get_chunk_stats_scalar(values, n);
+  }
+
+  /**
+   * Computes the statistics of HLL_8 registers.
+   * @param values one byte per register
+   * @param num_slots number of registers
+   * @param level instruction set to use
+   * @return statistics of the registers
+   */
+  static inline register_stats get_hll8_stats(const uint8_t* values, uint32_t num_slots,
+      simd_ops::simd_level level = simd_ops::get_simd_level()) {
+    register_stats stats = empty_stats();
+    for (uint32_t i = 0; i < num_slots; i += CHUNK_SIZE) {
+      combine_stats(stats, get_chunk_stats(values + i, std::min(CHUNK_SIZE, num_slots - i), level));
+    }
+    return stats;
+  }
+
+  /**
+   * Computes the statistics of HLL_6 registers, unpacking them a chunk at a time.
+   * @param src 3 bytes per 4 registers
+   * @param num_slots number of registers, a multiple of 4
+   * @param src_bytes number of bytes that can be read from src, at least 3 * num_slots / 4
+   * @param level instruction set to use
+   * @return statistics of the registers
+   */
+  static inline register_stats get_hll6_stats(const uint8_t* src, uint32_t num_slots, size_t src_bytes,
+      simd_ops::simd_level level = simd_ops::get_simd_level()) {
+    register_stats stats = empty_stats();
+    uint8_t values[CHUNK_SIZE];
+    for (uint32_t i = 0; i < num_slots; i += CHUNK_SIZE) {
+      const uint32_t n = std::min(CHUNK_SIZE, num_slots - i);
+      const size_t offset = i / 4 * 3;
+      std::memset(values, 0, n);
+      hll_merge::max_hll6(values, src + offset, n, src_bytes - offset, level);
+      combine_stats(stats, get_chunk_stats(values, n, level));
+    }
+    return stats;
+  }
+
+} // namespace hll_estimator
+
+} // namespace datasketches
+
+#endif // _HLLESTIMATORKERNELS_HPP_
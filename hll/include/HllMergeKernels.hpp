@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _HLLMERGEKERNELS_HPP_
+#define _HLLMERGEKERNELS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+
+#include "HllUtil.hpp"
+#include "simd_ops.hpp"
+
+#ifdef DATASKETCHES_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace datasketches {
+
+/**
+ * Kernels that unpack HLL registers of a source array and take the maximum with one byte per register
+ * in a target array, as in merging into an HLL_8 array.
+ *
+ * On x86 with GCC or Clang, AVX2 versions are compiled next to the portable ones and used
+ * if the CPU supports them (AVX-512 capable CPUs use the AVX2 versions too).
+ * HLL_4 sources are merged without their exceptions: registers marked as stored in the
+ * auxiliary hash map are skipped, and the caller merges the values from the map.
+ */
+namespace hll_merge {
+
+  static inline void max_hll8_scalar(uint8_t* tgt, const uint8_t* src, uint32_t num_slots) {
+    for (uint32_t i = 0; i < num_slots; ++i) tgt[i] = std::max(tgt[i], src[i]);
+  }
+
+  // 4 registers of 6 bits in 3 bytes, little-endian
+  static inline void max_hll6_scalar(uint8_t* tgt, const uint8_t* src, uint32_t num_slots) {
+    for (uint32_t i = 0; i < num_slots; i += 4) {
+      const uint32_t word = src[0] | (src[1] << 8) | (src[2] << 16);
+      tgt[i] = std::max(tgt[i], static_cast<uint8_t>(word & 0x3f));
+      tgt[i + 1] = std::max(tgt[i + 1], static_cast<uint8_t>((word >> 6) & 0x3f));
+      tgt[i + 2] = std::max(tgt[i + 2], static_cast<uint8_t>((word >> 12) & 0x3f));
+      tgt[i + 3] = std::max(tgt[i + 3], static_cast<uint8_t>(word >> 18));
+      src += 3;
+    }
+  }
+
+  // 2 registers of 4 bits in a byte, low nibble first, values relative to cur_min
+  static inline void max_hll4_scalar(uint8_t* tgt, const uint8_t* src, uint32_t num_slots, uint8_t cur_min) {
+    for (uint32_t i = 0; i < num_slots; i += 2) {
+      const uint8_t lo = *src & hll_constants::loNibbleMask;
+      const uint8_t hi = *src >> 4;
+      if (lo != hll_constants::AUX_TOKEN) tgt[i] = std::max(tgt[i], static_cast<uint8_t>(lo + cur_min));
+      if (hi != hll_constants::AUX_TOKEN) tgt[i + 1] = std::max(tgt[i + 1], static_cast<uint8_t>(hi + cur_min));
+      ++src;
+    }
+  }
+
+#ifdef DATASKETCHES_SIMD_X86
+
+  // 32 registers per iteration
+  static DATASKETCHES_TARGET_AVX2 inline uint32_t max_hll8_avx2(uint8_t* tgt, const uint8_t* src, uint32_t num_slots) {
+    uint32_t i = 0;
+    for (; i + 32 <= num_slots; i += 32) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tgt + i));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tgt + i), _mm256_max_epu8(a, b));
+    }
+    return i;
+  }
+
+  // 32 registers from 24 bytes per iteration: each 128-bit lane gets 12 bytes, a shuffle spreads
+  // every 3 bytes into a 32-bit word, and shifts move the 4 registers of the word into its 4 bytes.
+  // Each iteration reads 4 bytes past the 24 it unpacks, the caller leaves room for that.
+  static DATASKETCHES_TARGET_AVX2 inline uint32_t max_hll6_avx2(uint8_t* tgt, const uint8_t* src, uint32_t num_slots) {
+    const __m256i spread = _mm256_setr_epi8(
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    const __m256i mask0 = _mm256_set1_epi32(0x3f);
+    const __m256i mask1 = _mm256_set1_epi32(0x3f00);
+    const __m256i mask2 = _mm256_set1_epi32(0x3f0000);
+    const __m256i mask3 = _mm256_set1_epi32(0x3f000000);
+    uint32_t i = 0;
+    for (; i + 32 <= num_slots; i += 32) {
+      const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+      const __m256i words = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), spread);
+      __m256i values = _mm256_and_si256(words, mask0);
+      values = _mm256_or_si256(values, _mm256_and_si256(_mm256_slli_epi32(words, 2), mask1));
+      values = _mm256_or_si256(values, _mm256_and_si256(_mm256_slli_epi32(words, 4), mask2));
+      values = _mm256_or_si256(values, _mm256_and_si256(_mm256_slli_epi32(words, 6), mask3));
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tgt + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tgt + i), _mm256_max_epu8(a, values));
+      src += 24;
+    }
+    return i;
+  }
+
+  // 64 registers from 32 bytes per iteration: nibbles are split into two vectors and interleaved back,
+  // registers with the aux token become zero, which leaves the target as is
+  static DATASKETCHES_TARGET_AVX2 inline uint32_t max_hll4_avx2(uint8_t* tgt, const uint8_t* src, uint32_t num_slots, uint8_t cur_min) {
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+    const __m256i aux_token = _mm256_set1_epi8(hll_constants::AUX_TOKEN);
+    const __m256i offset = _mm256_set1_epi8(static_cast<char>(cur_min));
+    uint32_t i = 0;
+    for (; i + 64 <= num_slots; i += 64) {
+      const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i / 2));
+      __m256i lo = _mm256_and_si256(bytes, nibble_mask);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask);
+      lo = _mm256_andnot_si256(_mm256_cmpeq_epi8(lo, aux_token), _mm256_add_epi8(lo, offset));
+      hi = _mm256_andnot_si256(_mm256_cmpeq_epi8(hi, aux_token), _mm256_add_epi8(hi, offset));
+      // unpacking works within 128-bit lanes, the permutes put the registers back in order
+      const __m256i unpacked_lo = _mm256_unpacklo_epi8(lo, hi);
+      const __m256i unpacked_hi = _mm256_unpackhi_epi8(lo, hi);
+      const __m256i values0 = _mm256_permute2x128_si256(unpacked_lo, unpacked_hi, 0x20);
+      const __m256i values1 = _mm256_permute2x128_si256(unpacked_lo, unpacked_hi, 0x31);
+      const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tgt + i));
+      const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tgt + i + 32));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tgt + i), _mm256_max_epu8(a0, values0));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(tgt + i + 32), _mm256_max_epu8(a1, values1));
+    }
+    return i;
+  }
+
+#endif // DATASKETCHES_SIMD_X86
+
+  /**
+   * Takes the maximum of HLL_8 registers into the target.
+   * @param tgt one byte per register
+   * @param src one byte per register
+   * @param num_slots number of registers
+   * @param level instruction set to use
+   */
+  static inline void max_hll8(uint8_t* tgt, const uint8_t* src, uint32_t num_slots,
+      simd_ops::simd_level level = simd_ops::get_simd_level()) {
+    uint32_t i = 0;
+#ifdef DATASKETCHES_SIMD_X86
+    if (level != simd_ops::SCALAR) i = max_hll8_avx2(tgt, src, num_slots);
+#else
+    (void) level;
+#endif
+    max_hll8_scalar(tgt + i, src + i, num_slots - i);
+  }
+
+  /**
+   * Unpacks HLL_6 registers and takes their maximum into the target.
+   * @param tgt one byte per register
+   * @param src 3 bytes per 4 registers
+   * @param num_slots number of registers, a multiple of 4
+   * @param src_bytes number of bytes that can be read from src, at least 3 * num_slots / 4
+   * @param level instruction set to use
+   */
+  static inline void max_hll6(uint8_t* tgt, const uint8_t* src, uint32_t num_slots, size_t src_bytes,
+      simd_ops::simd_level level = simd_ops::get_simd_level()) {
+    uint32_t i = 0;
+#ifdef DATASKETCHES_SIMD_X86
+    // the vector loop reads 4 bytes past the registers it unpacks
+    if (level != simd_ops::SCALAR && src_bytes >= 4) {
+      const uint32_t max_slots = static_cast<uint32_t>(std::min<size_t>(num_slots, (src_bytes - 4) / 3 * 4));
+      i = max_hll6_avx2(tgt, src, max_slots & ~3u);
+    }
+#else
+    (void) level;
+    (void) src_bytes;
+#endif
+    max_hll6_scalar(tgt + i, src + i / 4 * 3, num_slots - i);
+  }
+
+  /**
+   * Unpacks HLL_4 registers and takes their maximum into the target, skipping the registers
+   * that hold the aux token.
+   * @param tgt one byte per register
+   * @param src one byte per 2 registers
+   * @param num_slots number of registers, a multiple of 2
+   * @param cur_min value to add to the registers
+   * @param level instruction set to use
+   */
+  static inline void max_hll4(uint8_t* tgt, const uint8_t* src, uint32_t num_slots, uint8_t cur_min,
+      simd_ops::simd_level level = simd_ops::get_simd_level()) {
+    uint32_t i = 0;
+#ifdef DATASKETCHES_SIMD_X86
+    if (level != simd_ops::SCALAR) i = max_hll4_avx2(tgt, src, num_slots, cur_min);
+#else
+    (void) level;
+#endif
+    max_hll4_scalar(tgt + i, src + i / 2, num_slots - i, cur_min);
+  }
+
+} // namespace hll_merge
+
+} // namespace datasketches
+
+#endif // _HLLMERGEKERNELS_HPP_
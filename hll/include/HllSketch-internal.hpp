@@ -27,6 +27,7 @@
 #include "HllArray.hpp"
 #include "common_defs.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -221,6 +222,46 @@ void hll_sketch_alloc<A>::coupon_update(uint32_t coupon) {
   }
 }
 
+template<typename A>
+void hll_sketch_alloc<A>::coupon_update_batch(const uint32_t* coupons, size_t num_coupons) {
+  size_t i = 0;
+  // LIST and SET modes can be promoted by any coupon, HLL mode is final
+  while (i < num_coupons && sketch_impl->getCurMode() != HLL) {
+    coupon_update(coupons[i++]);
+  }
+  if (i < num_coupons) {
+    static_cast<HllArray<A>*>(sketch_impl)->couponUpdate(coupons + i, num_coupons - i);
+  }
+}
+
+template<typename A>
+void hll_sketch_alloc<A>::update_batch(const uint64_t* values, size_t num_values) {
+  update_batch_impl(values, num_values);
+}
+
+template<typename A>
+void hll_sketch_alloc<A>::update_batch(const std::string* values, size_t num_values) {
+  update_batch_impl(values, num_values);
+}
+
+template<typename A>
+template<typename T>
+void hll_sketch_alloc<A>::update_batch_impl(const T* values, size_t num_values) {
+  uint32_t coupons[BATCH_SIZE];
+  for (size_t start = 0; start < num_values; start += BATCH_SIZE) {
+    const size_t end = std::min(start + BATCH_SIZE, num_values);
+    size_t num_coupons = 0;
+    for (size_t i = start; i < end; ++i) {
+      if (is_ignored(values[i])) continue;
+      HashState hashResult;
+      HllUtil<A>::hash(value_data(values[i]), value_size(values[i]), DEFAULT_SEED, hashResult);
+      const uint32_t coupon = HllUtil<A>::coupon(hashResult);
+      if (coupon != hll_constants::EMPTY) coupons[num_coupons++] = coupon;
+    }
+    coupon_update_batch(coupons, num_coupons);
+  }
+}
+
 template<typename A>
 void hll_sketch_alloc<A>::serialize_compact(std::ostream& os) const {
   return sketch_impl->serialize(os, true);
@@ -81,6 +81,8 @@ class HllSketchImpl {
     const target_hll_type tgtHllType_;
     const hll_mode mode_;
     const bool startFullSize_;
+
+    friend class wrapped_hll_sketch_alloc<A>;
 };
 
 }
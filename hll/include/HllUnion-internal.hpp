@@ -59,6 +59,61 @@ void hll_union_alloc<A>::update(hll_sketch_alloc<A>&& sketch) {
   union_impl(sketch, lg_max_k_);
 }
 
+template<typename A>
+void hll_union_alloc<A>::update(const wrapped_hll_sketch_alloc<A>& sketch) {
+  if (sketch.is_empty()) { return; }
+  // follows union_impl with the source read from the wrapped image
+  HllSketchImpl<A>* dst_impl = gadget_.sketch_impl;
+  if (sketch.mode_ == LIST || sketch.mode_ == SET) {
+    for (uint32_t i = 0; i < sketch.num_coupon_slots_; ++i) {
+      const uint32_t coupon = wrapped_hll_sketch_alloc<A>::get_coupon(sketch.coupons_, i);
+      if (coupon != hll_constants::EMPTY) { dst_impl = leak_free_coupon_update(dst_impl, coupon); }
+    }
+  } else if (!dst_impl->isEmpty() && dst_impl->getCurMode() == HLL) {
+    if (sketch.lg_config_k_ < dst_impl->getLgConfigK()) {
+      dst_impl = copy_or_downsample(dst_impl, sketch.lg_config_k_);
+      gadget_.sketch_impl->get_deleter()(gadget_.sketch_impl); // gadget to be replaced
+    }
+    merge_wrapped_hll(*static_cast<Hll8Array<A>*>(dst_impl), sketch);
+    dst_impl->putOutOfOrderFlag(true);
+    static_cast<Hll8Array<A>*>(dst_impl)->putHipAccum(0);
+  } else { // src is HLL, gadget is empty, LIST or SET
+    // as in copy_or_downsample, the source is copied if its lg_k is not greater than lg_max_k
+    const bool is_copy = sketch.lg_config_k_ <= lg_max_k_;
+    const uint8_t tgt_lg_k = is_copy ? sketch.lg_config_k_ : lg_max_k_;
+    typedef typename std::allocator_traits<A>::template rebind_alloc<Hll8Array<A>> hll8Alloc;
+    Hll8Array<A>* tgtHllArr = new (hll8Alloc(dst_impl->getAllocator()).allocate(1))
+        Hll8Array<A>(tgt_lg_k, is_copy && sketch.start_full_size_, dst_impl->getAllocator());
+    merge_wrapped_hll(*tgtHllArr, sketch);
+    // a copy has KxQ before the coupons of the gadget are merged into it,
+    // and like other HLL_8 arrays keeps curMin at zero with numAtCurMin as the number of zeros
+    if (is_copy) {
+      tgtHllArr->check_rebuild_kxq_cur_min();
+      if (tgtHllArr->getCurMin() > 0) {
+        tgtHllArr->putCurMin(0);
+        tgtHllArr->putNumAtCurMin(0);
+      }
+    }
+    tgtHllArr->putHipAccum(sketch.hip_accum_);
+    tgtHllArr->putOutOfOrderFlag(sketch.ooo_flag_);
+    if (!dst_impl->isEmpty()) {
+      tgtHllArr->mergeList(*static_cast<const CouponList<A>*>(dst_impl));
+    }
+    gadget_.sketch_impl->get_deleter()(gadget_.sketch_impl); // gadget to be replaced
+    dst_impl = tgtHllArr;
+  }
+  gadget_.sketch_impl = dst_impl; // gadget replaced
+}
+
+template<typename A>
+void hll_union_alloc<A>::merge_wrapped_hll(Hll8Array<A>& dst, const wrapped_hll_sketch_alloc<A>& src) {
+  dst.mergeHllArray(src.lg_config_k_, src.tgt_type_, src.hll_array_, src.hll_array_bytes_, src.cur_min_);
+  for (uint32_t i = 0; i < src.num_aux_slots_; ++i) {
+    const uint32_t coupon = wrapped_hll_sketch_alloc<A>::get_coupon(src.aux_coupons_, i);
+    if (coupon != hll_constants::EMPTY) { dst.mergeAuxCoupon(coupon); }
+  }
+}
+
 template<typename A>
 void hll_union_alloc<A>::update(const std::string& datum) {
   gadget_.update(datum);
@@ -119,6 +174,16 @@ void hll_union_alloc<A>::update(const void* data, size_t length_bytes) {
   gadget_.update(data, length_bytes);
 }
 
+template<typename A>
+void hll_union_alloc<A>::update_batch(const uint64_t* values, size_t num_values) {
+  gadget_.update_batch(values, num_values);
+}
+
+template<typename A>
+void hll_union_alloc<A>::update_batch(const std::string* values, size_t num_values) {
+  gadget_.update_batch(values, num_values);
+}
+
 template<typename A>
 void hll_union_alloc<A>::coupon_update(uint32_t coupon) {
   if (coupon == HllUtil<A>::EMPTY) { return; }
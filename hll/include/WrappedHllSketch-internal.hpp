@@ -0,0 +1,219 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _WRAPPEDHLLSKETCH_INTERNAL_HPP_
+#define _WRAPPEDHLLSKETCH_INTERNAL_HPP_
+
+#include "hll.hpp"
+#include "HllUtil.hpp"
+#include "HllSketchImpl.hpp"
+#include "CouponList.hpp"
+#include "HllArray.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace datasketches {
+
+template<typename A>
+wrapped_hll_sketch_alloc<A>::wrapped_hll_sketch_alloc():
+  mode_(LIST),
+  tgt_type_(HLL_4),
+  lg_config_k_(0),
+  compact_(false),
+  ooo_flag_(false),
+  start_full_size_(false),
+  coupon_count_(0),
+  coupons_(nullptr),
+  num_coupon_slots_(0),
+  cur_min_(0),
+  num_at_cur_min_(0),
+  hip_accum_(0),
+  kxq0_(0),
+  kxq1_(0),
+  hll_array_(nullptr),
+  hll_array_bytes_(0),
+  aux_coupons_(nullptr),
+  num_aux_slots_(0)
+{}
+
+// the checks are the same as in deserialization
+template<typename A>
+const wrapped_hll_sketch_alloc<A> wrapped_hll_sketch_alloc<A>::wrap(const void* bytes, size_t len) {
+  if (len < hll_constants::LIST_INT_ARR_START) {
+    throw std::out_of_range("Input data length insufficient to hold HLL sketch");
+  }
+
+  const uint8_t* data = static_cast<const uint8_t*>(bytes);
+  if (data[hll_constants::SER_VER_BYTE] != hll_constants::SER_VER) {
+    throw std::invalid_argument("Wrong ser ver in input stream");
+  }
+  if (data[hll_constants::FAMILY_BYTE] != hll_constants::FAMILY_ID) {
+    throw std::invalid_argument("Input array is not an HLL sketch");
+  }
+
+  wrapped_hll_sketch_alloc sketch;
+  sketch.mode_ = HllSketchImpl<A>::extractCurMode(data[hll_constants::MODE_BYTE]);
+  sketch.tgt_type_ = HllSketchImpl<A>::extractTgtHllType(data[hll_constants::MODE_BYTE]);
+  sketch.lg_config_k_ = data[hll_constants::LG_K_BYTE];
+  sketch.compact_ = data[hll_constants::FLAGS_BYTE] & hll_constants::COMPACT_FLAG_MASK;
+  sketch.ooo_flag_ = data[hll_constants::FLAGS_BYTE] & hll_constants::OUT_OF_ORDER_FLAG_MASK;
+  sketch.start_full_size_ = data[hll_constants::FLAGS_BYTE] & hll_constants::FULL_SIZE_FLAG_MASK;
+  const bool empty_flag = data[hll_constants::FLAGS_BYTE] & hll_constants::EMPTY_FLAG_MASK;
+  const uint8_t pre_ints = data[hll_constants::PREAMBLE_INTS_BYTE];
+
+  if (sketch.mode_ == LIST) {
+    if (pre_ints != hll_constants::LIST_PREINTS) {
+      throw std::invalid_argument("Incorrect number of preInts in input stream");
+    }
+    sketch.coupon_count_ = data[hll_constants::LIST_COUNT_BYTE];
+    const uint32_t list_capacity = 1u << hll_constants::LG_INIT_LIST_SIZE;
+    if (sketch.coupon_count_ >= list_capacity) {
+      throw std::invalid_argument("Attempt to deserialize invalid CouponList with couponCount >= capacity. Found couponCount: "
+                                  + std::to_string(sketch.coupon_count_)
+                                  + ", capacity: " + std::to_string(list_capacity));
+    }
+    const uint32_t coupons_in_array = sketch.compact_ ? sketch.coupon_count_
+        : 1 << HllUtil<A>::computeLgArrInts(LIST, sketch.coupon_count_, sketch.lg_config_k_);
+    const size_t expected_length = hll_constants::LIST_INT_ARR_START + coupons_in_array * sizeof(uint32_t);
+    if (len < expected_length) {
+      throw std::out_of_range("Byte array too short for sketch. Expected " + std::to_string(expected_length)
+                              + ", found: " + std::to_string(len));
+    }
+    // only the first coupon_count coupons are valid, as in deserialization
+    if (!empty_flag) {
+      sketch.coupons_ = data + hll_constants::LIST_INT_ARR_START;
+      sketch.num_coupon_slots_ = sketch.coupon_count_;
+    }
+  } else if (sketch.mode_ == SET) {
+    if (pre_ints != hll_constants::HASH_SET_PREINTS) {
+      throw std::invalid_argument("Incorrect number of preInts in input stream");
+    }
+    if (len < hll_constants::HASH_SET_INT_ARR_START) {
+      throw std::out_of_range("Input data length insufficient to hold CouponHashSet");
+    }
+    if (sketch.lg_config_k_ <= 7) {
+      throw std::invalid_argument("Attempt to deserialize invalid CouponHashSet with lgConfigK <= 7. Found: "
+                                  + std::to_string(sketch.lg_config_k_));
+    }
+    std::memcpy(&sketch.coupon_count_, data + hll_constants::HASH_SET_COUNT_INT, sizeof(uint32_t));
+    uint8_t lg_arr_ints = data[hll_constants::LG_ARR_BYTE];
+    if (lg_arr_ints < hll_constants::LG_INIT_SET_SIZE) {
+      lg_arr_ints = HllUtil<A>::computeLgArrInts(SET, sketch.coupon_count_, sketch.lg_config_k_);
+    }
+    const uint32_t coupons_in_array = sketch.compact_ ? sketch.coupon_count_ : 1 << lg_arr_ints;
+    const size_t expected_length = hll_constants::HASH_SET_INT_ARR_START + coupons_in_array * sizeof(uint32_t);
+    if (len < expected_length) {
+      throw std::out_of_range("Byte array too short for sketch. Expected " + std::to_string(expected_length)
+                              + ", found: " + std::to_string(len));
+    }
+    sketch.coupons_ = data + hll_constants::HASH_SET_INT_ARR_START;
+    sketch.num_coupon_slots_ = coupons_in_array;
+  } else { // HLL
+    if (pre_ints != hll_constants::HLL_PREINTS) {
+      throw std::invalid_argument("Incorrect number of preInts in input stream");
+    }
+    if (len < hll_constants::HLL_BYTE_ARR_START) {
+      throw std::out_of_range("Input data length insufficient to hold HLL array");
+    }
+    sketch.hll_array_bytes_ = HllArray<A>::hllArrBytes(sketch.tgt_type_, sketch.lg_config_k_);
+    if (len < static_cast<size_t>(hll_constants::HLL_BYTE_ARR_START + sketch.hll_array_bytes_)) {
+      throw std::out_of_range("Input array too small to hold sketch image");
+    }
+    sketch.cur_min_ = data[hll_constants::HLL_CUR_MIN_BYTE];
+    // the HIP estimate is not valid after out of order updates
+    if (!sketch.ooo_flag_) {
+      std::memcpy(&sketch.hip_accum_, data + hll_constants::HIP_ACCUM_DOUBLE, sizeof(double));
+    }
+    std::memcpy(&sketch.kxq0_, data + hll_constants::KXQ0_DOUBLE, sizeof(double));
+    std::memcpy(&sketch.kxq1_, data + hll_constants::KXQ1_DOUBLE, sizeof(double));
+    std::memcpy(&sketch.num_at_cur_min_, data + hll_constants::CUR_MIN_COUNT_INT, sizeof(uint32_t));
+    uint32_t aux_count;
+    std::memcpy(&aux_count, data + hll_constants::AUX_COUNT_INT, sizeof(uint32_t));
+    sketch.hll_array_ = data + hll_constants::HLL_BYTE_ARR_START;
+
+    if (aux_count > 0) { // necessarily HLL_4
+      const size_t offset = hll_constants::HLL_BYTE_ARR_START + sketch.hll_array_bytes_;
+      sketch.num_aux_slots_ = sketch.compact_ ? aux_count : 1 << data[hll_constants::LG_ARR_BYTE];
+      if (len - offset < sketch.num_aux_slots_ * sizeof(uint32_t)) {
+        throw std::out_of_range("Input array too small to hold AuxHashMap image");
+      }
+      sketch.aux_coupons_ = data + offset;
+    }
+  }
+  return sketch;
+}
+
+template<typename A>
+uint32_t wrapped_hll_sketch_alloc<A>::get_coupon(const uint8_t* coupons, uint32_t index) {
+  uint32_t coupon;
+  std::memcpy(&coupon, coupons + index * sizeof(uint32_t), sizeof(uint32_t));
+  return coupon;
+}
+
+template<typename A>
+double wrapped_hll_sketch_alloc<A>::get_estimate() const {
+  if (mode_ != HLL) { return CouponList<A>::estimate(coupon_count_); }
+  if (ooo_flag_) { return get_composite_estimate(); }
+  return hip_accum_;
+}
+
+template<typename A>
+double wrapped_hll_sketch_alloc<A>::get_composite_estimate() const {
+  if (mode_ != HLL) { return CouponList<A>::estimate(coupon_count_); }
+  return HllArray<A>::compositeEstimate(lg_config_k_, kxq0_, kxq1_, cur_min_, num_at_cur_min_);
+}
+
+template<typename A>
+double wrapped_hll_sketch_alloc<A>::get_lower_bound(uint8_t num_std_dev) const {
+  if (mode_ != HLL) { return CouponList<A>::lowerBound(coupon_count_, num_std_dev); }
+  return HllArray<A>::lowerBound(lg_config_k_, get_estimate(), ooo_flag_, cur_min_, num_at_cur_min_, num_std_dev);
+}
+
+template<typename A>
+double wrapped_hll_sketch_alloc<A>::get_upper_bound(uint8_t num_std_dev) const {
+  if (mode_ != HLL) { return CouponList<A>::upperBound(coupon_count_, num_std_dev); }
+  return HllArray<A>::upperBound(lg_config_k_, get_estimate(), ooo_flag_, num_std_dev);
+}
+
+template<typename A>
+uint8_t wrapped_hll_sketch_alloc<A>::get_lg_config_k() const {
+  return lg_config_k_;
+}
+
+template<typename A>
+target_hll_type wrapped_hll_sketch_alloc<A>::get_target_type() const {
+  return tgt_type_;
+}
+
+template<typename A>
+bool wrapped_hll_sketch_alloc<A>::is_compact() const {
+  return compact_;
+}
+
+template<typename A>
+bool wrapped_hll_sketch_alloc<A>::is_empty() const {
+  if (mode_ != HLL) { return coupon_count_ == 0; }
+  return cur_min_ == 0 && num_at_cur_min_ == (1u << lg_config_k_);
+}
+
+}
+
+#endif // _WRAPPEDHLLSKETCH_INTERNAL_HPP_
@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _CONCURRENT_HLL_HPP_
+#define _CONCURRENT_HLL_HPP_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hll.hpp"
+#include "HllEstimatorKernels.hpp"
+
+namespace datasketches {
+
+/// Concurrent HLL sketch alias with default allocator
+using concurrent_hll_sketch = concurrent_hll_sketch_alloc<std::allocator<uint8_t>>;
+
+/**
+ * HLL sketch that can be updated and queried from many threads at once.
+ *
+ * The registers are laid out as in HLL_8, one byte per register, and each register is
+ * an atomic updated with a compare-and-swap max with relaxed memory ordering. Most updates
+ * of a sketch past the first few thousand items do not raise the register and only read it,
+ * so threads rarely contend on the same cache line.
+ *
+ * The sketch is always in HLL mode: there are no LIST or SET modes, and there is no
+ * HIP accumulator, which depends on the order of the updates. The estimate is the composite
+ * estimate computed from a scan of the registers, as for the result of a union.
+ * Any query may run concurrently with updates and reflects some subset of the concurrent updates.
+ *
+ * A snapshot is converted to a regular hll_sketch by get_result(), which can then be serialized
+ * or given to hll_union. Only the move constructor must not run concurrently with other methods.
+ */
+template<typename A = std::allocator<uint8_t> >
+class concurrent_hll_sketch_alloc final {
+  public:
+    /**
+     * Constructs a new concurrent HLL sketch.
+     * @param lg_config_k Sketch can hold 2^lg_config_k rows
+     * @param allocator allocator to use by this instance
+     */
+    explicit concurrent_hll_sketch_alloc(uint8_t lg_config_k, const A& allocator = A());
+
+    /**
+     * Move constructor. Must not run concurrently with any other method of the source sketch.
+     * @param that sketch to be moved
+     */
+    concurrent_hll_sketch_alloc(concurrent_hll_sketch_alloc&& that) noexcept;
+
+    // The registers are shared by threads, get_result() gives a copy
+    concurrent_hll_sketch_alloc(const concurrent_hll_sketch_alloc&) = delete;
+    concurrent_hll_sketch_alloc& operator=(const concurrent_hll_sketch_alloc&) = delete;
+
+    /**
+     * Present the given std::string as a potential unique item. Safe to call from many threads.
+     * The string is converted to a byte array using UTF8 encoding.
+     * If the string is null or empty no update attempt is made and the method returns.
+     * @param datum The given string.
+     */
+    void update(const std::string& datum);
+
+    /**
+     * Present the given unsigned 64-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(uint64_t datum);
+
+    /**
+     * Present the given unsigned 32-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(uint32_t datum);
+
+    /**
+     * Present the given unsigned 16-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(uint16_t datum);
+
+    /**
+     * Present the given unsigned 8-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(uint8_t datum);
+
+    /**
+     * Present the given signed 64-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(int64_t datum);
+
+    /**
+     * Present the given signed 32-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(int32_t datum);
+
+    /**
+     * Present the given signed 16-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(int16_t datum);
+
+    /**
+     * Present the given signed 8-bit integer as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given integer.
+     */
+    void update(int8_t datum);
+
+    /**
+     * Present the given 64-bit floating point value as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given double.
+     */
+    void update(double datum);
+
+    /**
+     * Present the given 32-bit floating point value as a potential unique item.
+     * Safe to call from many threads.
+     * @param datum The given float.
+     */
+    void update(float datum);
+
+    /**
+     * Present the given data array as a potential unique item.
+     * Safe to call from many threads.
+     * @param data The given array.
+     * @param length_bytes The array length in bytes.
+     */
+    void update(const void* data, size_t length_bytes);
+
+    /**
+     * Returns the current cardinality estimate.
+     * This is the composite estimate computed from a scan of the registers.
+     * @return the cardinality estimate
+     */
+    double get_estimate() const;
+
+    /**
+     * Returns the approximate lower error bound given the specified
+     * number of standard deviations.
+     * @param num_std_dev Number of standard deviations, an integer from the set  {1, 2, 3}.
+     * @return The approximate lower bound.
+     */
+    double get_lower_bound(uint8_t num_std_dev) const;
+
+    /**
+     * Returns the approximate upper error bound given the specified
+     * number of standard deviations.
+     * @param num_std_dev Number of standard deviations, an integer from the set  {1, 2, 3}.
+     * @return The approximate upper bound.
+     */
+    double get_upper_bound(uint8_t num_std_dev) const;
+
+    /**
+     * Returns sketch's configured lg_k value.
+     * @return Configured lg_k value.
+     */
+    uint8_t get_lg_config_k() const;
+
+    /**
+     * Indicates if the sketch is currently empty.
+     * @return True if the sketch is empty.
+     */
+    bool is_empty() const;
+
+    /**
+     * Copies the current registers into a regular sketch.
+     * The result is in HLL mode unless this sketch is empty, and has the out of order flag set,
+     * so its estimate is the composite estimate, the same as the estimate of this sketch.
+     * @param tgt_type The type of the result
+     * @return a sketch with the registers of this sketch
+     */
+    hll_sketch_alloc<A> get_result(target_hll_type tgt_type = HLL_4) const;
+
+    /**
+     * @return allocator
+     */
+    A get_allocator() const;
+
+  private:
+    using AllocAtomic = typename std::allocator_traits<A>::template rebind_alloc<std::atomic<uint8_t>>;
+
+    A allocator_;
+    uint8_t lg_config_k_;
+    std::vector<std::atomic<uint8_t>, AllocAtomic> registers_;
+
+    void coupon_update(uint32_t coupon);
+    void hash_and_update(const void* data, size_t length_bytes);
+
+    // copies a range of registers with relaxed loads
+    void copy_registers(uint8_t* dst, uint32_t start, uint32_t num_registers) const;
+
+    // one pass over a snapshot of the registers, which may change during the pass
+    hll_estimator::register_stats get_register_stats() const;
+    double get_estimate(const hll_estimator::register_stats& stats) const;
+};
+
+} // namespace datasketches
+
+#include "ConcurrentHllSketch-internal.hpp"
+
+#endif // _CONCURRENT_HLL_HPP_
@@ -33,9 +33,13 @@ namespace datasketches {
 // forward declarations
 template<typename A> class hll_sketch_alloc;
 template<typename A> class hll_union_alloc;
+template<typename A> class wrapped_hll_sketch_alloc;
+template<typename A> class concurrent_hll_sketch_alloc;
 
 /// HLL sketch alias with default allocator
 using hll_sketch = hll_sketch_alloc<std::allocator<uint8_t>>;
+/// Wrapped HLL sketch alias with default allocator
+using wrapped_hll_sketch = wrapped_hll_sketch_alloc<std::allocator<uint8_t>>;
 /// HLL union alias with default allocator
 using hll_union = hll_union_alloc<std::allocator<uint8_t>>;
 
@@ -108,8 +112,9 @@ enum target_hll_type {
  * author Kevin Lang
  */
 
-// forward declaration
+// forward declarations
 template<typename A> class HllSketchImpl;
+template<typename A> class Hll8Array;
 
 template<typename A = std::allocator<uint8_t> >
 class hll_sketch_alloc final {
@@ -303,6 +308,26 @@ class hll_sketch_alloc final {
      */
     void update(const void* data, size_t length_bytes);
 
+    /**
+     * Present a batch of unsigned 64-bit integers as potential unique items.
+     * Equivalent to calling update(values[i]) for every value, but a block of values is hashed
+     * before the coupons are applied, and in HLL mode the registers are updated without
+     * a virtual call per item.
+     * @param values pointer to the array of values
+     * @param num_values number of values in the batch
+     */
+    void update_batch(const uint64_t* values, size_t num_values);
+
+    /**
+     * Present a batch of strings as potential unique items.
+     * Equivalent to calling update(values[i]) for every string, but a block of strings is hashed
+     * before the coupons are applied, and in HLL mode the registers are updated without
+     * a virtual call per item.
+     * @param values pointer to the array of strings
+     * @param num_values number of strings in the batch
+     */
+    void update_batch(const std::string* values, size_t num_values);
+
     /**
      * Returns the current cardinality estimate
      * @return the cardinality estimate
@@ -403,7 +428,20 @@ class hll_sketch_alloc final {
   private:
     explicit hll_sketch_alloc(HllSketchImpl<A>* that);
 
+    static const size_t BATCH_SIZE = 256; // values hashed ahead of the coupon updates by update_batch
+
     void coupon_update(uint32_t coupon);
+    void coupon_update_batch(const uint32_t* coupons, size_t num_coupons);
+
+    template<typename T>
+    void update_batch_impl(const T* values, size_t num_values);
+
+    static const void* value_data(const uint64_t& value) { return &value; }
+    static size_t value_size(const uint64_t& value) { return sizeof(value); }
+    static bool is_ignored(const uint64_t&) { return false; }
+    static const void* value_data(const std::string& value) { return value.c_str(); }
+    static size_t value_size(const std::string& value) { return value.length(); }
+    static bool is_ignored(const std::string& value) { return value.empty(); }
 
     std::string type_as_string() const;
     std::string mode_as_string() const;
@@ -415,6 +453,108 @@ class hll_sketch_alloc final {
 
     HllSketchImpl<A>* sketch_impl;
     friend hll_union_alloc<A>;
+    friend concurrent_hll_sketch_alloc<A>;
+};
+
+/**
+ * Wrapped HLL sketch.
+ * This is a read-only view of a buffer containing a serialized HLL sketch in any mode, target type
+ * and form (compact or updatable). Only the preamble is read when wrapping. Estimates and bounds are
+ * computed from the values stored in the preamble, and a union reads the coupons or registers
+ * from the buffer. No memory is allocated.
+ * It does not take the ownership of the buffer, which must remain valid while the view is used.
+ */
+template<typename A = std::allocator<uint8_t> >
+class wrapped_hll_sketch_alloc {
+  public:
+    /**
+     * Wraps a serialized HLL sketch.
+     * @param bytes pointer to the serialized image
+     * @param len length of the image, in bytes
+     * @return a view of the sketch
+     */
+    static const wrapped_hll_sketch_alloc wrap(const void* bytes, size_t len);
+
+    /**
+     * Returns the current cardinality estimate
+     * @return the cardinality estimate
+     */
+    double get_estimate() const;
+
+    /**
+     * This is less accurate than the get_estimate() method and is used
+     * when the sketch has gone through union operations.
+     * @return the composite cardinality estimate
+     */
+    double get_composite_estimate() const;
+
+    /**
+     * Returns the approximate lower error bound given the specified
+     * number of standard deviations.
+     * @param num_std_dev Number of standard deviations, an integer from the set  {1, 2, 3}.
+     * @return The approximate lower bound.
+     */
+    double get_lower_bound(uint8_t num_std_dev) const;
+
+    /**
+     * Returns the approximate upper error bound given the specified
+     * number of standard deviations.
+     * @param num_std_dev Number of standard deviations, an integer from the set  {1, 2, 3}.
+     * @return The approximate upper bound.
+     */
+    double get_upper_bound(uint8_t num_std_dev) const;
+
+    /**
+     * Returns sketch's configured lg_k value.
+     * @return Configured lg_k value.
+     */
+    uint8_t get_lg_config_k() const;
+
+    /**
+     * Returns the sketch's target HLL mode (from #target_hll_type).
+     * @return The sketch's target HLL mode.
+     */
+    target_hll_type get_target_type() const;
+
+    /**
+     * Indicates if the image is in compact form.
+     * @return True if the image is in compact form.
+     */
+    bool is_compact() const;
+
+    /**
+     * Indicates if the sketch is empty.
+     * @return True if the sketch is empty.
+     */
+    bool is_empty() const;
+
+  private:
+    wrapped_hll_sketch_alloc();
+
+    static uint32_t get_coupon(const uint8_t* coupons, uint32_t index);
+
+    hll_mode mode_;
+    target_hll_type tgt_type_;
+    uint8_t lg_config_k_;
+    bool compact_;
+    bool ooo_flag_;
+    bool start_full_size_;
+    // LIST and SET modes: coupons in a list or a hash table, empty slots are skipped
+    uint32_t coupon_count_;
+    const uint8_t* coupons_;
+    uint32_t num_coupon_slots_;
+    // HLL mode
+    uint8_t cur_min_;
+    uint32_t num_at_cur_min_;
+    double hip_accum_;
+    double kxq0_;
+    double kxq1_;
+    const uint8_t* hll_array_;
+    uint32_t hll_array_bytes_;
+    const uint8_t* aux_coupons_;
+    uint32_t num_aux_slots_;
+
+    friend hll_union_alloc<A>;
 };
 
 /**
@@ -531,6 +671,13 @@ class hll_union_alloc {
      * @param sketch The given sketch.
      */
     void update(hll_sketch_alloc<A>&& sketch);
+
+    /**
+     * Update this union operator with the given wrapped sketch.
+     * The coupons or registers are read from the wrapped image without deserializing it.
+     * @param sketch The given wrapped sketch.
+     */
+    void update(const wrapped_hll_sketch_alloc<A>& sketch);
   
     /**
      * Present the given std::string as a potential unique item.
@@ -607,6 +754,22 @@ class hll_union_alloc {
      */
     void update(const void* data, size_t length_bytes);
 
+    /**
+     * Present a batch of unsigned 64-bit integers as potential unique items.
+     * Equivalent to calling update(values[i]) for every value.
+     * @param values pointer to the array of values
+     * @param num_values number of values in the batch
+     */
+    void update_batch(const uint64_t* values, size_t num_values);
+
+    /**
+     * Present a batch of strings as potential unique items.
+     * Equivalent to calling update(values[i]) for every string.
+     * @param values pointer to the array of strings
+     * @param num_values number of strings in the batch
+     */
+    void update_batch(const std::string* values, size_t num_values);
+
     /**
      * Gets the current (approximate) Relative Error (RE) asymptotic values given several
      * parameters. This is used primarily for testing.
@@ -635,6 +798,9 @@ class hll_union_alloc {
 
     static HllSketchImpl<A>* copy_or_downsample(const HllSketchImpl<A>* src_impl, uint8_t tgt_lg_k);
 
+    // merges the registers of a wrapped sketch in HLL mode
+    static void merge_wrapped_hll(Hll8Array<A>& dst, const wrapped_hll_sketch_alloc<A>& src);
+
     void coupon_update(uint32_t coupon);
 
     hll_mode get_current_mode() const;
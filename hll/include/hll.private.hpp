@@ -27,6 +27,7 @@
 #include "HllSketch-internal.hpp"
 #include "HllSketchImpl-internal.hpp"
 #include "HllUnion-internal.hpp"
+#include "WrappedHllSketch-internal.hpp"
 #include "coupon_iterator-internal.hpp"
 
 #endif // _HLL_PRIVATE_HPP_
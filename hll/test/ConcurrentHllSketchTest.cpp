@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_hll.hpp"
+
+namespace datasketches {
+
+// registers of a sketch in HLL mode, one byte per register
+static std::vector<uint8_t> get_registers(const hll_sketch& sketch) {
+  const auto bytes = hll_sketch(sketch, HLL_8).serialize_updatable();
+  return std::vector<uint8_t>(bytes.begin() + hll_constants::HLL_BYTE_ARR_START, bytes.end());
+}
+
+TEST_CASE("concurrent hll sketch: invalid lg_k", "[concurrent_hll_sketch]") {
+  REQUIRE_THROWS_AS(concurrent_hll_sketch(3), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_hll_sketch(22), std::invalid_argument);
+}
+
+TEST_CASE("concurrent hll sketch: empty", "[concurrent_hll_sketch]") {
+  concurrent_hll_sketch sketch(10);
+  REQUIRE(sketch.is_empty());
+  REQUIRE(sketch.get_lg_config_k() == 10);
+  REQUIRE(sketch.get_estimate() == 0);
+  REQUIRE(sketch.get_lower_bound(1) == 0);
+  REQUIRE(sketch.get_upper_bound(1) == 0);
+  sketch.update("");
+  sketch.update(nullptr, 0);
+  REQUIRE(sketch.is_empty());
+
+  const auto result = sketch.get_result(HLL_6);
+  REQUIRE(result.is_empty());
+  REQUIRE(result.get_lg_config_k() == 10);
+  REQUIRE(result.get_target_type() == HLL_6);
+}
+
+TEST_CASE("concurrent hll sketch: matches union of the same items", "[concurrent_hll_sketch]") {
+  // the composite estimate of a union of one sketch comes from the same registers
+  for (const uint8_t lg_k: {4, 10, 14}) {
+    for (const int n: {1, 100, 10000, 1000000}) {
+      concurrent_hll_sketch sketch(lg_k);
+      hll_sketch expected_sketch(lg_k, HLL_8, true);
+      for (int i = 0; i < n; ++i) {
+        sketch.update(i);
+        expected_sketch.update(i);
+      }
+      hll_union expected(lg_k);
+      expected.update(expected_sketch);
+      REQUIRE_FALSE(sketch.is_empty());
+      REQUIRE(sketch.get_estimate() == Approx(expected.get_composite_estimate()).epsilon(1e-12));
+
+      for (const auto type: {HLL_4, HLL_6, HLL_8}) {
+        const auto result = sketch.get_result(type);
+        REQUIRE(result.get_target_type() == type);
+        REQUIRE(result.get_lg_config_k() == lg_k);
+        // the result is out of order like this sketch, so the bounds are the same
+        REQUIRE(result.get_estimate() == Approx(sketch.get_estimate()).epsilon(1e-12));
+        REQUIRE(result.get_lower_bound(2) == Approx(sketch.get_lower_bound(2)).epsilon(1e-12));
+        REQUIRE(result.get_upper_bound(2) == Approx(sketch.get_upper_bound(2)).epsilon(1e-12));
+        REQUIRE(get_registers(result) == get_registers(expected_sketch));
+      }
+    }
+  }
+}
+
+TEST_CASE("concurrent hll sketch: input types", "[concurrent_hll_sketch]") {
+  concurrent_hll_sketch sketch(8);
+  hll_sketch expected(8, HLL_8, true);
+  sketch.update((uint8_t) 255);
+  sketch.update((int16_t) -2);
+  sketch.update((uint32_t) 3);
+  sketch.update((float) -0.0);
+  sketch.update(std::nan("9"));
+  sketch.update(std::string("input string"));
+  const char data[] = {1, 2, 3};
+  sketch.update(data, sizeof(data));
+  expected.update((int8_t) -1);
+  expected.update((int64_t) -2);
+  expected.update((int32_t) 3);
+  expected.update(0.0);
+  expected.update(std::nanf("3"));
+  expected.update(std::string("input string"));
+  expected.update(data, sizeof(data));
+  REQUIRE(get_registers(sketch.get_result()) == get_registers(expected));
+}
+
+TEST_CASE("concurrent hll sketch: concurrent updates", "[concurrent_hll_sketch]") {
+  concurrent_hll_sketch sketch(12);
+  const size_t num_threads = 4;
+  const uint64_t n = 100000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    // overlapping ranges, items are seen by more than one thread
+    threads.emplace_back([&sketch, t, n]() {
+      for (uint64_t i = 0; i < n; ++i) sketch.update(t * n / 2 + i);
+    });
+  }
+  // queries may run at the same time
+  for (int i = 0; i < 10; ++i) {
+    REQUIRE(sketch.get_estimate() >= 0);
+    sketch.get_result();
+  }
+  for (auto& thread: threads) thread.join();
+
+  // registers only grow, so the result does not depend on the interleaving
+  hll_sketch expected(12, HLL_8);
+  for (uint64_t i = 0; i < (num_threads + 1) * n / 2; ++i) expected.update(i);
+  REQUIRE(get_registers(sketch.get_result()) == get_registers(expected));
+  REQUIRE(sketch.get_estimate() == Approx((num_threads + 1) * n / 2).epsilon(0.05));
+}
+
+TEST_CASE("concurrent hll sketch: move", "[concurrent_hll_sketch]") {
+  concurrent_hll_sketch sketch(10);
+  for (int i = 0; i < 1000; ++i) sketch.update(i);
+  const double estimate = sketch.get_estimate();
+  concurrent_hll_sketch moved(std::move(sketch));
+  REQUIRE(moved.get_estimate() == estimate);
+}
+
+} /* namespace datasketches */
@@ -18,10 +18,16 @@
  */
 
 #include "hll.hpp"
+#include "HllEstimatorKernels.hpp"
+#include "HllMergeKernels.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <exception>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 #include <catch2/catch.hpp>
 
 namespace datasketches {
@@ -189,4 +195,87 @@ TEST_CASE("hll array: check corrupt stream", "[hll_array]") {
   ss.put((char)tmp);
 }
 
+TEST_CASE("hll array: merge kernels", "[hll_array]") {
+  std::mt19937 gen(123);
+  for (uint32_t num_slots = 4; num_slots <= 1024; num_slots = num_slots * 2 + 4) {
+    std::vector<uint8_t> tgt(num_slots);
+    std::vector<uint8_t> values(num_slots);
+    for (auto& value: tgt) value = gen() % 64;
+    for (auto& value: values) value = gen() % 64;
+    std::vector<uint8_t> expected(num_slots);
+
+    // HLL_8
+    for (uint32_t i = 0; i < num_slots; ++i) expected[i] = std::max(tgt[i], values[i]);
+    for (const auto level: {simd_ops::SCALAR, simd_ops::get_simd_level()}) {
+      auto result = tgt;
+      hll_merge::max_hll8(result.data(), values.data(), num_slots, level);
+      REQUIRE(result == expected);
+    }
+
+    // HLL_6: 4 values in 3 bytes, plus a byte at the end
+    std::vector<uint8_t> hll6(num_slots / 4 * 3 + 1);
+    for (uint32_t i = 0; i < num_slots; i += 4) {
+      const uint32_t word = values[i] | (values[i + 1] << 6) | (values[i + 2] << 12) | (values[i + 3] << 18);
+      hll6[i / 4 * 3] = word & 0xff;
+      hll6[i / 4 * 3 + 1] = (word >> 8) & 0xff;
+      hll6[i / 4 * 3 + 2] = word >> 16;
+    }
+    for (const auto level: {simd_ops::SCALAR, simd_ops::get_simd_level()}) {
+      auto result = tgt;
+      hll_merge::max_hll6(result.data(), hll6.data(), num_slots, hll6.size(), level);
+      REQUIRE(result == expected);
+    }
+
+    // HLL_4: nibbles relative to cur_min, the aux token leaves the target as is
+    const uint8_t cur_min = 3;
+    std::vector<uint8_t> hll4(num_slots / 2);
+    for (uint32_t i = 0; i < num_slots; ++i) {
+      const uint8_t nibble = gen() % 16;
+      hll4[i / 2] |= i % 2 == 0 ? nibble : nibble << 4;
+      expected[i] = nibble == hll_constants::AUX_TOKEN ? tgt[i] : std::max<uint8_t>(tgt[i], nibble + cur_min);
+    }
+    for (const auto level: {simd_ops::SCALAR, simd_ops::get_simd_level()}) {
+      auto result = tgt;
+      hll_merge::max_hll4(result.data(), hll4.data(), num_slots, cur_min, level);
+      REQUIRE(result == expected);
+    }
+  }
+}
+
+TEST_CASE("hll array: estimator kernels", "[hll_array]") {
+  std::mt19937 gen(456);
+  // sizes below and above the chunk size, with and without a tail that is not a multiple of the vector size
+  for (const uint32_t num_slots: {4u, 64u, 100u, 4096u, 4100u, 10000u, 16384u}) {
+    for (const uint8_t min_value: {0, 5}) {
+      std::vector<uint8_t> values(num_slots);
+      for (auto& value: values) value = min_value + gen() % (32 - min_value);
+      double sum = 0;
+      for (const auto value: values) sum += std::ldexp(1.0, -value);
+      const uint8_t min = *std::min_element(values.begin(), values.end());
+      const uint8_t max = *std::max_element(values.begin(), values.end());
+      const uint32_t num_at_min = static_cast<uint32_t>(std::count(values.begin(), values.end(), min));
+
+      std::vector<uint8_t> hll6(num_slots / 4 * 3 + 1);
+      for (uint32_t i = 0; i < num_slots; i += 4) {
+        const uint32_t word = values[i] | (values[i + 1] << 6) | (values[i + 2] << 12) | (values[i + 3] << 18);
+        hll6[i / 4 * 3] = word & 0xff;
+        hll6[i / 4 * 3 + 1] = (word >> 8) & 0xff;
+        hll6[i / 4 * 3 + 2] = word >> 16;
+      }
+
+      for (const auto level: {simd_ops::SCALAR, simd_ops::get_simd_level()}) {
+        const auto stats8 = hll_estimator::get_hll8_stats(values.data(), num_slots, level);
+        const auto stats6 = hll_estimator::get_hll6_stats(hll6.data(), num_slots, hll6.size(), level);
+        for (const auto& stats: {stats8, stats6}) {
+          // exact for values below 32
+          REQUIRE(stats.sum == sum);
+          REQUIRE(stats.min == min);
+          REQUIRE(stats.max == max);
+          REQUIRE(stats.num_at_min == num_at_min);
+        }
+      }
+    }
+  }
+}
+
 } /* namespace datasketches */
@@ -18,6 +18,8 @@
  */
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "hll.hpp"
 
@@ -289,6 +291,43 @@ TEST_CASE("hll sketch: check input types", "[hll_sketch]") {
   REQUIRE(test_allocator_total_bytes == 0);
 }
 
+TEST_CASE("hll sketch: batch update", "[hll_sketch]") {
+  // covers promotions LIST -> SET -> HLL within a batch, lg_k < 8 promotes LIST directly to HLL
+  for (auto type: {target_hll_type::HLL_4, target_hll_type::HLL_6, target_hll_type::HLL_8}) {
+    for (uint8_t lg_k: {4, 10}) {
+      for (size_t n: {0, 1, 7, 100, 1000, 50000}) {
+        hll_sketch single(lg_k, type);
+        hll_sketch batch(lg_k, type);
+        std::vector<uint64_t> values(n);
+        for (size_t i = 0; i < n; ++i) {
+          values[i] = i % 30000;
+          single.update(values[i]);
+        }
+        batch.update_batch(values.data(), values.size());
+        REQUIRE(batch.get_estimate() == single.get_estimate());
+        REQUIRE(batch.serialize_updatable() == single.serialize_updatable());
+      }
+    }
+  }
+}
+
+TEST_CASE("hll sketch: batch update strings", "[hll_sketch]") {
+  hll_sketch single(10, target_hll_type::HLL_4);
+  hll_sketch batch(10, target_hll_type::HLL_4);
+  std::vector<std::string> values;
+  for (int i = 0; i < 10000; ++i) values.push_back(i % 100 == 0 ? "" : std::to_string(i));
+  for (const auto& value: values) single.update(value);
+  batch.update_batch(values.data(), values.size());
+  REQUIRE(batch.get_estimate() == single.get_estimate());
+  REQUIRE(batch.serialize_updatable() == single.serialize_updatable());
+
+  // empty strings are ignored
+  hll_sketch sketch(10);
+  const std::string empty[] = {"", ""};
+  sketch.update_batch(empty, 2);
+  REQUIRE(sketch.is_empty());
+}
+
 TEST_CASE("hll sketch: deserialize list mode buffer overrun", "[hll_sketch]") {
   test_allocator_total_bytes = 0;
   {
@@ -20,6 +20,8 @@
 #include <catch2/catch.hpp>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "hll.hpp"
 
@@ -295,6 +297,25 @@ TEST_CASE("hll union: check input types", "[hll_union]") {
   REQUIRE(u.is_empty());
 }
 
+TEST_CASE("hll union: batch update", "[hll_union]") {
+  hll_union single(10);
+  hll_union batch(10);
+  std::vector<uint64_t> values(50000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i;
+    single.update(values[i]);
+  }
+  batch.update_batch(values.data(), values.size());
+  REQUIRE(batch.get_estimate() == single.get_estimate());
+  REQUIRE(batch.get_result(HLL_8).serialize_compact() == single.get_result(HLL_8).serialize_compact());
+
+  std::vector<std::string> strings;
+  for (int i = 0; i < 1000; ++i) strings.push_back(std::to_string(i));
+  for (const auto& value: strings) single.update(value);
+  batch.update_batch(strings.data(), strings.size());
+  REQUIRE(batch.get_estimate() == single.get_estimate());
+}
+
 static void union_two_sketches_with_overlap(int num, uint8_t lg_k, target_hll_type type) {
   hll_sketch sketch1(lg_k, type);
   for (int key = 0; key < num; key++) sketch1.update(key);
@@ -314,4 +335,32 @@ TEST_CASE("hll union: check hll to hll", "[hll_union]") {
   union_two_sketches_with_overlap(1000000, 11, HLL_4);
 }
 
+TEST_CASE("hll union: merge hll arrays of all types", "[hll_union]") {
+  // sources with values above curMin + 14 put exceptions into the aux hash map of HLL_4
+  const target_hll_type types[] = {HLL_4, HLL_6, HLL_8};
+  for (const auto type: types) {
+    for (uint8_t src_lg_k = 10; src_lg_k <= 12; src_lg_k += 2) {
+      for (uint8_t lg_max_k = 7; lg_max_k <= src_lg_k; ++lg_max_k) {
+        hll_sketch sk1(src_lg_k, type);
+        hll_sketch sk2(src_lg_k, type);
+        for (int i = 0; i < 100000; ++i) sk1.update(i);
+        for (int i = 50000; i < 200000; ++i) sk2.update(i);
+        // the same values built directly as HLL_8
+        hll_sketch sk1_hll8(src_lg_k, HLL_8);
+        hll_sketch sk2_hll8(src_lg_k, HLL_8);
+        for (int i = 0; i < 100000; ++i) sk1_hll8.update(i);
+        for (int i = 50000; i < 200000; ++i) sk2_hll8.update(i);
+
+        hll_union u(lg_max_k);
+        u.update(sk1);
+        u.update(sk2);
+        hll_union expected(lg_max_k);
+        expected.update(sk1_hll8);
+        expected.update(sk2_hll8);
+        REQUIRE(u.get_result(HLL_8).serialize_compact() == expected.get_result(HLL_8).serialize_compact());
+      }
+    }
+  }
+}
+
 } /* namespace datasketches */
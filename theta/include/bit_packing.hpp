@@ -20,7 +20,13 @@
 #ifndef BIT_PACKING_HPP_
 #define BIT_PACKING_HPP_
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "simd_ops.hpp"
 
 namespace datasketches {
 
@@ -6274,6 +6280,166 @@ static inline void unpack_bits_block8(uint64_t* values, const uint8_t* ptr, uint
   }
 }
 
+/*
+ * Decoding of runs of blocks with running sum of deltas.
+ *
+ * Value i of a block of 8 starts at bit i * bits, so it can be extracted from the big-endian
+ * 8-byte word at byte (i * bits) / 8 with two shifts if it fits into that word (bits <= 57).
+ * These word loads read up to 7 bytes past the end of a block, so they are used only
+ * for blocks followed by enough readable memory. Other blocks use unpack_bits_block8().
+ */
+
+// the widest value that fits into an 8-byte word at any bit offset within the first byte
+static const uint8_t MAX_WORD_UNPACK_BITS = 57;
+
+static inline uint64_t load_big_endian64(const uint8_t* ptr) {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  uint64_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return __builtin_bswap64(value);
+#else
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) value = (value << 8) | ptr[i];
+  return value;
+#endif
+}
+
+// number of leading blocks that can be decoded with word loads without reading at or past end
+static inline uint32_t num_word_unpack_blocks(const uint8_t* ptr, uint8_t bits, uint32_t num_blocks, const uint8_t* end) {
+  if (bits > MAX_WORD_UNPACK_BITS) return 0;
+  // the last word of a block starts at byte (7 * bits) / 8
+  const size_t readable_bytes = end - ptr;
+  const size_t last_word_end = (7 * bits) / 8 + 8;
+  if (readable_bytes < last_word_end) return 0;
+  return static_cast<uint32_t>(std::min<size_t>(num_blocks, (readable_bytes - last_word_end) / bits + 1));
+}
+
+static inline uint64_t unpack_deltas_block8_scalar(uint64_t* values, const uint8_t* ptr, uint8_t bits, uint32_t num_blocks,
+    uint64_t previous) {
+  for (uint32_t b = 0; b < num_blocks; ++b) {
+    unpack_bits_block8(values, ptr, bits);
+    for (int i = 0; i < 8; ++i) {
+      values[i] += previous;
+      previous = values[i];
+    }
+    values += 8;
+    ptr += bits;
+  }
+  return previous;
+}
+
+static inline uint64_t unpack_deltas_words(uint64_t* values, const uint8_t* ptr, uint8_t bits, uint32_t num_blocks,
+    uint64_t previous) {
+  uint32_t offsets[8];
+  uint8_t shifts[8];
+  for (int i = 0; i < 8; ++i) {
+    offsets[i] = (i * bits) >> 3;
+    shifts[i] = (i * bits) & 7;
+  }
+  const uint8_t right_shift = 64 - bits;
+  for (uint32_t b = 0; b < num_blocks; ++b) {
+    for (int i = 0; i < 8; ++i) {
+      previous += (load_big_endian64(ptr + offsets[i]) << shifts[i]) >> right_shift;
+      values[i] = previous;
+    }
+    values += 8;
+    ptr += bits;
+  }
+  return previous;
+}
+
+#ifdef DATASKETCHES_SIMD_X86
+
+// The shifts are done in vectors, the loads and the running sum are done per lane.
+// Wider vectors gain nothing here since extracting their lanes for the running sum costs more,
+// so AVX-512 capable processors use this version too.
+
+typedef simd_ops::vector_of<uint64_t, 32>::type uint64x4_t;
+
+static DATASKETCHES_TARGET_AVX2 inline uint64_t unpack_deltas_avx2(uint64_t* values, const uint8_t* ptr, uint8_t bits,
+    uint32_t num_blocks, uint64_t previous) {
+  uint32_t offsets[8];
+  uint64_t shifts[8];
+  for (int i = 0; i < 8; ++i) {
+    offsets[i] = (i * bits) >> 3;
+    shifts[i] = (i * bits) & 7;
+  }
+  const uint64x4_t left_shifts_lo = {shifts[0], shifts[1], shifts[2], shifts[3]};
+  const uint64x4_t left_shifts_hi = {shifts[4], shifts[5], shifts[6], shifts[7]};
+  const uint64_t right_shift = 64 - bits;
+  for (uint32_t b = 0; b < num_blocks; ++b) {
+    uint64x4_t lo = {load_big_endian64(ptr + offsets[0]), load_big_endian64(ptr + offsets[1]),
+        load_big_endian64(ptr + offsets[2]), load_big_endian64(ptr + offsets[3])};
+    uint64x4_t hi = {load_big_endian64(ptr + offsets[4]), load_big_endian64(ptr + offsets[5]),
+        load_big_endian64(ptr + offsets[6]), load_big_endian64(ptr + offsets[7])};
+    lo = (lo << left_shifts_lo) >> right_shift;
+    hi = (hi << left_shifts_hi) >> right_shift;
+    values[0] = previous += lo[0];
+    values[1] = previous += lo[1];
+    values[2] = previous += lo[2];
+    values[3] = previous += lo[3];
+    values[4] = previous += hi[0];
+    values[5] = previous += hi[1];
+    values[6] = previous += hi[2];
+    values[7] = previous += hi[3];
+    values += 8;
+    ptr += bits;
+  }
+  return previous;
+}
+
+#endif // DATASKETCHES_SIMD_X86
+
+/**
+ * Unpacks consecutive blocks of 8 deltas packed by pack_bits_block8() and restores the values
+ * by a running sum. The result is the same as unpack_bits_block8() followed by the running sum.
+ * @param values array of num_blocks * 8 values to write
+ * @param ptr pointer to the packed blocks of num_blocks * bits bytes
+ * @param bits number of bits per delta, from 1 to 63
+ * @param num_blocks number of blocks
+ * @param previous value to add to the first delta
+ * @param end end of the readable memory after ptr, not less than the end of the last block
+ * @param level instruction set to use
+ * @return the last value
+ */
+static inline uint64_t unpack_deltas_block8(uint64_t* values, const uint8_t* ptr, uint8_t bits, uint32_t num_blocks,
+    uint64_t previous, const uint8_t* end, simd_ops::simd_level level = simd_ops::get_simd_level()) {
+  const uint32_t num_word_blocks = num_word_unpack_blocks(ptr, bits, num_blocks, end);
+#ifdef DATASKETCHES_SIMD_X86
+  if (level != simd_ops::SCALAR) {
+    previous = unpack_deltas_avx2(values, ptr, bits, num_word_blocks, previous);
+  } else {
+    previous = unpack_deltas_words(values, ptr, bits, num_word_blocks, previous);
+  }
+#else
+  (void) level;
+  previous = unpack_deltas_words(values, ptr, bits, num_word_blocks, previous);
+#endif
+  return unpack_deltas_block8_scalar(values + num_word_blocks * 8, ptr + num_word_blocks * bits, bits,
+      num_blocks - num_word_blocks, previous);
+}
+
+/**
+ * Unpacks deltas packed in blocks of 8 followed by fewer than 8 deltas packed by pack_bits(),
+ * as in compressed compact Theta sketches, and restores the values by a running sum from zero.
+ * @param values array of num_values values to write
+ * @param ptr pointer to the packed deltas
+ * @param bits number of bits per delta, from 1 to 63
+ * @param num_values number of values
+ * @param end end of the readable memory after ptr, not less than the end of the packed deltas
+ */
+static inline void unpack_deltas(uint64_t* values, const uint8_t* ptr, uint8_t bits, uint32_t num_values, const uint8_t* end) {
+  const uint32_t num_blocks = num_values / 8;
+  uint64_t previous = unpack_deltas_block8(values, ptr, bits, num_blocks, 0, end);
+  ptr += num_blocks * bits;
+  uint8_t offset = 0;
+  for (uint32_t i = num_blocks * 8; i < num_values; ++i) {
+    offset = unpack_bits(values[i], bits, ptr, offset);
+    values[i] += previous;
+    previous = values[i];
+  }
+}
+
 } // namespace
 
 #endif // BIT_PACKING_HPP_
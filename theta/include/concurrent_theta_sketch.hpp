@@ -0,0 +1,350 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CONCURRENT_THETA_SKETCH_HPP_
+#define CONCURRENT_THETA_SKETCH_HPP_
+
+#include <atomic>
+#include <mutex>
+
+#include "theta_sketch.hpp"
+#include "theta_union_base.hpp"
+
+namespace datasketches {
+
+// forward declaration
+template<typename A> class concurrent_theta_sketch_alloc;
+
+// alias with default allocator for convenience
+using concurrent_theta_sketch = concurrent_theta_sketch_alloc<std::allocator<uint64_t>>;
+
+/**
+ * Theta sketch that can be updated from many threads at once.
+ *
+ * Each updating thread owns a writer with a small local buffer of hashes.
+ * The writer screens incoming hashes by the theta of the shared sketch and propagates
+ * the buffer into the shared sketch under a lock once it holds enough hashes.
+ * The shared theta and estimate are published in atomics after every propagation,
+ * so get_estimate() and get_theta() never block and never see a partially applied buffer.
+ *
+ * The error added by buffering is bounded: a writer propagates before it holds more than
+ * max_concurrency_error times the shared estimate (at least 1, at most 2^local_lg_k) hashes,
+ * so the shared estimate misses at most that many distinct values per active writer.
+ * Writers propagate what is left in their buffers on flush() and on destruction.
+ *
+ * All methods of the shared sketch may be called concurrently with writers,
+ * except for the move constructor. A writer must be used by one thread at a time
+ * and must not outlive its shared sketch.
+ * There is no constructor. Use builder instead.
+ */
+template<typename Allocator = std::allocator<uint64_t>>
+class concurrent_theta_sketch_alloc {
+public:
+  using Entry = uint64_t;
+  using ExtractKey = trivial_extract_key;
+  using CompactSketch = compact_theta_sketch_alloc<Allocator>;
+  using theta_table = theta_update_sketch_base<Entry, ExtractKey, Allocator>;
+  using resize_factor = typename theta_table::resize_factor;
+
+  static const uint8_t DEFAULT_LOCAL_LG_K = 4;
+  static constexpr double DEFAULT_MAX_CONCURRENCY_ERROR = 0.01;
+
+  // No constructor here. Use builder instead.
+  class builder;
+  class writer;
+
+  /**
+   * Move constructor. Must not run concurrently with any other method of the source sketch
+   * and invalidates writers of the source sketch.
+   * @param other sketch to be moved
+   */
+  concurrent_theta_sketch_alloc(concurrent_theta_sketch_alloc&& other) noexcept;
+
+  // The state is shared by threads, get_result() gives a copy
+  concurrent_theta_sketch_alloc(const concurrent_theta_sketch_alloc&) = delete;
+  concurrent_theta_sketch_alloc& operator=(const concurrent_theta_sketch_alloc&) = delete;
+
+  /**
+   * @return allocator
+   */
+  Allocator get_allocator() const;
+
+  /**
+   * @return configured nominal number of entries in the sketch
+   */
+  uint8_t get_lg_k() const;
+
+  /**
+   * @return configured base 2 logarithm of the maximum size of the local buffers of writers
+   */
+  uint8_t get_local_lg_k() const;
+
+  /**
+   * @return configured maximum error relative to the estimate added by each writer
+   */
+  double get_max_concurrency_error() const;
+
+  /**
+   * @return hash of the seed that was used to hash the input
+   */
+  uint16_t get_seed_hash() const;
+
+  /**
+   * Lock-free. Reflects the propagated updates only.
+   * @return true if this sketch represents an empty set (not the same as no retained entries!)
+   */
+  bool is_empty() const;
+
+  /**
+   * Lock-free. Reflects the propagated updates only.
+   * @return theta as a positive integer between 0 and LLONG_MAX
+   */
+  uint64_t get_theta64() const;
+
+  /**
+   * Lock-free. Reflects the propagated updates only.
+   * @return theta as a fraction from 0 to 1 (effective sampling rate)
+   */
+  double get_theta() const;
+
+  /**
+   * Lock-free. Reflects the propagated updates only.
+   * @return the number of retained entries in the shared sketch
+   */
+  uint32_t get_num_retained() const;
+
+  /**
+   * Lock-free. Reflects the propagated updates only.
+   * @return estimate of the distinct count of the input stream
+   */
+  double get_estimate() const;
+
+  /**
+   * Returns the approximate lower error bound given a number of standard deviations.
+   * This parameter is similar to the number of standard deviations of the normal distribution
+   * and corresponds to approximately 67%, 95% and 99% confidence intervals.
+   * Takes the lock of the shared sketch.
+   * @param num_std_devs number of Standard Deviations (1, 2 or 3)
+   * @return the lower bound
+   */
+  double get_lower_bound(uint8_t num_std_devs) const;
+
+  /**
+   * Returns the approximate upper error bound given a number of standard deviations.
+   * This parameter is similar to the number of standard deviations of the normal distribution
+   * and corresponds to approximately 67%, 95% and 99% confidence intervals.
+   * Takes the lock of the shared sketch.
+   * @param num_std_devs number of Standard Deviations (1, 2 or 3)
+   * @return the upper bound
+   */
+  double get_upper_bound(uint8_t num_std_devs) const;
+
+  /**
+   * Produces a copy of the propagated state as a compact sketch.
+   * Takes the lock of the shared sketch.
+   * @param ordered optional flag to specify if an ordered sketch should be produced
+   * @return compact sketch
+   */
+  CompactSketch get_result(bool ordered = true) const;
+
+private:
+  // there is no payload in Theta sketch entry
+  struct nop_policy {
+    void operator()(uint64_t internal_entry, uint64_t incoming_entry) const {
+      unused(internal_entry);
+      unused(incoming_entry);
+    }
+  };
+  using State = theta_union_base<Entry, ExtractKey, nop_policy, theta_sketch_alloc<Allocator>, CompactSketch, Allocator>;
+
+  // Hashes held by a writer, with the part of the sketch interface that the union of the shared state takes.
+  // The table is sized so that it never rebuilds: it is propagated before it reaches 2^lg_k entries.
+  class local_buffer {
+  public:
+    using const_iterator = theta_const_iterator<Entry, ExtractKey>;
+
+    local_buffer(uint8_t lg_k, uint64_t theta, uint64_t seed, const Allocator& allocator);
+
+    bool is_empty() const;
+    bool is_ordered() const;
+    uint16_t get_seed_hash() const;
+    uint64_t get_theta64() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // drops the hashes after propagation and starts screening by the given theta
+    void clear(uint64_t theta);
+
+    theta_table table_;
+    uint16_t seed_hash_;
+  };
+
+  Allocator allocator_;
+  uint8_t lg_k_;
+  uint8_t local_lg_k_;
+  double max_concurrency_error_;
+  uint64_t seed_;
+  mutable std::mutex mutex_;
+  State state_;
+  std::atomic<bool> is_empty_;
+  std::atomic<uint64_t> theta_;
+  std::atomic<uint32_t> num_retained_;
+  std::atomic<double> estimate_;
+
+  // for builder
+  concurrent_theta_sketch_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p,
+      uint64_t theta, uint64_t seed, uint8_t local_lg_k, double max_concurrency_error, const Allocator& allocator,
+      theta_constants::table_layout layout);
+
+  void propagate(local_buffer& buffer);
+  void publish();
+  uint32_t get_propagation_threshold() const;
+};
+
+/**
+ * Thread-local view of a concurrent Theta sketch that buffers updates.
+ * Each thread should construct its own writer for the shared sketch.
+ */
+template<typename Allocator>
+class concurrent_theta_sketch_alloc<Allocator>::writer {
+public:
+  /**
+   * Constructor
+   * @param sketch shared sketch to propagate updates to, must outlive the writer
+   */
+  explicit writer(concurrent_theta_sketch_alloc& sketch);
+
+  /**
+   * Move constructor
+   * @param other writer to be moved
+   */
+  writer(writer&& other) noexcept;
+
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+
+  /**
+   * Destructor propagates the buffered updates
+   */
+  ~writer();
+
+  /**
+   * Update the sketch with a given string.
+   * @param value string to update the sketch with
+   */
+  void update(const std::string& value);
+
+  /**
+   * Update the sketch with a given unsigned 64-bit integer.
+   * @param value uint64_t to update the sketch with
+   */
+  void update(uint64_t value);
+
+  /**
+   * Update the sketch with a given signed 64-bit integer.
+   * @param value int64_t to update the sketch with
+   */
+  void update(int64_t value);
+
+  /**
+   * Update the sketch with a given unsigned 32-bit integer.
+   * For compatibility with Java implementation.
+   * @param value uint32_t to update the sketch with
+   */
+  void update(uint32_t value);
+
+  /**
+   * Update the sketch with a given signed 32-bit integer.
+   * For compatibility with Java implementation.
+   * @param value int32_t to update the sketch with
+   */
+  void update(int32_t value);
+
+  /**
+   * Update the sketch with a given double-precision floating point value.
+   * For compatibility with Java implementation.
+   * @param value double to update the sketch with
+   */
+  void update(double value);
+
+  /**
+   * Update the sketch with a given floating point value.
+   * For compatibility with Java implementation.
+   * @param value float to update the sketch with
+   */
+  void update(float value);
+
+  /**
+   * Update the sketch with given data of any type.
+   * Hashes the same way as update_theta_sketch_alloc::update(const void*, size_t).
+   * @param data pointer to the data
+   * @param length of the data in bytes
+   */
+  void update(const void* data, size_t length);
+
+  /**
+   * Propagates the buffered updates to the shared sketch
+   */
+  void flush();
+
+private:
+  concurrent_theta_sketch_alloc* sketch_;
+  local_buffer buffer_;
+  uint32_t threshold_;
+};
+
+/// Concurrent Theta sketch builder
+template<typename Allocator>
+class concurrent_theta_sketch_alloc<Allocator>::builder: public theta_base_builder<builder, Allocator> {
+public:
+  /**
+   * Constructor
+   * @param allocator
+   */
+  builder(const Allocator& allocator = Allocator());
+
+  /**
+   * Set log2 of the maximum number of hashes a writer holds before propagating them (defaults to 4).
+   * Must not be greater than lg_k.
+   * @param local_lg_k base 2 logarithm of the size of the local buffers
+   * @return this builder
+   */
+  builder& set_local_lg_k(uint8_t local_lg_k);
+
+  /**
+   * Set the maximum error relative to the estimate that each writer may add by holding hashes
+   * that are not yet propagated (defaults to 0.01). Zero propagates every retained hash immediately.
+   * @param error maximum concurrency error from 0 to 1
+   * @return this builder
+   */
+  builder& set_max_concurrency_error(double error);
+
+  /// @return instance of concurrent Theta sketch
+  concurrent_theta_sketch_alloc build() const;
+
+private:
+  uint8_t local_lg_k_;
+  double max_concurrency_error_;
+};
+
+} /* namespace datasketches */
+
+#include "concurrent_theta_sketch_impl.hpp"
+
+#endif
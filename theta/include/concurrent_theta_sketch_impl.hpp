@@ -0,0 +1,334 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CONCURRENT_THETA_SKETCH_IMPL_HPP_
+#define CONCURRENT_THETA_SKETCH_IMPL_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "binomial_bounds.hpp"
+#include "concurrent_theta_sketch.hpp"
+
+namespace datasketches {
+
+template<typename A>
+const uint8_t concurrent_theta_sketch_alloc<A>::DEFAULT_LOCAL_LG_K;
+
+template<typename A>
+constexpr double concurrent_theta_sketch_alloc<A>::DEFAULT_MAX_CONCURRENCY_ERROR;
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::concurrent_theta_sketch_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf,
+    float p, uint64_t theta, uint64_t seed, uint8_t local_lg_k, double max_concurrency_error, const A& allocator,
+    theta_constants::table_layout layout):
+allocator_(allocator),
+lg_k_(lg_nom_size),
+local_lg_k_(local_lg_k),
+max_concurrency_error_(max_concurrency_error),
+seed_(seed),
+state_(lg_cur_size, lg_nom_size, rf, p, theta, seed, nop_policy(), allocator, layout)
+{
+  publish();
+}
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::concurrent_theta_sketch_alloc(concurrent_theta_sketch_alloc&& other) noexcept:
+allocator_(other.allocator_),
+lg_k_(other.lg_k_),
+local_lg_k_(other.local_lg_k_),
+max_concurrency_error_(other.max_concurrency_error_),
+seed_(other.seed_),
+state_(std::move(other.state_))
+{
+  publish();
+}
+
+template<typename A>
+A concurrent_theta_sketch_alloc<A>::get_allocator() const {
+  return allocator_;
+}
+
+template<typename A>
+uint8_t concurrent_theta_sketch_alloc<A>::get_lg_k() const {
+  return lg_k_;
+}
+
+template<typename A>
+uint8_t concurrent_theta_sketch_alloc<A>::get_local_lg_k() const {
+  return local_lg_k_;
+}
+
+template<typename A>
+double concurrent_theta_sketch_alloc<A>::get_max_concurrency_error() const {
+  return max_concurrency_error_;
+}
+
+template<typename A>
+uint16_t concurrent_theta_sketch_alloc<A>::get_seed_hash() const {
+  return compute_seed_hash(seed_);
+}
+
+template<typename A>
+bool concurrent_theta_sketch_alloc<A>::is_empty() const {
+  return is_empty_.load(std::memory_order_acquire);
+}
+
+template<typename A>
+uint64_t concurrent_theta_sketch_alloc<A>::get_theta64() const {
+  return theta_.load(std::memory_order_acquire);
+}
+
+template<typename A>
+double concurrent_theta_sketch_alloc<A>::get_theta() const {
+  return static_cast<double>(get_theta64()) / static_cast<double>(theta_constants::MAX_THETA);
+}
+
+template<typename A>
+uint32_t concurrent_theta_sketch_alloc<A>::get_num_retained() const {
+  return num_retained_.load(std::memory_order_acquire);
+}
+
+template<typename A>
+double concurrent_theta_sketch_alloc<A>::get_estimate() const {
+  return estimate_.load(std::memory_order_acquire);
+}
+
+template<typename A>
+double concurrent_theta_sketch_alloc<A>::get_lower_bound(uint8_t num_std_devs) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t theta = state_.get_theta64();
+  if (theta == theta_constants::MAX_THETA || state_.is_empty()) return state_.get_num_retained();
+  return binomial_bounds::get_lower_bound(state_.get_num_retained(),
+      static_cast<double>(theta) / static_cast<double>(theta_constants::MAX_THETA), num_std_devs);
+}
+
+template<typename A>
+double concurrent_theta_sketch_alloc<A>::get_upper_bound(uint8_t num_std_devs) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t theta = state_.get_theta64();
+  if (theta == theta_constants::MAX_THETA || state_.is_empty()) return state_.get_num_retained();
+  return binomial_bounds::get_upper_bound(state_.get_num_retained(),
+      static_cast<double>(theta) / static_cast<double>(theta_constants::MAX_THETA), num_std_devs);
+}
+
+template<typename A>
+auto concurrent_theta_sketch_alloc<A>::get_result(bool ordered) const -> CompactSketch {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_.get_result(ordered);
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::propagate(local_buffer& buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.update(buffer);
+  publish();
+}
+
+// called under the lock or before the sketch is shared
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::publish() {
+  const uint64_t theta = state_.get_theta64();
+  const uint32_t num_retained = state_.get_num_retained();
+  theta_.store(theta, std::memory_order_release);
+  num_retained_.store(num_retained, std::memory_order_release);
+  estimate_.store(num_retained / (static_cast<double>(theta) / static_cast<double>(theta_constants::MAX_THETA)),
+      std::memory_order_release);
+  is_empty_.store(state_.is_empty(), std::memory_order_release);
+}
+
+template<typename A>
+uint32_t concurrent_theta_sketch_alloc<A>::get_propagation_threshold() const {
+  const double threshold = max_concurrency_error_ * get_estimate();
+  const uint32_t max_threshold = 1 << local_lg_k_;
+  if (threshold < 1) return 1;
+  if (threshold > max_threshold) return max_threshold;
+  return static_cast<uint32_t>(threshold);
+}
+
+// local buffer
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::local_buffer::local_buffer(uint8_t lg_k, uint64_t theta, uint64_t seed, const A& allocator):
+table_(lg_k + 1, lg_k, resize_factor::X1, 1, theta, seed, allocator),
+seed_hash_(compute_seed_hash(seed))
+{}
+
+template<typename A>
+bool concurrent_theta_sketch_alloc<A>::local_buffer::is_empty() const {
+  return table_.is_empty_;
+}
+
+template<typename A>
+bool concurrent_theta_sketch_alloc<A>::local_buffer::is_ordered() const {
+  return false;
+}
+
+template<typename A>
+uint16_t concurrent_theta_sketch_alloc<A>::local_buffer::get_seed_hash() const {
+  return seed_hash_;
+}
+
+template<typename A>
+uint64_t concurrent_theta_sketch_alloc<A>::local_buffer::get_theta64() const {
+  return table_.theta_;
+}
+
+template<typename A>
+auto concurrent_theta_sketch_alloc<A>::local_buffer::begin() const -> const_iterator {
+  return const_iterator(table_.entries_, 1 << table_.lg_cur_size_, 0);
+}
+
+template<typename A>
+auto concurrent_theta_sketch_alloc<A>::local_buffer::end() const -> const_iterator {
+  return const_iterator(nullptr, 0, 1 << table_.lg_cur_size_);
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::local_buffer::clear(uint64_t theta) {
+  std::fill(table_.begin(), table_.end(), 0);
+  table_.num_entries_ = 0;
+  table_.is_empty_ = true;
+  table_.theta_ = theta;
+}
+
+// writer
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::writer::writer(concurrent_theta_sketch_alloc& sketch):
+sketch_(&sketch),
+buffer_(sketch.local_lg_k_, sketch.get_theta64(), sketch.seed_, sketch.allocator_),
+threshold_(sketch.get_propagation_threshold())
+{}
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::writer::writer(writer&& other) noexcept:
+sketch_(other.sketch_),
+buffer_(std::move(other.buffer_)),
+threshold_(other.threshold_)
+{
+  other.sketch_ = nullptr;
+}
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::writer::~writer() {
+  if (sketch_ != nullptr) flush();
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(uint64_t value) {
+  update(&value, sizeof(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(int64_t value) {
+  update(&value, sizeof(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(uint32_t value) {
+  update(static_cast<int32_t>(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(int32_t value) {
+  update(static_cast<int64_t>(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(double value) {
+  update(canonical_double(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(float value) {
+  update(static_cast<double>(value));
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(const std::string& value) {
+  if (value.empty()) return;
+  update(value.c_str(), value.length());
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::update(const void* data, size_t length) {
+  auto& table = buffer_.table_;
+  const bool was_empty = table.is_empty_;
+  const uint64_t hash = table.hash_and_screen(data, length);
+  if (hash == 0) {
+    // the first update must reach the shared sketch even if it is screened out
+    if (was_empty && sketch_->is_empty()) flush();
+    return;
+  }
+  auto result = table.find(hash);
+  if (!result.second) {
+    table.insert(result.first, hash);
+    if (table.num_entries_ >= threshold_) flush();
+  }
+}
+
+template<typename A>
+void concurrent_theta_sketch_alloc<A>::writer::flush() {
+  if (buffer_.is_empty()) return;
+  sketch_->propagate(buffer_);
+  buffer_.clear(sketch_->get_theta64());
+  threshold_ = sketch_->get_propagation_threshold();
+}
+
+// builder
+
+template<typename A>
+concurrent_theta_sketch_alloc<A>::builder::builder(const A& allocator):
+theta_base_builder<builder, A>(allocator),
+local_lg_k_(DEFAULT_LOCAL_LG_K),
+max_concurrency_error_(DEFAULT_MAX_CONCURRENCY_ERROR)
+{}
+
+template<typename A>
+auto concurrent_theta_sketch_alloc<A>::builder::set_local_lg_k(uint8_t local_lg_k) -> builder& {
+  if (local_lg_k > theta_constants::MAX_LG_K) {
+    throw std::invalid_argument("local_lg_k must not be greater than " + std::to_string(theta_constants::MAX_LG_K)
+        + ": " + std::to_string(local_lg_k));
+  }
+  local_lg_k_ = local_lg_k;
+  return *this;
+}
+
+template<typename A>
+auto concurrent_theta_sketch_alloc<A>::builder::set_max_concurrency_error(double error) -> builder& {
+  if (error < 0 || error > 1) throw std::invalid_argument("max concurrency error must be between 0 and 1");
+  max_concurrency_error_ = error;
+  return *this;
+}
+
+template<typename A>
+concurrent_theta_sketch_alloc<A> concurrent_theta_sketch_alloc<A>::builder::build() const {
+  if (local_lg_k_ > this->lg_k_) {
+    throw std::invalid_argument("local_lg_k must not be greater than lg_k: " + std::to_string(local_lg_k_)
+        + " > " + std::to_string(this->lg_k_));
+  }
+  return concurrent_theta_sketch_alloc(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(),
+      this->seed_, local_lg_k_, max_concurrency_error_, this->allocator_, this->layout_);
+}
+
+} /* namespace datasketches */
+
+#endif
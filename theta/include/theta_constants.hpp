@@ -32,6 +32,14 @@ namespace theta_constants {
   /// default resize factor
   const resize_factor DEFAULT_RESIZE_FACTOR = resize_factor::X8;
 
+  /// layout of the hash table of update sketches and unions
+  enum table_layout {
+    DOUBLE_HASHING, ///< keys are probed in place in the array of entries with double hashing
+    SEPARATE_KEYS   ///< keys are probed in a dense array of their own, a cache line of keys compared at once
+  };
+  /// default table layout
+  const table_layout DEFAULT_TABLE_LAYOUT = table_layout::DOUBLE_HASHING;
+
   /// max theta - signed max for compatibility with Java
   const uint64_t MAX_THETA = LLONG_MAX;
   /// min log2 of K
@@ -68,6 +68,18 @@ public:
   template<typename FwdSketch>
   void update(FwdSketch&& sketch);
 
+  /**
+   * Updates the intersection with a range of sketches.
+   * If all of them are ordered (for instance deserialized compact sketches), the sorted entries
+   * are intersected directly: every input gallops to the greatest key seen so far,
+   * so no hash tables are built for the inputs and small inputs cut through large ones quickly.
+   * Otherwise the sketches are added one by one as with update().
+   * @param first iterator to the first sketch
+   * @param last iterator past the last sketch
+   */
+  template<typename FwdIt>
+  void update_many(FwdIt first, FwdIt last);
+
   /**
    * Produces a copy of the current state of the intersection.
    * If update() was not called, the state is the infinite "universe",
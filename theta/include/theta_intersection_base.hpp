@@ -20,6 +20,11 @@
 #ifndef THETA_INTERSECTION_BASE_HPP_
 #define THETA_INTERSECTION_BASE_HPP_
 
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace datasketches {
 
 template<
@@ -40,6 +45,11 @@ public:
   template<typename FwdSketch>
   void update(FwdSketch&& sketch);
 
+  // Intersects a range of ordered sketches by galloping over their sorted entries
+  // instead of building and probing hash tables. Equivalent to updating with each sketch in turn.
+  template<typename FwdIt>
+  void update_ordered(FwdIt first, FwdIt last);
+
   CompactSketch get_result(bool ordered = true) const;
 
   bool has_result() const;
@@ -47,9 +57,78 @@ public:
   const Policy& get_policy() const;
 
 private:
+  // position in the sorted entries of one input
+  template<typename Iterator>
+  struct merge_cursor {
+    Iterator it;
+    Iterator end;
+
+    // moves to the first entry with a key not less than the given one, returns false past the end
+    bool seek(uint64_t key);
+
+    auto current() const -> decltype(*std::declval<const Iterator&>()) { return *it; }
+
+  private:
+    bool seek(uint64_t key, std::random_access_iterator_tag);
+    bool seek(uint64_t key, std::input_iterator_tag);
+  };
+
+  // position in the hash values of a sketch that is read in blocks
+  template<typename Reader>
+  struct block_cursor {
+    Reader reader;
+    uint32_t index;
+    uint32_t size;
+
+    template<typename SS>
+    explicit block_cursor(const SS& sketch): reader(sketch), index(0), size(reader.next()) {}
+
+    // moves to the first hash not less than the given one, returns false past the end
+    bool seek(uint64_t key);
+
+    uint64_t current() const { return reader.data()[index]; }
+  };
+
+  struct key_less {
+    bool operator()(const Entry& entry, uint64_t key) const { return ExtractKey()(entry) < key; }
+  };
+
+  // compact sketches of this family are accessed as sorted arrays so that cursors can gallop
+  static const Entry* entries_begin(const CompactSketch& sketch) { return sketch.entries_.data(); }
+  static const Entry* entries_end(const CompactSketch& sketch) { return sketch.entries_.data() + sketch.entries_.size(); }
+  template<typename SS>
+  static auto entries_begin(const SS& sketch) -> decltype(sketch.begin()) { return sketch.begin(); }
+  template<typename SS>
+  static auto entries_end(const SS& sketch) -> decltype(sketch.end()) { return sketch.end(); }
+
+  template<typename SS>
+  static auto make_cursor(const SS& sketch, std::false_type) -> merge_cursor<decltype(entries_begin(sketch))> {
+    return {entries_begin(sketch), entries_end(sketch)};
+  }
+  template<typename SS>
+  static block_cursor<typename SS::block_reader> make_cursor(const SS& sketch, std::true_type) {
+    return block_cursor<typename SS::block_reader>(sketch);
+  }
+
   Policy policy_;
   bool is_valid_;
   hash_table table_;
+  // entries in key order after update_ordered(), the table holds no entries then
+  std::vector<Entry, Allocator> sorted_entries_;
+
+  void move_table_to_sorted_entries();
+  void move_sorted_entries_to_table();
+
+  template<typename SS>
+  void insert_entries(SS&& sketch, std::false_type);
+  template<typename SS>
+  void insert_entries(const SS& sketch, std::true_type);
+
+  // returns the number of entries below theta, the matches are appended to the given vector
+  template<typename SS>
+  uint32_t match_entries(SS&& sketch, std::vector<Entry, Allocator>& matched_entries, uint32_t max_matches, std::false_type);
+  template<typename SS>
+  uint32_t match_entries(const SS& sketch, std::vector<Entry, Allocator>& matched_entries, uint32_t max_matches, std::true_type);
 };
 
 } /* namespace datasketches */
@@ -20,7 +20,9 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "conditional_forward.hpp"
 
@@ -30,13 +32,15 @@ template<typename EN, typename EK, typename P, typename S, typename CS, typename
 theta_intersection_base<EN, EK, P, S, CS, A>::theta_intersection_base(uint64_t seed, const P& policy, const A& allocator):
 policy_(policy),
 is_valid_(false),
-table_(0, 0, resize_factor::X1, 1, theta_constants::MAX_THETA, seed, allocator, false)
+table_(0, 0, resize_factor::X1, 1, theta_constants::MAX_THETA, seed, allocator, false),
+sorted_entries_(allocator)
 {}
 
 template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
 template<typename SS>
 void theta_intersection_base<EN, EK, P, S, CS, A>::update(SS&& sketch) {
   if (table_.is_empty_) return;
+  if (!sorted_entries_.empty()) move_sorted_entries_to_table();
   if (!sketch.is_empty() && sketch.get_seed_hash() != compute_seed_hash(table_.seed_)) throw std::invalid_argument("seed hash mismatch");
   table_.is_empty_ |= sketch.is_empty();
   table_.theta_ = table_.is_empty_ ? theta_constants::MAX_THETA : std::min(table_.theta_, sketch.get_theta64());
@@ -50,34 +54,14 @@ void theta_intersection_base<EN, EK, P, S, CS, A>::update(SS&& sketch) {
     is_valid_ = true;
     const uint8_t lg_size = lg_size_from_count(sketch.get_num_retained(), theta_update_sketch_base<EN, EK, A>::REBUILD_THRESHOLD);
     table_ = hash_table(lg_size, lg_size - 1, resize_factor::X1, 1, table_.theta_, table_.seed_, table_.allocator_, table_.is_empty_);
-    for (auto&& entry: sketch) {
-      auto result = table_.find(EK()(entry));
-      if (result.second) {
-        throw std::invalid_argument("duplicate key, possibly corrupted input sketch");
-      }
-      table_.insert(result.first, conditional_forward<SS>(entry));
-    }
+    insert_entries(std::forward<SS>(sketch), typename has_block_reader<SS>::type());
     if (table_.num_entries_ != sketch.get_num_retained()) throw std::invalid_argument("num entries mismatch, possibly corrupted input sketch");
   } else { // intersection
     const uint32_t max_matches = std::min(table_.num_entries_, sketch.get_num_retained());
     std::vector<EN, A> matched_entries(table_.allocator_);
     matched_entries.reserve(max_matches);
-    uint32_t match_count = 0;
-    uint32_t count = 0;
-    for (auto&& entry: sketch) {
-      if (EK()(entry) < table_.theta_) {
-        auto result = table_.find(EK()(entry));
-        if (result.second) {
-          if (match_count == max_matches) throw std::invalid_argument("max matches exceeded, possibly corrupted input sketch");
-          policy_(*result.first, conditional_forward<SS>(entry));
-          matched_entries.push_back(std::move(*result.first));
-          ++match_count;
-        }
-      } else if (sketch.is_ordered()) {
-        break; // early stop
-      }
-      ++count;
-    }
+    const uint32_t count = match_entries(std::forward<SS>(sketch), matched_entries, max_matches, typename has_block_reader<SS>::type());
+    const uint32_t match_count = static_cast<uint32_t>(matched_entries.size());
     if (count > sketch.get_num_retained()) {
       throw std::invalid_argument(" more keys than expected, possibly corrupted input sketch");
     } else if (!sketch.is_ordered() && count < sketch.get_num_retained()) {
@@ -97,9 +81,250 @@ void theta_intersection_base<EN, EK, P, S, CS, A>::update(SS&& sketch) {
   }
 }
 
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+void theta_intersection_base<EN, EK, P, S, CS, A>::insert_entries(SS&& sketch, std::false_type) {
+  for (auto&& entry: sketch) {
+    auto result = table_.find(EK()(entry));
+    if (result.second) {
+      throw std::invalid_argument("duplicate key, possibly corrupted input sketch");
+    }
+    table_.insert(result.first, conditional_forward<SS>(entry));
+  }
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+void theta_intersection_base<EN, EK, P, S, CS, A>::insert_entries(const SS& sketch, std::true_type) {
+  typename SS::block_reader reader(sketch);
+  uint32_t num;
+  while ((num = reader.next()) > 0) {
+    const uint64_t* hashes = reader.data();
+    for (uint32_t i = 0; i < num; ++i) {
+      auto result = table_.find(hashes[i]);
+      if (result.second) {
+        throw std::invalid_argument("duplicate key, possibly corrupted input sketch");
+      }
+      table_.insert(result.first, hashes[i]);
+    }
+  }
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+uint32_t theta_intersection_base<EN, EK, P, S, CS, A>::match_entries(SS&& sketch, std::vector<EN, A>& matched_entries,
+    uint32_t max_matches, std::false_type) {
+  uint32_t count = 0;
+  for (auto&& entry: sketch) {
+    if (EK()(entry) < table_.theta_) {
+      auto result = table_.find(EK()(entry));
+      if (result.second) {
+        if (matched_entries.size() == max_matches) throw std::invalid_argument("max matches exceeded, possibly corrupted input sketch");
+        policy_(*result.first, conditional_forward<SS>(entry));
+        matched_entries.push_back(std::move(*result.first));
+      }
+    } else if (sketch.is_ordered()) {
+      break; // early stop
+    }
+    ++count;
+  }
+  return count;
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+uint32_t theta_intersection_base<EN, EK, P, S, CS, A>::match_entries(const SS& sketch, std::vector<EN, A>& matched_entries,
+    uint32_t max_matches, std::true_type) {
+  uint32_t count = 0;
+  typename SS::block_reader reader(sketch);
+  uint32_t num;
+  while ((num = reader.next()) > 0) {
+    const uint64_t* hashes = reader.data();
+    for (uint32_t i = 0; i < num; ++i) table_.prefetch_slot(hashes[i]);
+    for (uint32_t i = 0; i < num; ++i) {
+      if (hashes[i] < table_.theta_) {
+        auto result = table_.find(hashes[i]);
+        if (result.second) {
+          if (matched_entries.size() == max_matches) throw std::invalid_argument("max matches exceeded, possibly corrupted input sketch");
+          policy_(*result.first, hashes[i]);
+          matched_entries.push_back(std::move(*result.first));
+        }
+      } else if (sketch.is_ordered()) {
+        return count; // early stop
+      }
+      ++count;
+    }
+  }
+  return count;
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename FwdIt>
+void theta_intersection_base<EN, EK, P, S, CS, A>::update_ordered(FwdIt first, FwdIt last) {
+  if (first == last || table_.is_empty_) return;
+  if (is_valid_ && table_.num_entries_ == 0 && sorted_entries_.empty()) {
+    // no entries to intersect, only theta and the empty flag can change
+    for (; first != last; ++first) update(*first);
+    return;
+  }
+
+  using block_reader_tag = typename has_block_reader<decltype(*first)>::type;
+  using cursor = decltype(make_cursor(*first, block_reader_tag()));
+  using AllocCursor = typename std::allocator_traits<A>::template rebind_alloc<cursor>;
+  std::vector<cursor, AllocCursor> cursors(AllocCursor(table_.allocator_));
+  cursors.reserve(std::distance(first, last));
+
+  const uint16_t seed_hash = compute_seed_hash(table_.seed_);
+  bool is_empty = false;
+  uint64_t theta = table_.theta_;
+  for (auto it = first; it != last; ++it) {
+    if (!it->is_empty() && it->get_seed_hash() != seed_hash) throw std::invalid_argument("seed hash mismatch");
+    if (!it->is_ordered()) throw std::invalid_argument("ordered sketches expected");
+    is_empty |= it->is_empty();
+    theta = std::min(theta, it->get_theta64());
+    cursors.push_back(make_cursor(*it, block_reader_tag()));
+  }
+  is_valid_ = true;
+  if (is_empty) {
+    table_ = hash_table(0, 0, resize_factor::X1, 1, theta_constants::MAX_THETA, table_.seed_, table_.allocator_, true);
+    sorted_entries_.clear();
+    return;
+  }
+
+  // the current state takes part in the intersection as one more sorted input, and it comes first for the policy
+  if (table_.num_entries_ > 0) move_table_to_sorted_entries();
+  const bool has_state = !sorted_entries_.empty();
+  merge_cursor<const EN*> state{sorted_entries_.data(), sorted_entries_.data() + sorted_entries_.size()};
+  const size_t num_inputs = cursors.size();
+  const size_t num_cursors = num_inputs + (has_state ? 1 : 0);
+  auto seek = [&cursors, &state, num_inputs](size_t i, uint64_t key) {
+    return i < num_inputs ? cursors[i].seek(key) : state.seek(key);
+  };
+  auto key_at = [&cursors, &state, num_inputs](size_t i) -> uint64_t {
+    return i < num_inputs ? EK()(cursors[i].current()) : EK()(state.current());
+  };
+
+  // the input with the fewest entries drives the search
+  size_t driver = has_state ? num_inputs : 0;
+  size_t driver_num_entries = has_state ? sorted_entries_.size() : std::numeric_limits<size_t>::max();
+  size_t i = 0;
+  for (auto it = first; it != last; ++it, ++i) {
+    if (it->get_num_retained() < driver_num_entries) {
+      driver = i;
+      driver_num_entries = it->get_num_retained();
+    }
+  }
+
+  // leapfrog: every cursor seeks the greatest key seen so far until all of them agree
+  std::vector<EN, A> matched_entries(table_.allocator_);
+  if (driver_num_entries > 0) {
+    matched_entries.reserve(driver_num_entries);
+    i = driver;
+    uint64_t key = key_at(i);
+    size_t num_agreed = 1;
+    while (key < theta) {
+      i = (i + 1) % num_cursors;
+      if (num_agreed == num_cursors) {
+        EN entry = has_state ? EN(state.current()) : EN(cursors[0].current());
+        for (size_t j = has_state ? 0 : 1; j < num_inputs; ++j) policy_(entry, cursors[j].current());
+        matched_entries.push_back(std::move(entry));
+        if (!seek(i, key + 1)) break;
+        key = key_at(i);
+        num_agreed = 1;
+        continue;
+      }
+      if (!seek(i, key)) break;
+      const uint64_t next_key = key_at(i);
+      if (next_key == key) {
+        ++num_agreed;
+      } else {
+        key = next_key;
+        num_agreed = 1;
+      }
+    }
+  }
+
+  table_ = hash_table(0, 0, resize_factor::X1, 1, theta, table_.seed_, table_.allocator_, false);
+  if (matched_entries.empty() && theta == theta_constants::MAX_THETA) table_.is_empty_ = true;
+  sorted_entries_ = std::move(matched_entries);
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+void theta_intersection_base<EN, EK, P, S, CS, A>::move_table_to_sorted_entries() {
+  sorted_entries_.reserve(table_.num_entries_);
+  for (auto& entry: table_) {
+    if (EK()(entry) != 0) sorted_entries_.push_back(std::move(entry));
+  }
+  std::sort(sorted_entries_.begin(), sorted_entries_.end(), comparator());
+  table_ = hash_table(0, 0, resize_factor::X1, 1, table_.theta_, table_.seed_, table_.allocator_, table_.is_empty_);
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+void theta_intersection_base<EN, EK, P, S, CS, A>::move_sorted_entries_to_table() {
+  const uint8_t lg_size = lg_size_from_count(static_cast<uint32_t>(sorted_entries_.size()), hash_table::REBUILD_THRESHOLD);
+  table_ = hash_table(lg_size, lg_size - 1, resize_factor::X1, 1, table_.theta_, table_.seed_, table_.allocator_, table_.is_empty_);
+  for (auto& entry: sorted_entries_) {
+    auto result = table_.find(EK()(entry));
+    table_.insert(result.first, std::move(entry));
+  }
+  sorted_entries_.clear();
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename It>
+bool theta_intersection_base<EN, EK, P, S, CS, A>::merge_cursor<It>::seek(uint64_t key) {
+  return seek(key, typename std::iterator_traits<It>::iterator_category());
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename It>
+bool theta_intersection_base<EN, EK, P, S, CS, A>::merge_cursor<It>::seek(uint64_t key, std::random_access_iterator_tag) {
+  if (it == end) return false;
+  if (EK()(*it) >= key) return true;
+  // exponential search for a bound, then binary search within it
+  It low = it;
+  typename std::iterator_traits<It>::difference_type step = 1;
+  It high = end;
+  while (step < end - low) {
+    if (EK()(low[step]) >= key) {
+      high = low + step;
+      break;
+    }
+    low += step;
+    step *= 2;
+  }
+  it = std::lower_bound(low + 1, high, key, key_less());
+  return it != end;
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename It>
+bool theta_intersection_base<EN, EK, P, S, CS, A>::merge_cursor<It>::seek(uint64_t key, std::input_iterator_tag) {
+  while (it != end && EK()(*it) < key) ++it;
+  return it != end;
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename Reader>
+bool theta_intersection_base<EN, EK, P, S, CS, A>::block_cursor<Reader>::seek(uint64_t key) {
+  // blocks that end below the key are skipped without searching them
+  while (size > 0 && reader.data()[size - 1] < key) {
+    size = reader.next();
+    index = 0;
+  }
+  if (size == 0) return false;
+  merge_cursor<const uint64_t*> block{reader.data() + index, reader.data() + size};
+  block.seek(key);
+  index = static_cast<uint32_t>(block.it - reader.data());
+  return true;
+}
+
 template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
 CS theta_intersection_base<EN, EK, P, S, CS, A>::get_result(bool ordered) const {
   if (!is_valid_) throw std::invalid_argument("calling get_result() before calling update() is undefined");
+  if (!sorted_entries_.empty()) {
+    return CS(table_.is_empty_, ordered, compute_seed_hash(table_.seed_), table_.theta_, std::vector<EN, A>(sorted_entries_));
+  }
   std::vector<EN, A> entries(table_.allocator_);
   if (table_.num_entries_ > 0) {
     entries.reserve(table_.num_entries_);
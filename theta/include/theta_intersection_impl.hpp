@@ -20,6 +20,9 @@
 #ifndef THETA_INTERSECTION_IMPL_HPP_
 #define THETA_INTERSECTION_IMPL_HPP_
 
+#include <algorithm>
+#include <iterator>
+
 namespace datasketches {
 
 template<typename A>
@@ -33,6 +36,17 @@ void theta_intersection_alloc<A>::update(FwdSketch&& sketch) {
   state_.update(std::forward<FwdSketch>(sketch));
 }
 
+template<typename A>
+template<typename FwdIt>
+void theta_intersection_alloc<A>::update_many(FwdIt first, FwdIt last) {
+  using reference = typename std::iterator_traits<FwdIt>::reference;
+  if (std::all_of(first, last, [](reference sketch) { return sketch.is_ordered(); })) {
+    state_.update_ordered(first, last);
+  } else {
+    for (; first != last; ++first) state_.update(*first);
+  }
+}
+
 template<typename A>
 auto theta_intersection_alloc<A>::get_result(bool ordered) const -> CompactSketch {
   return state_.get_result(ordered);
@@ -37,7 +37,16 @@ seed_hash_(compute_seed_hash(seed))
 template<typename EN, typename EK, typename CS, typename A>
 template<typename FwdSketch, typename Sketch>
 CS theta_set_difference_base<EN, EK, CS, A>::compute(FwdSketch&& a, const Sketch& b, bool ordered) const {
-  if (a.is_empty() || (a.get_num_retained() > 0 && b.is_empty())) return CS(a, ordered);
+  if (a.is_empty() || (a.get_num_retained() > 0 && b.is_empty())) {
+    // copy of A with the allocator of this operation, which may differ from the one of A
+    const bool is_empty = a.is_empty();
+    const bool is_ordered = a.is_ordered() || ordered;
+    const uint16_t seed_hash = a.get_seed_hash();
+    const uint64_t theta = a.get_theta64();
+    std::vector<EN, A> entries(forward_begin(std::forward<FwdSketch>(a)), forward_end(std::forward<FwdSketch>(a)), allocator_);
+    if (ordered && !a.is_ordered()) std::sort(entries.begin(), entries.end(), comparator());
+    return CS(is_empty, is_ordered, seed_hash, theta, std::move(entries));
+  }
   if (a.get_seed_hash() != seed_hash_) throw std::invalid_argument("A seed hash mismatch");
   if (b.get_seed_hash() != seed_hash_) throw std::invalid_argument("B seed hash mismatch");
 
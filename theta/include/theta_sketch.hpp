@@ -181,6 +181,7 @@ public:
   using const_iterator = typename Base::const_iterator;
   using theta_table = theta_update_sketch_base<Entry, ExtractKey, Allocator>;
   using resize_factor = typename theta_table::resize_factor;
+  using table_layout = typename theta_table::table_layout;
 
   // No constructor here. Use builder instead.
   class builder;
@@ -319,6 +320,24 @@ public:
    */
   void update(const void* data, size_t length);
 
+  /**
+   * Update this sketch with a batch of unsigned 64-bit integers.
+   * Equivalent to calling update(values[i]) for every value, but a block of values is hashed
+   * and screened by theta before the hash table is probed so that cache misses overlap.
+   * @param values pointer to the array of values
+   * @param num_values number of values in the batch
+   */
+  void update_batch(const uint64_t* values, size_t num_values);
+
+  /**
+   * Update this sketch with a batch of strings.
+   * Equivalent to calling update(values[i]) for every string, but a block of strings is hashed
+   * and screened by theta before the hash table is probed so that cache misses overlap.
+   * @param values pointer to the array of strings
+   * @param num_values number of strings in the batch
+   */
+  void update_batch(const std::string* values, size_t num_values);
+
   /**
    * Remove retained entries in excess of the nominal size k (if any)
    */
@@ -344,11 +363,23 @@ public:
 private:
   theta_table table_;
 
+  static const size_t BATCH_SIZE = 256; // values hashed ahead of the table probes by update_batch
+
   // for builder
   update_theta_sketch_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p,
-      uint64_t theta, uint64_t seed, const Allocator& allocator);
+      uint64_t theta, uint64_t seed, const Allocator& allocator, theta_constants::table_layout layout);
 
   virtual void print_specifics(std::ostringstream& os) const;
+
+  template<typename T>
+  void update_batch_impl(const T* values, size_t num_values);
+
+  static const void* value_data(const uint64_t& value) { return &value; }
+  static size_t value_size(const uint64_t& value) { return sizeof(value); }
+  static bool is_ignored(const uint64_t&) { return false; }
+  static const void* value_data(const std::string& value) { return value.c_str(); }
+  static size_t value_size(const std::string& value) { return value.length(); }
+  static bool is_ignored(const std::string& value) { return value.empty(); }
 };
 
 /**
@@ -543,6 +574,7 @@ template<typename Allocator = std::allocator<uint64_t>>
 class wrapped_compact_theta_sketch_alloc: public base_theta_sketch_alloc<Allocator> {
 public:
   class const_iterator;
+  class block_reader;
 
   Allocator get_allocator() const;
   bool is_empty() const;
@@ -616,6 +648,45 @@ private:
   inline void unpack8();
 };
 
+/**
+ * Sequential reader of the hash values of a wrapped sketch in blocks.
+ * Compressed entries are decoded a block at a time into a buffer inside the reader,
+ * uncompressed entries are read in place from the wrapped buffer.
+ * Set operations use it to consume wrapped sketches with no per-entry iterator overhead
+ * and no heap allocation.
+ */
+template<typename Allocator>
+class wrapped_compact_theta_sketch_alloc<Allocator>::block_reader {
+public:
+  /// maximum number of hash values in a block, multiple of 8
+  static const uint32_t BLOCK_SIZE = 64;
+
+  /**
+   * Constructor
+   * @param sketch wrapped sketch to read, must outlive the reader
+   */
+  explicit block_reader(const wrapped_compact_theta_sketch_alloc& sketch);
+
+  /**
+   * Moves to the next block of hash values
+   * @return number of hash values in the block, zero past the end
+   */
+  uint32_t next();
+
+  /**
+   * @return pointer to the hash values of the current block
+   */
+  const uint64_t* data() const;
+
+private:
+  const uint8_t* ptr_;
+  uint8_t entry_bits_;
+  uint32_t num_left_;
+  uint64_t previous_;
+  const uint64_t* block_;
+  uint64_t buffer_[BLOCK_SIZE];
+};
+
 } /* namespace datasketches */
 
 #include "theta_sketch_impl.hpp"
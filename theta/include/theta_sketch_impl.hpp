@@ -20,6 +20,7 @@
 #ifndef THETA_SKETCH_IMPL_HPP_
 #define THETA_SKETCH_IMPL_HPP_
 
+#include <algorithm>
 #include <sstream>
 #include <vector>
 #include <stdexcept>
@@ -98,8 +99,8 @@ void theta_sketch_alloc<A>::print_items(std::ostringstream& os) const {
 
 template<typename A>
 update_theta_sketch_alloc<A>::update_theta_sketch_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf,
-    float p, uint64_t theta, uint64_t seed, const A& allocator):
-table_(lg_cur_size, lg_nom_size, rf, p, theta, seed, allocator)
+    float p, uint64_t theta, uint64_t seed, const A& allocator, theta_constants::table_layout layout):
+table_(lg_cur_size, lg_nom_size, rf, p, theta, seed, allocator, true, layout)
 {}
 
 template<typename A>
@@ -208,6 +209,45 @@ void update_theta_sketch_alloc<A>::update(const void* data, size_t length) {
   }
 }
 
+template<typename A>
+void update_theta_sketch_alloc<A>::update_batch(const uint64_t* values, size_t num_values) {
+  update_batch_impl(values, num_values);
+}
+
+template<typename A>
+void update_theta_sketch_alloc<A>::update_batch(const std::string* values, size_t num_values) {
+  update_batch_impl(values, num_values);
+}
+
+template<typename A>
+template<typename T>
+void update_theta_sketch_alloc<A>::update_batch_impl(const T* values, size_t num_values) {
+  /*
+   * Hashing a block of values and prefetching the table slots of those below theta
+   * lets the cache misses of different values overlap instead of running one after another.
+   */
+  uint64_t hashes[BATCH_SIZE];
+  for (size_t start = 0; start < num_values; start += BATCH_SIZE) {
+    const size_t end = std::min(start + BATCH_SIZE, num_values);
+    size_t num_hashes = 0;
+    for (size_t i = start; i < end; ++i) {
+      if (is_ignored(values[i])) continue;
+      const uint64_t hash = table_.hash_and_screen(value_data(values[i]), value_size(values[i]));
+      if (hash == 0) continue;
+      table_.prefetch_slot(hash);
+      hashes[num_hashes++] = hash;
+    }
+    for (size_t i = 0; i < num_hashes; ++i) {
+      // theta may have been lowered by a rebuild triggered earlier in this block
+      if (hashes[i] >= table_.theta_) continue;
+      auto result = table_.find(hashes[i]);
+      if (!result.second) {
+        table_.insert(result.first, hashes[i]);
+      }
+    }
+  }
+}
+
 template<typename A>
 void update_theta_sketch_alloc<A>::trim() {
   table_.trim();
@@ -257,7 +297,8 @@ update_theta_sketch_alloc<A>::builder::builder(const A& allocator): theta_base_b
 
 template<typename A>
 update_theta_sketch_alloc<A> update_theta_sketch_alloc<A>::builder::build() const {
-  return update_theta_sketch_alloc(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->allocator_);
+  return update_theta_sketch_alloc(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->allocator_,
+      this->layout_);
 }
 
 // compact sketch
@@ -685,29 +726,11 @@ compact_theta_sketch_alloc<A> compact_theta_sketch_alloc<A>::deserialize_v4(
   for (unsigned i = 0; i < num_entries_bytes; ++i) {
     num_entries |= read<uint8_t>(is) << (i << 3);
   }
-  vector_bytes buffer(entry_bits, 0, allocator); // block of 8 entries takes entry_bits bytes
-  std::vector<uint64_t, A> entries(num_entries, 0, allocator);
-
-  // unpack blocks of 8 deltas
-  unsigned i;
-  for (i = 0; i + 7 < num_entries; i += 8) {
-    read(is, buffer.data(), buffer.size());
-    unpack_bits_block8(&entries[i], buffer.data(), entry_bits);
-  }
-  // unpack extra deltas if fewer than 8 of them left
-  if (i < num_entries) read(is, buffer.data(), whole_bytes_to_hold_bits((num_entries - i) * entry_bits));
+  vector_bytes buffer(whole_bytes_to_hold_bits(static_cast<size_t>(num_entries) * entry_bits), 0, allocator);
+  read(is, buffer.data(), buffer.size());
   if (!is.good()) throw std::runtime_error("error reading from std::istream");
-  const uint8_t* ptr = buffer.data();
-  uint8_t offset = 0;
-  for (; i < num_entries; ++i) {
-    offset = unpack_bits(entries[i], entry_bits, ptr, offset);
-  }
-  // undo deltas
-  uint64_t previous = 0;
-  for (i = 0; i < num_entries; ++i) {
-    entries[i] += previous;
-    previous = entries[i];
-  }
+  std::vector<uint64_t, A> entries(num_entries, 0, allocator);
+  unpack_deltas(entries.data(), buffer.data(), entry_bits, num_entries, buffer.data() + buffer.size());
   const bool is_ordered = flags_byte & (1 << flags::IS_ORDERED);
   return compact_theta_sketch_alloc(is_empty, is_ordered, seed_hash, theta, std::move(entries));
 }
@@ -721,24 +744,8 @@ compact_theta_sketch_alloc<A> compact_theta_sketch_alloc<A>::deserialize(const v
         std::vector<uint64_t, A>(entries, entries + data.num_entries, allocator));
   } else { // version 4
     std::vector<uint64_t, A> entries(data.num_entries, 0, allocator);
-    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data.entries_start_ptr);
-    // unpack blocks of 8 deltas
-    unsigned i;
-    for (i = 0; i + 7 < data.num_entries; i += 8) {
-      unpack_bits_block8(&entries[i], ptr, data.entry_bits);
-      ptr += data.entry_bits;
-    }
-    // unpack extra deltas if fewer than 8 of them left
-    uint8_t offset = 0;
-    for (; i < data.num_entries; ++i) {
-      offset = unpack_bits(entries[i], data.entry_bits, ptr, offset);
-    }
-    // undo deltas
-    uint64_t previous = 0;
-    for (i = 0; i < data.num_entries; ++i) {
-      entries[i] += previous;
-      previous = entries[i];
-    }
+    unpack_deltas(entries.data(), reinterpret_cast<const uint8_t*>(data.entries_start_ptr), data.entry_bits,
+        data.num_entries, reinterpret_cast<const uint8_t*>(bytes) + size);
     return compact_theta_sketch_alloc(data.is_empty, data.is_ordered, data.seed_hash, data.theta, std::move(entries));
   }
 }
@@ -863,12 +870,10 @@ void wrapped_compact_theta_sketch_alloc<Allocator>::const_iterator::unpack1() {
 
 template<typename Allocator>
 void wrapped_compact_theta_sketch_alloc<Allocator>::const_iterator::unpack8() {
-  unpack_bits_block8(buffer_, reinterpret_cast<const uint8_t*>(ptr_), entry_bits_);
-  ptr_ = reinterpret_cast<const uint8_t*>(ptr_) + entry_bits_;
-  for (int i = 0; i < 8; ++i) {
-    buffer_[i] += previous_;
-    previous_ = buffer_[i];
-  }
+  const uint8_t* ptr = reinterpret_cast<const uint8_t*>(ptr_);
+  const uint8_t* end = ptr + whole_bytes_to_hold_bits(static_cast<size_t>(num_entries_ - index_) * entry_bits_);
+  previous_ = unpack_deltas_block8(buffer_, ptr, entry_bits_, 1, previous_, end);
+  ptr_ = ptr + entry_bits_;
 }
 
 template<typename Allocator>
@@ -902,6 +907,49 @@ auto wrapped_compact_theta_sketch_alloc<Allocator>::const_iterator::operator->()
   return buffer_ + (index_ & 7);
 }
 
+template<typename Allocator>
+const uint32_t wrapped_compact_theta_sketch_alloc<Allocator>::block_reader::BLOCK_SIZE;
+
+template<typename Allocator>
+wrapped_compact_theta_sketch_alloc<Allocator>::block_reader::block_reader(const wrapped_compact_theta_sketch_alloc& sketch):
+ptr_(reinterpret_cast<const uint8_t*>(sketch.data_.entries_start_ptr)),
+entry_bits_(sketch.data_.entry_bits),
+num_left_(sketch.data_.num_entries),
+previous_(0),
+block_(nullptr)
+{}
+
+template<typename Allocator>
+uint32_t wrapped_compact_theta_sketch_alloc<Allocator>::block_reader::next() {
+  const uint32_t num = std::min(num_left_, BLOCK_SIZE);
+  if (entry_bits_ == 64) { // no compression
+    block_ = reinterpret_cast<const uint64_t*>(ptr_);
+    ptr_ += num * sizeof(uint64_t);
+    num_left_ -= num;
+    return num;
+  }
+  const uint8_t* end = ptr_ + whole_bytes_to_hold_bits(static_cast<size_t>(num_left_) * entry_bits_);
+  const uint32_t num_blocks = num / 8;
+  previous_ = unpack_deltas_block8(buffer_, ptr_, entry_bits_, num_blocks, previous_, end);
+  ptr_ += num_blocks * entry_bits_;
+  // only the last block can end with fewer than 8 entries
+  uint8_t offset = 0;
+  for (uint32_t i = num_blocks * 8; i < num; ++i) {
+    offset = unpack_bits(buffer_[i], entry_bits_, ptr_, offset);
+    buffer_[i] += previous_;
+    previous_ = buffer_[i];
+  }
+  num_left_ -= num;
+  return num;
+}
+
+// the buffer is addressed through this, so a copy of the reader points to its own copy of the block
+template<typename Allocator>
+const uint64_t* wrapped_compact_theta_sketch_alloc<Allocator>::block_reader::data() const {
+  if (entry_bits_ == 64) return block_;
+  return buffer_;
+}
+
 } /* namespace datasketches */
 
 #endif
@@ -20,6 +20,7 @@
 #ifndef THETA_UNION_HPP_
 #define THETA_UNION_HPP_
 
+#include "optional.hpp"
 #include "serde.hpp"
 #include "theta_sketch.hpp"
 #include "theta_union_base.hpp"
@@ -44,6 +45,7 @@ public:
   using Sketch = theta_sketch_alloc<Allocator>;
   using CompactSketch = compact_theta_sketch_alloc<Allocator>;
   using resize_factor = theta_constants::resize_factor;
+  using table_layout = theta_constants::table_layout;
 
   // there is no payload in Theta sketch entry
   struct nop_policy {
@@ -64,21 +66,80 @@ public:
   template<typename FwdSketch>
   void update(FwdSketch&& sketch);
 
+  /**
+   * Update the union with a range of sketches.
+   * If all of them are ordered (for instance deserialized or wrapped compact sketches),
+   * their hashes are merged in sorted order and the merge stops at the nominal number of entries,
+   * which avoids inserting every retained hash of every sketch into the hash table.
+   * Otherwise the sketches are added one by one as with update().
+   * @param first iterator to the first sketch
+   * @param last iterator past the last sketch
+   */
+  template<typename FwdIt>
+  void update_many(FwdIt first, FwdIt last);
+
+  /**
+   * Update the union with a range of sketches using several threads.
+   * Each thread unions a contiguous part of the range, the threads skip hashes at or above
+   * the smallest theta any of them has reached, and the partial results are merged at the end.
+   * The result is the same as from updating with the sketches one by one.
+   * The sketches must not be modified and the allocator must be safe to use from several threads
+   * during the call. If an update throws, the exception is rethrown and the union is not changed.
+   * @param first iterator to the first sketch
+   * @param last iterator past the last sketch
+   * @param num_threads number of threads to use, 0 means std::thread::hardware_concurrency()
+   */
+  template<typename FwdIt>
+  void update_parallel(FwdIt first, FwdIt last, unsigned num_threads = 0);
+
   /**
    * Produces a copy of the current state of the union as a compact sketch.
+   * If the union was built with set_cache_result(true), the result is kept
+   * and returned again until the next update or reset, in which case
+   * this method must not be called concurrently from several threads.
    * @param ordered optional flag to specify if an ordered sketch should be produced
    * @return the result of the union
    */
   CompactSketch get_result(bool ordered = true) const;
 
+  /**
+   * Estimate of the distinct count of the union computed from the current state
+   * without producing the result. It uses all retained hashes below theta, which may be more than
+   * the nominal number of entries the result is trimmed to, so it can differ slightly from
+   * the estimate of get_result() while having the same or smaller error.
+   * @return estimate of the distinct count of the union
+   */
+  double get_estimate() const;
+
+  /**
+   * Returns the approximate lower error bound of get_estimate() given a number of standard deviations.
+   * This parameter is similar to the number of standard deviations of the normal distribution
+   * and corresponds to approximately 67%, 95% and 99% confidence intervals.
+   * @param num_std_devs number of Standard Deviations (1, 2 or 3)
+   * @return the lower bound
+   */
+  double get_lower_bound(uint8_t num_std_devs) const;
+
+  /**
+   * Returns the approximate upper error bound of get_estimate() given a number of standard deviations.
+   * This parameter is similar to the number of standard deviations of the normal distribution
+   * and corresponds to approximately 67%, 95% and 99% confidence intervals.
+   * @param num_std_devs number of Standard Deviations (1, 2 or 3)
+   * @return the upper bound
+   */
+  double get_upper_bound(uint8_t num_std_devs) const;
+
   /// Reset the union to the initial empty state
   void reset();
 
 private:
   State state_;
+  bool cache_result_;
+  mutable optional<CompactSketch> cached_result_;
 
   // for builder
-  theta_union_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Allocator& allocator);
+  theta_union_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed,
+      bool cache_result, const Allocator& allocator, theta_constants::table_layout layout);
 };
 
 /// Theta union builder
@@ -87,11 +148,22 @@ class theta_union_alloc<A>::builder: public theta_base_builder<builder, A> {
 public:
   builder(const A& allocator = A());
 
+  /**
+   * Keep the result of get_result() until the next update or reset (defaults to false).
+   * This makes repeated calls without updates in between as cheap as a copy of the result.
+   * @param cache_result true to keep the result
+   * @return this builder
+   */
+  builder& set_cache_result(bool cache_result);
+
   /**
    * Create an instance of the union with predefined parameters.
    * @return an instance of the union
    */
   theta_union_alloc<A> build() const;
+
+private:
+  bool cache_result_;
 };
 
 } /* namespace datasketches */
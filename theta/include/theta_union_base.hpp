@@ -20,6 +20,12 @@
 #ifndef THETA_UNION_BASE_HPP_
 #define THETA_UNION_BASE_HPP_
 
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
 #include "theta_update_sketch_base.hpp"
 
 namespace datasketches {
@@ -38,21 +44,112 @@ public:
   using resize_factor = typename hash_table::resize_factor;
   using comparator = compare_by_key<ExtractKey>;
 
-  theta_union_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator);
+  theta_union_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator,
+      theta_constants::table_layout layout = theta_constants::DEFAULT_TABLE_LAYOUT);
 
   template<typename FwdSketch>
   void update(FwdSketch&& sketch);
 
+  // Unions a range of ordered sketches by merging their sorted entries.
+  // The merge stops at the nominal number of distinct keys, so only that many entries reach the hash table.
+  template<typename FwdIt>
+  void update_ordered(FwdIt first, FwdIt last);
+
+  // Unions a range of sketches on several threads. Each thread unions a contiguous part of the range
+  // into a partial union of its own. The partial unions screen hashes by the smallest theta any of them
+  // has reached so far, and their results are added to this union at the end.
+  // The result is the same as from updating with the sketches one by one.
+  // Zero threads means std::thread::hardware_concurrency().
+  template<typename FwdIt>
+  void update_parallel(FwdIt first, FwdIt last, unsigned num_threads);
+
   CompactSketch get_result(bool ordered = true) const;
 
+  bool is_empty() const;
+
+  // theta of the current state before the result is trimmed to the nominal size
+  uint64_t get_theta64() const;
+
+  // number of retained hashes below get_theta64()
+  uint32_t get_num_retained() const;
+
+  // estimate and bounds from the retained hashes below get_theta64() without building the result
+  double get_estimate() const;
+  double get_lower_bound(uint8_t num_std_devs) const;
+  double get_upper_bound(uint8_t num_std_devs) const;
+
   const Policy& get_policy() const;
 
   void reset();
 
 private:
+  // position in the sorted entries of one input
+  template<typename Iterator>
+  struct merge_cursor {
+    Iterator it;
+    Iterator end;
+
+    bool is_valid() const { return it != end; }
+    auto current() const -> decltype(*std::declval<const Iterator&>()) { return *it; }
+    // returns false past the end
+    bool next() { return ++it != end; }
+  };
+
+  // position in the hash values of a sketch that is read in blocks
+  template<typename Reader>
+  struct block_cursor {
+    Reader reader;
+    uint32_t index;
+    uint32_t size;
+
+    template<typename SS>
+    explicit block_cursor(const SS& sketch): reader(sketch), index(0), size(reader.next()) {}
+
+    bool is_valid() const { return index < size; }
+    uint64_t current() const { return reader.data()[index]; }
+    // returns false past the end
+    bool next() {
+      if (++index < size) return true;
+      index = 0;
+      size = reader.next();
+      return size > 0;
+    }
+  };
+
+  template<typename SS>
+  static auto make_cursor(const SS& sketch, std::false_type) -> merge_cursor<decltype(std::begin(sketch))> {
+    return {std::begin(sketch), std::end(sketch)};
+  }
+  template<typename SS>
+  static block_cursor<typename SS::block_reader> make_cursor(const SS& sketch, std::true_type) {
+    return block_cursor<typename SS::block_reader>(sketch);
+  }
+
+  // the heap holds the current key of each cursor, cursors themselves stay in place
+  struct heap_entry {
+    uint64_t key;
+    uint32_t cursor_index;
+  };
+
+  // std heap functions keep the greatest element in front, so the smallest key compares as greatest
+  struct heap_entry_greater {
+    bool operator()(const heap_entry& a, const heap_entry& b) const { return a.key > b.key; }
+  };
+
   Policy policy_;
   hash_table table_;
   uint64_t union_theta_;
+
+  template<typename SS>
+  void insert_entries(SS&& sketch, std::false_type);
+
+  // hash values are read in blocks, and the table slots of a block are prefetched before probing
+  template<typename SS>
+  void insert_entries(const SS& sketch, std::true_type);
+
+  // work of one thread in update_parallel(), errors are passed back to the calling thread
+  template<typename FwdIt>
+  void update_part(FwdIt first, FwdIt last, std::atomic<uint64_t>& theta_bound, std::exception_ptr& error);
 };
 
 } /* namespace datasketches */
@@ -21,17 +21,21 @@
 #define THETA_UNION_BASE_IMPL_HPP_
 
 #include <algorithm>
+#include <functional>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include "binomial_bounds.hpp"
 #include "conditional_forward.hpp"
 
 namespace datasketches {
 
 template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
 theta_union_base<EN, EK, P, S, CS, A>::theta_union_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf,
-    float p, uint64_t theta, uint64_t seed, const P& policy, const A& allocator):
+    float p, uint64_t theta, uint64_t seed, const P& policy, const A& allocator, theta_constants::table_layout layout):
 policy_(policy),
-table_(lg_cur_size, lg_nom_size, rf, p, theta, seed, allocator),
+table_(lg_cur_size, lg_nom_size, rf, p, theta, seed, allocator, true, layout),
 union_theta_(table_.theta_)
 {}
 
@@ -42,6 +46,13 @@ void theta_union_base<EN, EK, P, S, CS, A>::update(SS&& sketch) {
   if (sketch.get_seed_hash() != compute_seed_hash(table_.seed_)) throw std::invalid_argument("seed hash mismatch");
   table_.is_empty_ = false;
   union_theta_ = std::min(union_theta_, sketch.get_theta64());
+  insert_entries(std::forward<SS>(sketch), typename has_block_reader<SS>::type());
+  union_theta_ = std::min(union_theta_, table_.theta_);
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+void theta_union_base<EN, EK, P, S, CS, A>::insert_entries(SS&& sketch, std::false_type) {
   for (auto&& entry: sketch) {
     const uint64_t hash = EK()(entry);
     if (hash < union_theta_ && hash < table_.theta_) {
@@ -55,9 +66,165 @@ void theta_union_base<EN, EK, P, S, CS, A>::update(SS&& sketch) {
       if (sketch.is_ordered()) break; // early stop
     }
   }
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename SS>
+void theta_union_base<EN, EK, P, S, CS, A>::insert_entries(const SS& sketch, std::true_type) {
+  typename SS::block_reader reader(sketch);
+  uint32_t num;
+  while ((num = reader.next()) > 0) {
+    const uint64_t* hashes = reader.data();
+    for (uint32_t i = 0; i < num; ++i) table_.prefetch_slot(hashes[i]);
+    for (uint32_t i = 0; i < num; ++i) {
+      const uint64_t hash = hashes[i];
+      if (hash < union_theta_ && hash < table_.theta_) {
+        auto result = table_.find(hash);
+        if (!result.second) {
+          table_.insert(result.first, hash);
+        } else {
+          policy_(*result.first, hash);
+        }
+      } else {
+        if (sketch.is_ordered()) return; // early stop
+      }
+    }
+  }
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename FwdIt>
+void theta_union_base<EN, EK, P, S, CS, A>::update_ordered(FwdIt first, FwdIt last) {
+  using block_reader_tag = typename has_block_reader<decltype(*first)>::type;
+  using cursor = decltype(make_cursor(*first, block_reader_tag()));
+  using AllocCursor = typename std::allocator_traits<A>::template rebind_alloc<cursor>;
+  using AllocHeapEntry = typename std::allocator_traits<A>::template rebind_alloc<heap_entry>;
+  std::vector<cursor, AllocCursor> cursors(AllocCursor(table_.allocator_));
+  std::vector<heap_entry, AllocHeapEntry> heap(AllocHeapEntry(table_.allocator_));
+
+  const uint16_t seed_hash = compute_seed_hash(table_.seed_);
+  for (auto it = first; it != last; ++it) {
+    if (it->is_empty()) continue;
+    if (it->get_seed_hash() != seed_hash) throw std::invalid_argument("seed hash mismatch");
+    if (!it->is_ordered()) throw std::invalid_argument("ordered sketches expected");
+    table_.is_empty_ = false;
+    union_theta_ = std::min(union_theta_, it->get_theta64());
+  }
+  const uint64_t theta = std::min(union_theta_, table_.theta_);
+  const auto num_sketches = std::distance(first, last);
+  cursors.reserve(num_sketches);
+  heap.reserve(num_sketches);
+  for (auto it = first; it != last; ++it) {
+    cursor c = make_cursor(*it, block_reader_tag());
+    if (!c.is_valid()) continue;
+    const uint64_t key = EK()(c.current());
+    if (key < theta) {
+      heap.push_back(heap_entry{key, static_cast<uint32_t>(cursors.size())});
+      cursors.push_back(std::move(c));
+    }
+  }
+  std::make_heap(heap.begin(), heap.end(), heap_entry_greater());
+
+  // k-way merge of the distinct keys below theta up to the nominal size
+  const uint32_t nominal_num = 1 << table_.lg_nom_size_;
+  std::vector<EN, A> entries(table_.allocator_);
+  entries.reserve(nominal_num);
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), heap_entry_greater());
+    heap_entry& top = heap.back();
+    cursor& c = cursors[top.cursor_index];
+    if (!entries.empty() && EK()(entries.back()) == top.key) {
+      policy_(entries.back(), c.current());
+    } else {
+      if (entries.size() == nominal_num) {
+        // this key and all greater ones cannot be in the result
+        union_theta_ = std::min(union_theta_, top.key);
+        break;
+      }
+      entries.push_back(c.current());
+    }
+    if (c.next()) {
+      top.key = EK()(c.current());
+      if (top.key < theta) {
+        std::push_heap(heap.begin(), heap.end(), heap_entry_greater());
+        continue;
+      }
+    }
+    heap.pop_back();
+  }
+
+  for (auto& entry: entries) {
+    const uint64_t hash = EK()(entry);
+    if (hash >= table_.theta_) break; // entries are sorted
+    auto result = table_.find(hash);
+    if (!result.second) {
+      table_.insert(result.first, std::move(entry));
+    } else {
+      policy_(*result.first, std::move(entry));
+    }
+  }
   union_theta_ = std::min(union_theta_, table_.theta_);
 }
 
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename FwdIt>
+void theta_union_base<EN, EK, P, S, CS, A>::update_parallel(FwdIt first, FwdIt last, unsigned num_threads) {
+  const size_t num_sketches = std::distance(first, last);
+  if (num_threads == 0) num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  const size_t num_parts = std::min(static_cast<size_t>(num_threads), num_sketches);
+  if (num_parts < 2) {
+    for (; first != last; ++first) update(*first);
+    return;
+  }
+
+  // the partial unions are full size from the start since each of them gets many sketches
+  using AllocUnion = typename std::allocator_traits<A>::template rebind_alloc<theta_union_base>;
+  std::vector<theta_union_base, AllocUnion> partials(AllocUnion(table_.allocator_));
+  partials.reserve(num_parts);
+  for (size_t i = 0; i < num_parts; ++i) {
+    partials.emplace_back(table_.lg_nom_size_ + 1, table_.lg_nom_size_, table_.rf_, table_.p_, get_theta64(), table_.seed_,
+        policy_, table_.allocator_, table_.layout_);
+  }
+  std::atomic<uint64_t> theta_bound(get_theta64());
+  std::vector<std::exception_ptr> errors(num_parts);
+  std::vector<std::thread> threads;
+  threads.reserve(num_parts);
+  try {
+    for (size_t i = 0; i < num_parts; ++i) {
+      FwdIt part_last = first;
+      std::advance(part_last, num_sketches / num_parts + (i < num_sketches % num_parts ? 1 : 0));
+      threads.emplace_back(&theta_union_base::update_part<FwdIt>, &partials[i], first, part_last,
+          std::ref(theta_bound), std::ref(errors[i]));
+      first = part_last;
+    }
+  } catch (...) {
+    for (auto& thread: threads) thread.join();
+    throw;
+  }
+  for (auto& thread: threads) thread.join();
+  for (const auto& error: errors) if (error) std::rethrow_exception(error);
+
+  for (auto& partial: partials) update(partial.get_result(true));
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+template<typename FwdIt>
+void theta_union_base<EN, EK, P, S, CS, A>::update_part(FwdIt first, FwdIt last, std::atomic<uint64_t>& theta_bound,
+    std::exception_ptr& error) {
+  try {
+    for (; first != last; ++first) {
+      // hashes at or above the theta of any partial union cannot be in the final result
+      union_theta_ = std::min(union_theta_, theta_bound.load(std::memory_order_relaxed));
+      update(*first);
+      const uint64_t theta = get_theta64();
+      uint64_t bound = theta_bound.load(std::memory_order_relaxed);
+      while (theta < bound && !theta_bound.compare_exchange_weak(bound, theta, std::memory_order_relaxed)) {}
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
 template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
 CS theta_union_base<EN, EK, P, S, CS, A>::get_result(bool ordered) const {
   std::vector<EN, A> entries(table_.allocator_);
@@ -80,6 +247,46 @@ CS theta_union_base<EN, EK, P, S, CS, A>::get_result(bool ordered) const {
   return CS(table_.is_empty_, ordered, compute_seed_hash(table_.seed_), theta, std::move(entries));
 }
 
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+bool theta_union_base<EN, EK, P, S, CS, A>::is_empty() const {
+  return table_.is_empty_;
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+uint64_t theta_union_base<EN, EK, P, S, CS, A>::get_theta64() const {
+  return std::min(union_theta_, table_.theta_);
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+uint32_t theta_union_base<EN, EK, P, S, CS, A>::get_num_retained() const {
+  if (union_theta_ >= table_.theta_) return table_.num_entries_;
+  return static_cast<uint32_t>(std::count_if(table_.begin(), table_.end(),
+      key_not_zero_less_than<uint64_t, EN, EK>(union_theta_)));
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+double theta_union_base<EN, EK, P, S, CS, A>::get_estimate() const {
+  return get_num_retained() / (static_cast<double>(get_theta64()) / static_cast<double>(theta_constants::MAX_THETA));
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+double theta_union_base<EN, EK, P, S, CS, A>::get_lower_bound(uint8_t num_std_devs) const {
+  const uint64_t theta = get_theta64();
+  const uint32_t num_retained = get_num_retained();
+  if (theta == theta_constants::MAX_THETA || table_.is_empty_) return num_retained;
+  return binomial_bounds::get_lower_bound(num_retained,
+      static_cast<double>(theta) / static_cast<double>(theta_constants::MAX_THETA), num_std_devs);
+}
+
+template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
+double theta_union_base<EN, EK, P, S, CS, A>::get_upper_bound(uint8_t num_std_devs) const {
+  const uint64_t theta = get_theta64();
+  const uint32_t num_retained = get_num_retained();
+  if (theta == theta_constants::MAX_THETA || table_.is_empty_) return num_retained;
+  return binomial_bounds::get_upper_bound(num_retained,
+      static_cast<double>(theta) / static_cast<double>(theta_constants::MAX_THETA), num_std_devs);
+}
+
 template<typename EN, typename EK, typename P, typename S, typename CS, typename A>
 const P& theta_union_base<EN, EK, P, S, CS, A>::get_policy() const {
   return policy_;
@@ -20,35 +20,89 @@
 #ifndef THETA_UNION_IMPL_HPP_
 #define THETA_UNION_IMPL_HPP_
 
+#include <algorithm>
+#include <iterator>
+
 namespace datasketches {
 
 template<typename A>
-theta_union_alloc<A>::theta_union_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const A& allocator):
-state_(lg_cur_size, lg_nom_size, rf, p, theta, seed, nop_policy(), allocator)
+theta_union_alloc<A>::theta_union_alloc(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed,
+    bool cache_result, const A& allocator, theta_constants::table_layout layout):
+state_(lg_cur_size, lg_nom_size, rf, p, theta, seed, nop_policy(), allocator, layout),
+cache_result_(cache_result)
 {}
 
 template<typename A>
 template<typename FwdSketch>
 void theta_union_alloc<A>::update(FwdSketch&& sketch) {
+  cached_result_.reset();
   state_.update(std::forward<FwdSketch>(sketch));
 }
 
+template<typename A>
+template<typename FwdIt>
+void theta_union_alloc<A>::update_many(FwdIt first, FwdIt last) {
+  cached_result_.reset();
+  using reference = typename std::iterator_traits<FwdIt>::reference;
+  if (std::all_of(first, last, [](reference sketch) { return sketch.is_ordered(); })) {
+    state_.update_ordered(first, last);
+  } else {
+    for (; first != last; ++first) state_.update(*first);
+  }
+}
+
+template<typename A>
+template<typename FwdIt>
+void theta_union_alloc<A>::update_parallel(FwdIt first, FwdIt last, unsigned num_threads) {
+  cached_result_.reset();
+  state_.update_parallel(first, last, num_threads);
+}
+
 template<typename A>
 auto theta_union_alloc<A>::get_result(bool ordered) const -> CompactSketch {
-  return state_.get_result(ordered);
+  if (!cache_result_) return state_.get_result(ordered);
+  // an ordered result serves both kinds of requests
+  if (!cached_result_ || (ordered && !cached_result_->is_ordered())) cached_result_ = state_.get_result(ordered);
+  return *cached_result_;
+}
+
+template<typename A>
+double theta_union_alloc<A>::get_estimate() const {
+  return state_.get_estimate();
+}
+
+template<typename A>
+double theta_union_alloc<A>::get_lower_bound(uint8_t num_std_devs) const {
+  return state_.get_lower_bound(num_std_devs);
+}
+
+template<typename A>
+double theta_union_alloc<A>::get_upper_bound(uint8_t num_std_devs) const {
+  return state_.get_upper_bound(num_std_devs);
 }
 
 template<typename A>
 void theta_union_alloc<A>::reset() {
+  cached_result_.reset();
   state_.reset();
 }
 
 template<typename A>
-theta_union_alloc<A>::builder::builder(const A& allocator): theta_base_builder<builder, A>(allocator) {}
+theta_union_alloc<A>::builder::builder(const A& allocator):
+theta_base_builder<builder, A>(allocator),
+cache_result_(false)
+{}
+
+template<typename A>
+auto theta_union_alloc<A>::builder::set_cache_result(bool cache_result) -> builder& {
+  cache_result_ = cache_result;
+  return *this;
+}
 
 template<typename A>
 auto theta_union_alloc<A>::builder::build() const -> theta_union_alloc {
-  return theta_union_alloc(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->allocator_);
+  return theta_union_alloc(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_,
+      cache_result_, this->allocator_, this->layout_);
 }
 
 } /* namespace datasketches */
@@ -24,13 +24,18 @@
 #include <climits>
 #include <cmath>
 #include <iterator>
+#include <type_traits>
 
+#include "common_defs.hpp"
 #include "MurmurHash3.h"
 #include "theta_comparators.hpp"
 #include "theta_constants.hpp"
 
 namespace datasketches {
 
+// forward declaration
+struct trivial_extract_key;
+
 template<
   typename Entry,
   typename ExtractKey,
@@ -38,10 +43,12 @@ template<
 >
 struct theta_update_sketch_base {
   using resize_factor = theta_constants::resize_factor;
+  using table_layout = theta_constants::table_layout;
   using comparator = compare_by_key<ExtractKey>;
 
   theta_update_sketch_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p,
-      uint64_t theta, uint64_t seed, const Allocator& allocator, bool is_empty = true);
+      uint64_t theta, uint64_t seed, const Allocator& allocator, bool is_empty = true,
+      table_layout layout = theta_constants::DEFAULT_TABLE_LAYOUT);
   theta_update_sketch_base(const theta_update_sketch_base& other);
   theta_update_sketch_base(theta_update_sketch_base&& other) noexcept;
   ~theta_update_sketch_base();
@@ -54,7 +61,11 @@ struct theta_update_sketch_base {
 
   inline std::pair<iterator, bool> find(uint64_t key) const;
   static inline std::pair<iterator, bool> find(Entry* entries, uint8_t lg_size, uint64_t key);
+  // SEPARATE_KEYS layout: index of the slot with the key or of the empty slot for it
+  static inline std::pair<uint32_t, bool> find_in_groups(const uint64_t* keys, uint8_t lg_size, uint64_t key);
 
+  // hint the processor to fetch the first slot that find() would probe for a given key
+  inline void prefetch_slot(uint64_t key) const;
 
   template<typename FwdEntry>
   inline void insert(iterator it, FwdEntry&& entry);
@@ -70,6 +81,12 @@ struct theta_update_sketch_base {
   static constexpr uint8_t STRIDE_HASH_BITS = 7;
   static constexpr uint32_t STRIDE_MASK = (1 << STRIDE_HASH_BITS) - 1;
 
+  // SEPARATE_KEYS layout: number of keys in a cache line, probed together
+  static constexpr uint32_t KEY_GROUP_SIZE = 8;
+  // Theta entries are the keys, so there is no separate array of keys to maintain
+  static constexpr bool KEYS_ARE_ENTRIES = std::is_same<Entry, uint64_t>::value
+      && std::is_same<ExtractKey, trivial_extract_key>::value;
+
   Allocator allocator_;
   bool is_empty_;
   uint8_t lg_cur_size_;
@@ -80,6 +97,11 @@ struct theta_update_sketch_base {
   uint64_t theta_;
   uint64_t seed_;
   Entry* entries_;
+  table_layout layout_;
+  // SEPARATE_KEYS layout: keys in the same slots as entries, nullptr otherwise
+  uint64_t* keys_;
+  // allocated memory that keys_ points into unless the keys are the entries
+  uint64_t* keys_storage_;
 
   void resize();
   void rebuild();
@@ -89,6 +111,11 @@ struct theta_update_sketch_base {
   static inline uint32_t get_capacity(uint8_t lg_cur_size, uint8_t lg_nom_size);
   static inline uint32_t get_stride(uint64_t key, uint8_t lg_size);
   static void consolidate_non_empty(Entry* entries, size_t size, size_t num);
+
+  uint64_t* allocate_keys(size_t size);
+  void deallocate_keys(uint64_t* storage, size_t size);
+  uint64_t* keys_of(Entry* entries, uint64_t* storage) const;
+  inline void store_key(iterator it);
 };
 
 
@@ -134,12 +161,25 @@ public:
    */
   Derived& set_seed(uint64_t seed);
 
+  /**
+   * Set the layout of the internal hash table (defaults to DOUBLE_HASHING).
+   * SEPARATE_KEYS keeps the keys in a dense array and compares a cache line of them at once,
+   * so that probing does not touch the entries. This can pay off for Tuple sketches with large summaries
+   * when probe sequences are long. Otherwise DOUBLE_HASHING is usually faster, since finding a key
+   * in a separate array costs one more memory access to reach its entry.
+   * Results do not depend on the layout.
+   * @param layout table layout
+   * @return this builder
+   */
+  Derived& set_table_layout(theta_constants::table_layout layout);
+
 protected:
   Allocator allocator_;
   uint8_t lg_k_;
   resize_factor rf_;
   float p_;
   uint64_t seed_;
+  theta_constants::table_layout layout_;
 
   uint64_t starting_theta() const;
   uint8_t starting_lg_size() const;
@@ -175,6 +215,17 @@ private:
   Key key;
 };
 
+// sketches that provide a block_reader to read their hash values in blocks (wrapped compact Theta sketch)
+
+template<typename Sketch>
+class has_block_reader {
+  template<typename S> static std::true_type test(typename S::block_reader*);
+  template<typename S> static std::false_type test(...);
+public:
+  using type = decltype(test<typename std::decay<Sketch>::type>(nullptr));
+  static const bool value = type::value;
+};
+
 // MurMur3 hash functions
 
 static inline uint64_t compute_hash(const void* data, size_t length, uint64_t seed) {
@@ -25,12 +25,15 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "count_zeros.hpp"
+#include "simd_ops.hpp"
 #include "theta_helpers.hpp"
 
 namespace datasketches {
 
 template<typename EN, typename EK, typename A>
-theta_update_sketch_base<EN, EK, A>::theta_update_sketch_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const A& allocator, bool is_empty):
+theta_update_sketch_base<EN, EK, A>::theta_update_sketch_base(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const A& allocator, bool is_empty,
+    table_layout layout):
 allocator_(allocator),
 is_empty_(is_empty),
 lg_cur_size_(lg_cur_size),
@@ -40,12 +43,17 @@ p_(p),
 num_entries_(0),
 theta_(theta),
 seed_(seed),
-entries_(nullptr)
+entries_(nullptr),
+layout_(layout),
+keys_(nullptr),
+keys_storage_(nullptr)
 {
   if (lg_cur_size > 0) {
     const size_t size = 1ULL << lg_cur_size;
     entries_ = allocator_.allocate(size);
     for (size_t i = 0; i < size; ++i) EK()(entries_[i]) = 0;
+    keys_storage_ = allocate_keys(size);
+    keys_ = keys_of(entries_, keys_storage_);
   }
 }
 
@@ -60,7 +68,10 @@ p_(other.p_),
 num_entries_(other.num_entries_),
 theta_(other.theta_),
 seed_(other.seed_),
-entries_(nullptr)
+entries_(nullptr),
+layout_(other.layout_),
+keys_(nullptr),
+keys_storage_(nullptr)
 {
   if (other.entries_ != nullptr) {
     const size_t size = 1ULL << lg_cur_size_;
@@ -72,6 +83,9 @@ entries_(nullptr)
         EK()(entries_[i]) = 0;
       }
     }
+    keys_storage_ = allocate_keys(size);
+    keys_ = keys_of(entries_, keys_storage_);
+    if (keys_storage_ != nullptr) std::copy(other.keys_, other.keys_ + size, keys_);
   }
 }
 
@@ -86,9 +100,14 @@ p_(other.p_),
 num_entries_(other.num_entries_),
 theta_(other.theta_),
 seed_(other.seed_),
-entries_(other.entries_)
+entries_(other.entries_),
+layout_(other.layout_),
+keys_(other.keys_),
+keys_storage_(other.keys_storage_)
 {
   other.entries_ = nullptr;
+  other.keys_ = nullptr;
+  other.keys_storage_ = nullptr;
 }
 
 template<typename EN, typename EK, typename A>
@@ -100,6 +119,7 @@ theta_update_sketch_base<EN, EK, A>::~theta_update_sketch_base()
       if (EK()(entries_[i]) != 0) entries_[i].~EN();
     }
     allocator_.deallocate(entries_, size);
+    deallocate_keys(keys_storage_, size);
   }
 }
 
@@ -116,6 +136,9 @@ theta_update_sketch_base<EN, EK, A>& theta_update_sketch_base<EN, EK, A>::operat
   std::swap(theta_, copy.theta_);
   std::swap(seed_, copy.seed_);
   std::swap(entries_, copy.entries_);
+  std::swap(layout_, copy.layout_);
+  std::swap(keys_, copy.keys_);
+  std::swap(keys_storage_, copy.keys_storage_);
   return *this;
 }
 
@@ -131,6 +154,9 @@ theta_update_sketch_base<EN, EK, A>& theta_update_sketch_base<EN, EK, A>::operat
   std::swap(theta_, other.theta_);
   std::swap(seed_, other.seed_);
   std::swap(entries_, other.entries_);
+  std::swap(layout_, other.layout_);
+  std::swap(keys_, other.keys_);
+  std::swap(keys_storage_, other.keys_storage_);
   return *this;
 }
 
@@ -144,6 +170,10 @@ uint64_t theta_update_sketch_base<EN, EK, A>::hash_and_screen(const void* data,
 
 template<typename EN, typename EK, typename A>
 auto theta_update_sketch_base<EN, EK, A>::find(uint64_t key) const -> std::pair<iterator, bool> {
+  if (keys_ != nullptr) {
+    const auto result = find_in_groups(keys_, lg_cur_size_, key);
+    return std::pair<iterator, bool>(&entries_[result.first], result.second);
+  }
   return find(entries_, lg_cur_size_, key);
 }
 
@@ -167,10 +197,53 @@ auto theta_update_sketch_base<EN, EK, A>::find(EN* entries, uint8_t lg_size, uin
   throw std::logic_error("key not found and no empty slots!");
 }
 
+// Groups start at multiples of the group size from slot 0, so the probe sequence does not depend on
+// where the array is and a copy of the table finds the same keys in the same slots.
+// A separate array of keys is allocated aligned, so that comparing a group takes one memory access,
+// the entries used as keys may not be. The probe sequence starts at the group the index of the key
+// falls into and steps over an odd number of groups derived from the key, which visits all groups
+// and avoids the clustering of linear probing near the rebuild threshold.
+// Keys are never removed one by one, so a key cannot be found after an empty slot in its probe sequence.
+template<typename EN, typename EK, typename A>
+auto theta_update_sketch_base<EN, EK, A>::find_in_groups(const uint64_t* keys, uint8_t lg_size, uint64_t key) -> std::pair<uint32_t, bool> {
+  const uint32_t mask = (1 << lg_size) - 1;
+  const uint32_t stride = get_stride(key, lg_size) * KEY_GROUP_SIZE;
+  const uint32_t loop_index = static_cast<uint32_t>(key) & mask & ~(KEY_GROUP_SIZE - 1);
+  uint32_t index = loop_index;
+  do {
+    uint32_t result;
+    // only a table smaller than a group wraps around
+    if (index + KEY_GROUP_SIZE <= mask + 1) {
+      result = simd_ops::match_keys_8(&keys[index], key);
+    } else {
+      uint64_t group[KEY_GROUP_SIZE];
+      for (uint32_t i = 0; i < KEY_GROUP_SIZE; ++i) group[i] = keys[(index + i) & mask];
+      result = simd_ops::match_keys_8(group, key);
+    }
+    const uint32_t matches = result & 0xff;
+    const uint32_t empty = result >> 8;
+    if (matches != 0) return std::pair<uint32_t, bool>((index + byte_trailing_zeros_table[matches]) & mask, true);
+    if (empty != 0) return std::pair<uint32_t, bool>((index + byte_trailing_zeros_table[empty]) & mask, false);
+    index = (index + stride) & mask;
+  } while (index != loop_index);
+  throw std::logic_error("key not found and no empty slots!");
+}
+
+template<typename EN, typename EK, typename A>
+void theta_update_sketch_base<EN, EK, A>::prefetch_slot(uint64_t key) const {
+  const uint32_t index = static_cast<uint32_t>(key) & ((1 << lg_cur_size_) - 1);
+  if (keys_ != nullptr) {
+    prefetch(&keys_[index]);
+  } else {
+    prefetch(&entries_[index]);
+  }
+}
+
 template<typename EN, typename EK, typename A>
 template<typename Fwd>
 void theta_update_sketch_base<EN, EK, A>::insert(iterator it, Fwd&& entry) {
   new (it) EN(std::forward<Fwd>(entry));
+  store_key(it);
   ++num_entries_;
   if (num_entries_ > get_capacity(lg_cur_size_, lg_nom_size_)) {
     if (lg_cur_size_ <= lg_nom_size_) {
@@ -210,18 +283,26 @@ void theta_update_sketch_base<EN, EK, A>::resize() {
   const size_t new_size = 1ULL << lg_new_size;
   EN* new_entries = allocator_.allocate(new_size);
   for (size_t i = 0; i < new_size; ++i) EK()(new_entries[i]) = 0;
+  uint64_t* new_keys_storage = allocate_keys(new_size);
+  uint64_t* new_keys = keys_of(new_entries, new_keys_storage);
   for (size_t i = 0; i < old_size; ++i) {
     const uint64_t key = EK()(entries_[i]);
     if (key != 0) {
       // always finds an empty slot in a larger table
-      new (find(new_entries, lg_new_size, key).first) EN(std::move(entries_[i]));
+      EN* slot = new_keys != nullptr ? &new_entries[find_in_groups(new_keys, lg_new_size, key).first]
+          : find(new_entries, lg_new_size, key).first;
+      new (slot) EN(std::move(entries_[i]));
+      if (new_keys_storage != nullptr) new_keys[slot - new_entries] = key;
       entries_[i].~EN();
       EK()(entries_[i]) = 0;
     }
   }
   std::swap(entries_, new_entries);
+  std::swap(keys_storage_, new_keys_storage);
+  keys_ = new_keys;
   lg_cur_size_ = lg_new_size;
   allocator_.deallocate(new_entries, old_size);
+  deallocate_keys(new_keys_storage, old_size);
 }
 
 // assumes number of entries > nominal size
@@ -240,10 +321,14 @@ void theta_update_sketch_base<EN, EK, A>::rebuild() {
   const size_t num_old_entries = num_entries_;
   entries_ = allocator_.allocate(size);
   for (size_t i = 0; i < size; ++i) EK()(entries_[i]) = 0;
+  if (keys_storage_ != nullptr) std::fill(keys_, keys_ + size, 0);
+  keys_ = keys_of(entries_, keys_storage_);
   num_entries_ = nominal_size;
   // relies on consolidating non-empty entries to the front
   for (size_t i = 0; i < nominal_size; ++i) {
-    new (find(EK()(old_entries[i])).first) EN(std::move(old_entries[i]));
+    const iterator it = find(EK()(old_entries[i])).first;
+    new (it) EN(std::move(old_entries[i]));
+    store_key(it);
     old_entries[i].~EN();
   }
   for (size_t i = nominal_size; i < num_old_entries; ++i) old_entries[i].~EN();
@@ -268,10 +353,15 @@ void theta_update_sketch_base<EN, EK, A>::reset() {
       lg_nom_size_ + 1, theta_constants::MIN_LG_K, static_cast<uint8_t>(rf_));
   if (starting_lg_size != lg_cur_size_) {
     allocator_.deallocate(entries_, cur_size);
+    deallocate_keys(keys_storage_, cur_size);
     lg_cur_size_ = starting_lg_size;
     const size_t new_size = 1ULL << starting_lg_size;
     entries_ = allocator_.allocate(new_size);
     for (size_t i = 0; i < new_size; ++i) EK()(entries_[i]) = 0;
+    keys_storage_ = allocate_keys(new_size);
+    keys_ = keys_of(entries_, keys_storage_);
+  } else if (keys_storage_ != nullptr) {
+    std::fill(keys_, keys_ + cur_size, 0);
   }
   num_entries_ = 0;
   theta_ = theta_build_helper<true>::starting_theta_from_p(p_);
@@ -298,6 +388,38 @@ void theta_update_sketch_base<EN, EK, A>::consolidate_non_empty(EN* entries, siz
   }
 }
 
+// the array of keys has room to be aligned to a cache line
+template<typename EN, typename EK, typename A>
+uint64_t* theta_update_sketch_base<EN, EK, A>::allocate_keys(size_t size) {
+  if (layout_ != table_layout::SEPARATE_KEYS || KEYS_ARE_ENTRIES) return nullptr;
+  using AllocU64 = typename std::allocator_traits<A>::template rebind_alloc<uint64_t>;
+  AllocU64 alloc(allocator_);
+  uint64_t* storage = alloc.allocate(size + KEY_GROUP_SIZE - 1);
+  std::fill(storage, storage + size + KEY_GROUP_SIZE - 1, 0);
+  return storage;
+}
+
+template<typename EN, typename EK, typename A>
+void theta_update_sketch_base<EN, EK, A>::deallocate_keys(uint64_t* storage, size_t size) {
+  if (storage == nullptr) return;
+  using AllocU64 = typename std::allocator_traits<A>::template rebind_alloc<uint64_t>;
+  AllocU64 alloc(allocator_);
+  alloc.deallocate(storage, size + KEY_GROUP_SIZE - 1);
+}
+
+template<typename EN, typename EK, typename A>
+uint64_t* theta_update_sketch_base<EN, EK, A>::keys_of(EN* entries, uint64_t* storage) const {
+  if (layout_ != table_layout::SEPARATE_KEYS) return nullptr;
+  if (KEYS_ARE_ENTRIES) return reinterpret_cast<uint64_t*>(entries);
+  const size_t misalignment = (reinterpret_cast<uintptr_t>(storage) / sizeof(uint64_t)) % KEY_GROUP_SIZE;
+  return storage + (KEY_GROUP_SIZE - misalignment) % KEY_GROUP_SIZE;
+}
+
+template<typename EN, typename EK, typename A>
+void theta_update_sketch_base<EN, EK, A>::store_key(iterator it) {
+  if (keys_storage_ != nullptr) keys_[it - entries_] = EK()(*it);
+}
+
 // builder
 
 template<typename Derived, typename Allocator>
@@ -306,7 +428,8 @@ allocator_(allocator),
 lg_k_(theta_constants::DEFAULT_LG_K),
 rf_(theta_constants::DEFAULT_RESIZE_FACTOR),
 p_(1),
-seed_(DEFAULT_SEED) {}
+seed_(DEFAULT_SEED),
+layout_(theta_constants::DEFAULT_TABLE_LAYOUT) {}
 
 template<typename Derived, typename Allocator>
 Derived& theta_base_builder<Derived, Allocator>::set_lg_k(uint8_t lg_k) {
@@ -339,6 +462,12 @@ Derived& theta_base_builder<Derived, Allocator>::set_seed(uint64_t seed) {
   return static_cast<Derived&>(*this);
 }
 
+template<typename Derived, typename Allocator>
+Derived& theta_base_builder<Derived, Allocator>::set_table_layout(theta_constants::table_layout layout) {
+  layout_ = layout;
+  return static_cast<Derived&>(*this);
+}
+
 template<typename Derived, typename Allocator>
 uint64_t theta_base_builder<Derived, Allocator>::starting_theta() const {
   return theta_build_helper<true>::starting_theta_from_p(p_);
@@ -18,6 +18,8 @@
  */
 
 #include <catch2/catch.hpp>
+#include <vector>
+
 #include <bit_packing.hpp>
 
 namespace datasketches {
@@ -130,4 +132,52 @@ TEST_CASE("pack blocks unpack bits") {
   }
 }
 
+TEST_CASE("unpack deltas") {
+  uint64_t value = 0xaa55aa55aa55aa55ULL; // arbitrary starting value
+  // numbers of values with and without a partial block at the end
+  for (uint32_t n: {0, 1, 7, 8, 9, 16, 63, 64, 200}) {
+    for (uint8_t bits = 1; bits <= 63; ++bits) {
+      const uint64_t mask = (1ULL << bits) - 1;
+      std::vector<uint64_t> deltas(n, 0);
+      for (uint32_t i = 0; i < n; ++i) {
+        deltas[i] = value & mask;
+        value += IGOLDEN64;
+      }
+      // packed the way compressed compact theta sketches are
+      std::vector<uint8_t> bytes((n * bits + 7) / 8, 0);
+      uint8_t* ptr = bytes.data();
+      uint32_t i;
+      for (i = 0; i + 7 < n; i += 8) {
+        pack_bits_block8(&deltas[i], ptr, bits);
+        ptr += bits;
+      }
+      uint8_t offset = 0;
+      for (; i < n; ++i) {
+        offset = pack_bits(deltas[i], bits, ptr, offset);
+      }
+
+      std::vector<uint64_t> expected(n, 0);
+      uint64_t previous = 0;
+      for (i = 0; i < n; ++i) {
+        previous += deltas[i];
+        expected[i] = previous;
+      }
+      // the buffer ends with the packed data, so word loads must stop before the last blocks
+      for (auto level: {simd_ops::SCALAR, simd_ops::AVX2, simd_ops::AVX512}) {
+        if (level > simd_ops::get_simd_level()) continue;
+        std::vector<uint64_t> output(n, 0);
+        const uint64_t last = unpack_deltas_block8(output.data(), bytes.data(), bits, n / 8, 0,
+            bytes.data() + bytes.size(), level);
+        if (n >= 8) REQUIRE(last == expected[n / 8 * 8 - 1]);
+        for (i = 0; i < n / 8 * 8; ++i) {
+          REQUIRE(output[i] == expected[i]);
+        }
+      }
+      std::vector<uint64_t> output(n, 0);
+      unpack_deltas(output.data(), bytes.data(), bits, n, bytes.data() + bytes.size());
+      REQUIRE(output == expected);
+    }
+  }
+}
+
 } /* namespace datasketches */
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <thread>
+#include <vector>
+
+#include "concurrent_theta_sketch.hpp"
+
+namespace datasketches {
+
+TEST_CASE("concurrent theta sketch: builder", "[concurrent_theta_sketch]") {
+  REQUIRE_THROWS_AS(concurrent_theta_sketch::builder().set_max_concurrency_error(-0.1), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_theta_sketch::builder().set_max_concurrency_error(1.1), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_theta_sketch::builder().set_local_lg_k(27), std::invalid_argument);
+  REQUIRE_THROWS_AS(concurrent_theta_sketch::builder().set_lg_k(5).set_local_lg_k(6).build(), std::invalid_argument);
+
+  auto sketch = concurrent_theta_sketch::builder().set_lg_k(10).set_local_lg_k(3).set_max_concurrency_error(0.1).build();
+  REQUIRE(sketch.get_lg_k() == 10);
+  REQUIRE(sketch.get_local_lg_k() == 3);
+  REQUIRE(sketch.get_max_concurrency_error() == 0.1);
+  REQUIRE(sketch.get_seed_hash() == compute_seed_hash(DEFAULT_SEED));
+}
+
+TEST_CASE("concurrent theta sketch: empty", "[concurrent_theta_sketch]") {
+  auto sketch = concurrent_theta_sketch::builder().build();
+  {
+    concurrent_theta_sketch::writer writer(sketch);
+    writer.update(std::string(""));
+  }
+  REQUIRE(sketch.is_empty());
+  REQUIRE(sketch.get_num_retained() == 0);
+  REQUIRE(sketch.get_theta() == 1.0);
+  REQUIRE(sketch.get_estimate() == 0.0);
+  REQUIRE(sketch.get_lower_bound(1) == 0.0);
+  REQUIRE(sketch.get_upper_bound(1) == 0.0);
+  REQUIRE(sketch.get_result().is_empty());
+}
+
+TEST_CASE("concurrent theta sketch: non-empty no retained entries", "[concurrent_theta_sketch]") {
+  auto sketch = concurrent_theta_sketch::builder().set_p(0.001f).build();
+  concurrent_theta_sketch::writer writer(sketch);
+  writer.update(1);
+  // the first update is propagated although it is not retained
+  REQUIRE_FALSE(sketch.is_empty());
+  REQUIRE(sketch.get_num_retained() == 0);
+  REQUIRE(sketch.get_theta() == Approx(0.001).margin(1e-10));
+  REQUIRE(sketch.get_estimate() == 0.0);
+  REQUIRE_FALSE(sketch.get_result().is_empty());
+}
+
+TEST_CASE("concurrent theta sketch: matches update sketch in exact mode", "[concurrent_theta_sketch]") {
+  auto sketch = concurrent_theta_sketch::builder().build();
+  auto update_sketch = update_theta_sketch::builder().build();
+  {
+    concurrent_theta_sketch::writer writer(sketch);
+    for (int i = 0; i < 2000; ++i) {
+      writer.update(i);
+      writer.update(static_cast<double>(i));
+      update_sketch.update(i);
+      update_sketch.update(static_cast<double>(i));
+    }
+    writer.update(std::string("a"));
+    update_sketch.update(std::string("a"));
+  }
+  REQUIRE_FALSE(sketch.is_empty());
+  REQUIRE(sketch.get_estimate() == update_sketch.get_estimate());
+  REQUIRE(sketch.get_num_retained() == update_sketch.get_num_retained());
+
+  const auto result = sketch.get_result();
+  const auto expected = update_sketch.compact();
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("concurrent theta sketch: estimation mode", "[concurrent_theta_sketch]") {
+  auto sketch = concurrent_theta_sketch::builder().set_lg_k(10).build();
+  const int n = 100000;
+  concurrent_theta_sketch::writer writer(sketch);
+  for (int i = 0; i < n; ++i) writer.update(i);
+
+  // a writer holds at most 2^local_lg_k hashes back
+  REQUIRE(sketch.get_theta() < 1.0);
+  REQUIRE(sketch.get_estimate() == Approx(n).margin(n * 0.1));
+
+  writer.flush();
+  REQUIRE(sketch.get_estimate() == Approx(n).margin(n * 0.1));
+  REQUIRE(sketch.get_lower_bound(2) < n);
+  REQUIRE(sketch.get_upper_bound(2) > n);
+  const auto result = sketch.get_result();
+  REQUIRE(result.get_num_retained() <= 1 << 10);
+  REQUIRE(result.get_estimate() == Approx(n).margin(n * 0.1));
+}
+
+TEST_CASE("concurrent theta sketch: concurrent updates", "[concurrent_theta_sketch]") {
+  auto sketch = concurrent_theta_sketch::builder().set_lg_k(12).build();
+  const int num_threads = 4;
+  const int n = 50000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&sketch, t, n]() {
+      concurrent_theta_sketch::writer writer(sketch);
+      // every thread shares half of its values with the next one
+      for (int i = 0; i < n; ++i) writer.update(t * n / 2 + i);
+    });
+  }
+  // estimates may be read at the same time and never see a partially propagated buffer
+  for (int i = 0; i < 100; ++i) {
+    const double estimate = sketch.get_estimate();
+    REQUIRE(estimate >= 0);
+    REQUIRE(estimate <= (num_threads + 1) * n / 2 * 1.1);
+  }
+  for (auto& thread: threads) thread.join();
+
+  const double expected = (num_threads + 1) * n / 2;
+  REQUIRE(sketch.get_estimate() == Approx(expected).margin(expected * 0.05));
+  REQUIRE(sketch.get_result().get_estimate() == Approx(expected).margin(expected * 0.05));
+  REQUIRE(sketch.get_lower_bound(3) <= expected);
+  REQUIRE(sketch.get_upper_bound(3) >= expected);
+}
+
+} /* namespace datasketches */
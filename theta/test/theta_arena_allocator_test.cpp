@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <vector>
+
+#include "arena_allocator.hpp"
+#include "test_allocator.hpp"
+#include "theta_union.hpp"
+#include "theta_intersection.hpp"
+#include "theta_a_not_b.hpp"
+
+namespace datasketches {
+
+using arena_type = monotonic_arena_alloc<test_allocator<char>>;
+using allocator = arena_allocator<uint64_t, test_allocator<char>>;
+
+static std::vector<compact_theta_sketch> make_sketches() {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 4; ++i) {
+    auto sketch = update_theta_sketch::builder().set_lg_k(10).build();
+    for (int j = 0; j < 5000; ++j) sketch.update(i * 1000 + j);
+    sketches.push_back(sketch.compact(i % 2 == 0));
+  }
+  return sketches;
+}
+
+template<typename S1, typename S2>
+static bool same_sketch(const S1& a, const S2& b) {
+  return a.is_empty() == b.is_empty() && a.get_theta64() == b.get_theta64()
+      && a.get_num_retained() == b.get_num_retained() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+TEST_CASE("theta set operations with arena allocator", "[theta_arena_allocator]") {
+  const auto sketches = make_sketches();
+
+  auto u = theta_union::builder().set_lg_k(10).build();
+  for (const auto& sketch: sketches) u.update(sketch);
+  const auto expected_union = u.get_result();
+  theta_intersection intersection;
+  for (const auto& sketch: sketches) intersection.update(sketch);
+  const auto expected_intersection = intersection.get_result();
+  const auto expected_a_not_b = theta_a_not_b().compute(sketches[0], sketches[1]);
+  const auto expected_a_not_empty = theta_a_not_b().compute(sketches[1], compact_theta_sketch(update_theta_sketch::builder().build(), true));
+
+  test_allocator_total_bytes = 0;
+  test_allocator_net_allocations = 0;
+  {
+    arena_type arena(4096, test_allocator<char>(0));
+    const allocator alloc(arena);
+    size_t num_blocks = 0;
+    for (int pass = 0; pass < 10; ++pass) {
+      {
+        auto arena_union = theta_union_alloc<allocator>::builder(alloc).set_lg_k(10).build();
+        for (const auto& sketch: sketches) arena_union.update(sketch);
+        const auto union_result = arena_union.get_result();
+        REQUIRE(same_sketch(union_result, expected_union));
+
+        theta_intersection_alloc<allocator> arena_intersection(DEFAULT_SEED, alloc);
+        for (const auto& sketch: sketches) arena_intersection.update(sketch);
+        REQUIRE(same_sketch(arena_intersection.get_result(), expected_intersection));
+
+        theta_a_not_b_alloc<allocator> a_not_b(DEFAULT_SEED, alloc);
+        REQUIRE(same_sketch(a_not_b.compute(sketches[0], sketches[1]), expected_a_not_b));
+        const auto empty = compact_theta_sketch_alloc<allocator>(update_theta_sketch_alloc<allocator>::builder(alloc).build(), true);
+        REQUIRE(same_sketch(a_not_b.compute(sketches[1], empty), expected_a_not_empty));
+        // results of set operations can be inputs of further set operations
+        REQUIRE(same_sketch(a_not_b.compute(union_result, sketches[1]), theta_a_not_b().compute(expected_union, sketches[1])));
+      }
+      if (pass == 0) {
+        num_blocks = arena.get_num_blocks();
+        REQUIRE(num_blocks > 0);
+      } else {
+        // nothing is taken from upstream after the first pass
+        REQUIRE(arena.get_num_blocks() == num_blocks);
+      }
+      arena.reset();
+    }
+  }
+  REQUIRE(test_allocator_total_bytes == 0);
+  REQUIRE(test_allocator_net_allocations == 0);
+}
+
+} /* namespace datasketches */
@@ -22,6 +22,7 @@
 #include <theta_intersection.hpp>
 
 #include <stdexcept>
+#include <vector>
 
 namespace datasketches {
 
@@ -237,4 +238,113 @@ TEST_CASE("theta intersection: seed mismatch", "[theta_intersection]") {
   REQUIRE_THROWS_AS(intersection.update(sketch), std::invalid_argument);
 }
 
+TEST_CASE("theta intersection: update many ordered", "[theta_intersection]") {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 8; ++i) {
+    auto update_sketch = update_theta_sketch::builder().set_lg_k(i == 3 ? 8 : 12).build();
+    for (int j = 0; j < 20000 - i * 1000; ++j) update_sketch.update(i * 500 + j);
+    sketches.push_back(update_sketch.compact());
+  }
+  theta_intersection intersection1;
+  for (const auto& sketch: sketches) intersection1.update(sketch);
+  const auto expected = intersection1.get_result();
+  REQUIRE(expected.get_num_retained() > 0);
+
+  theta_intersection intersection2;
+  intersection2.update_many(sketches.begin(), sketches.end());
+  const auto result = intersection2.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+
+  // one input or after an existing state
+  theta_intersection intersection3;
+  intersection3.update_many(sketches.begin(), sketches.begin() + 1);
+  REQUIRE(intersection3.get_result().get_num_retained() == sketches[0].get_num_retained());
+  intersection3.update_many(sketches.begin() + 1, sketches.end());
+  REQUIRE(intersection3.get_result().get_num_retained() == expected.get_num_retained());
+
+  // a disjoint input
+  auto update_sketch = update_theta_sketch::builder().build();
+  for (int j = 0; j < 1000; ++j) update_sketch.update(-1 - j);
+  sketches.push_back(update_sketch.compact());
+  theta_intersection intersection4;
+  intersection4.update_many(sketches.begin(), sketches.end());
+  REQUIRE(intersection4.get_result().get_num_retained() == 0);
+  REQUIRE(intersection4.get_result().get_theta64() == expected.get_theta64());
+}
+
+TEST_CASE("theta intersection: update many empty", "[theta_intersection]") {
+  std::vector<compact_theta_sketch> sketches;
+  auto update_sketch = update_theta_sketch::builder().build();
+  update_sketch.update(1);
+  sketches.push_back(update_sketch.compact());
+  sketches.push_back(update_theta_sketch::builder().build().compact());
+  theta_intersection intersection;
+  intersection.update_many(sketches.begin(), sketches.end());
+  REQUIRE(intersection.has_result());
+  REQUIRE(intersection.get_result().is_empty());
+
+  theta_intersection intersection2;
+  intersection2.update_many(sketches.begin(), sketches.begin());
+  REQUIRE_FALSE(intersection2.has_result());
+}
+
+TEST_CASE("theta intersection: update many wrapped and unordered", "[theta_intersection]") {
+  std::vector<compact_theta_sketch> sketches;
+  std::vector<compact_theta_sketch::vector_bytes> images;
+  for (int i = 0; i < 3; ++i) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    for (int j = 0; j < 10000; ++j) update_sketch.update(i * 2000 + j);
+    sketches.push_back(update_sketch.compact(i != 1));
+    images.push_back(update_sketch.compact().serialize_compressed());
+  }
+  theta_intersection intersection1;
+  for (const auto& sketch: sketches) intersection1.update(sketch);
+  const auto expected = intersection1.get_result();
+
+  theta_intersection intersection2;
+  intersection2.update_many(sketches.begin(), sketches.end());
+  REQUIRE(intersection2.get_result().get_num_retained() == expected.get_num_retained());
+
+  std::vector<wrapped_compact_theta_sketch> wrapped;
+  for (const auto& bytes: images) wrapped.push_back(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+  theta_intersection intersection3;
+  intersection3.update_many(wrapped.begin(), wrapped.end());
+  const auto result = intersection3.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("theta intersection: wrapped compressed and uncompressed", "[theta_intersection]") {
+  std::vector<compact_theta_sketch> sketches;
+  std::vector<compact_theta_sketch::vector_bytes> images;
+  for (int i = 0; i < 3; ++i) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    for (int j = 0; j < 10000; ++j) update_sketch.update(i * 2000 + j);
+    sketches.push_back(update_sketch.compact());
+    images.push_back(i == 1 ? sketches.back().serialize() : sketches.back().serialize_compressed());
+  }
+  theta_intersection intersection1;
+  for (const auto& sketch: sketches) intersection1.update(sketch);
+  const auto expected = intersection1.get_result();
+
+  theta_intersection intersection2;
+  for (const auto& bytes: images) intersection2.update(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+  const auto result = intersection2.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("theta intersection: update many seed mismatch", "[theta_intersection]") {
+  std::vector<compact_theta_sketch> sketches;
+  auto update_sketch = update_theta_sketch::builder().build();
+  update_sketch.update(1);
+  sketches.push_back(update_sketch.compact());
+  theta_intersection intersection(123);
+  REQUIRE_THROWS_AS(intersection.update_many(sketches.begin(), sketches.end()), std::invalid_argument);
+}
+
 } /* namespace datasketches */
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <algorithm>
 #include <istream>
 #include <fstream>
 #include <sstream>
@@ -167,6 +168,50 @@ TEST_CASE("theta sketch: estimation", "[theta_sketch]") {
   REQUIRE(compact_sketch.get_upper_bound(1) > n);
 }
 
+TEST_CASE("theta sketch: batch update", "[theta_sketch]") {
+  // X1 rebuilds the table within a batch, p < 1 screens values by theta from the start
+  for (auto rf: {update_theta_sketch::resize_factor::X1, update_theta_sketch::resize_factor::X8}) {
+    for (float p: {1.0f, 0.5f}) {
+      for (size_t n: {0, 1, 100, 1000, 50000}) {
+        auto single = update_theta_sketch::builder().set_lg_k(10).set_resize_factor(rf).set_p(p).build();
+        auto batch = update_theta_sketch::builder().set_lg_k(10).set_resize_factor(rf).set_p(p).build();
+        std::vector<uint64_t> values(n);
+        for (size_t i = 0; i < n; ++i) {
+          values[i] = i % 30000;
+          single.update(values[i]);
+        }
+        batch.update_batch(values.data(), values.size());
+        REQUIRE(batch.is_empty() == single.is_empty());
+        REQUIRE(batch.get_theta64() == single.get_theta64());
+        REQUIRE(batch.get_num_retained() == single.get_num_retained());
+        auto expected = single.compact();
+        auto actual = batch.compact();
+        REQUIRE(std::equal(actual.begin(), actual.end(), expected.begin()));
+      }
+    }
+  }
+}
+
+TEST_CASE("theta sketch: batch update strings", "[theta_sketch]") {
+  auto single = update_theta_sketch::builder().set_lg_k(10).build();
+  auto batch = update_theta_sketch::builder().set_lg_k(10).build();
+  std::vector<std::string> values;
+  for (int i = 0; i < 10000; ++i) values.push_back(i % 100 == 0 ? "" : std::to_string(i));
+  for (const auto& value: values) single.update(value);
+  batch.update_batch(values.data(), values.size());
+  REQUIRE(batch.get_theta64() == single.get_theta64());
+  auto expected = single.compact();
+  auto actual = batch.compact();
+  REQUIRE(actual.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(actual.begin(), actual.end(), expected.begin()));
+
+  // empty strings are ignored
+  auto empty = update_theta_sketch::builder().build();
+  const std::string empty_strings[2];
+  empty.update_batch(empty_strings, 2);
+  REQUIRE(empty.is_empty());
+}
+
 TEST_CASE("theta sketch: deserialize compact v1 empty from java", "[theta_sketch]") {
   std::ifstream is;
   is.exceptions(std::ios::failbit | std::ios::badbit);
@@ -599,6 +644,33 @@ TEST_CASE("theta sketch: serialize deserialize compressed", "[theta_sketch]") {
   }
 }
 
+TEST_CASE("theta sketch: wrapped compact block reader", "[theta_sketch]") {
+  // sizes around the block size and with a partial group of 8 at the end
+  for (int n: {0, 1, 7, 8, 64, 65, 1000, 10000}) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    for (int i = 0; i < n; i++) update_sketch.update(i);
+    auto compact_sketch = update_sketch.compact();
+    for (bool compressed: {false, true}) {
+      auto bytes = compressed ? compact_sketch.serialize_compressed() : compact_sketch.serialize();
+      auto wrapped_sketch = wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size());
+      wrapped_compact_theta_sketch::block_reader reader(wrapped_sketch);
+      auto iter = compact_sketch.begin();
+      uint32_t count = 0;
+      uint32_t num;
+      while ((num = reader.next()) > 0) {
+        REQUIRE(num <= wrapped_compact_theta_sketch::block_reader::BLOCK_SIZE);
+        for (uint32_t i = 0; i < num; ++i) {
+          REQUIRE(reader.data()[i] == *iter);
+          ++iter;
+        }
+        count += num;
+      }
+      REQUIRE(count == compact_sketch.get_num_retained());
+      REQUIRE(reader.next() == 0);
+    }
+  }
+}
+
 // The sketch reaches capacity for the first time at 2 * K * 15/16,
 // but at that point it is still in exact mode, so the serialized size is not the maximum
 // (theta in not serialized in the exact mode).
@@ -625,4 +697,51 @@ TEST_CASE("max serialized size", "[theta_sketch]") {
   REQUIRE(max_size_bytes == compact_theta_sketch::get_max_serialized_size_bytes(lg_k));
 }
 
+TEST_CASE("theta sketch: separate keys table layout", "[theta_sketch]") {
+  const uint8_t lg_k = 10;
+  for (int rf = 0; rf <= 3; ++rf) {
+    const auto resize_factor = static_cast<theta_constants::resize_factor>(rf);
+    auto sketch1 = update_theta_sketch::builder().set_lg_k(lg_k).set_resize_factor(resize_factor).build();
+    auto sketch2 = update_theta_sketch::builder().set_lg_k(lg_k).set_resize_factor(resize_factor)
+        .set_table_layout(update_theta_sketch::table_layout::SEPARATE_KEYS).build();
+    for (int n: {100, 1000, 10000}) {
+      for (int i = 0; i < n; ++i) {
+        sketch1.update(i);
+        sketch2.update(i);
+      }
+      // duplicates
+      for (int i = 0; i < n; ++i) sketch2.update(i);
+      REQUIRE(sketch2.get_num_retained() == sketch1.get_num_retained());
+      REQUIRE(sketch2.get_theta64() == sketch1.get_theta64());
+      const auto compact1 = sketch1.compact();
+      const auto compact2 = sketch2.compact();
+      REQUIRE(std::equal(compact1.begin(), compact1.end(), compact2.begin()));
+    }
+
+    // a copy finds the keys it already holds
+    auto copy = sketch2;
+    for (int i = 0; i < 10000; ++i) copy.update(i);
+    REQUIRE(copy.get_num_retained() == sketch2.get_num_retained());
+    REQUIRE(copy.get_theta64() == sketch2.get_theta64());
+    auto assigned = sketch1;
+    assigned = sketch2;
+    for (int i = 0; i < 10000; ++i) assigned.update(i);
+    REQUIRE(assigned.get_num_retained() == sketch2.get_num_retained());
+    copy.update(-1);
+    auto moved = std::move(copy);
+    moved.trim();
+    sketch1.update(-1);
+    sketch1.trim();
+    REQUIRE(moved.get_num_retained() == sketch1.get_num_retained());
+    const auto compact1 = sketch1.compact();
+    const auto compact2 = moved.compact();
+    REQUIRE(std::equal(compact1.begin(), compact1.end(), compact2.begin()));
+
+    sketch2.reset();
+    REQUIRE(sketch2.is_empty());
+    sketch2.update(1);
+    REQUIRE(sketch2.get_num_retained() == 1);
+  }
+}
+
 } /* namespace datasketches */
@@ -21,7 +21,9 @@
 
 #include <theta_union.hpp>
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 namespace datasketches {
 
@@ -153,4 +155,253 @@ TEST_CASE("theta union: larger K", "[theta_union]") {
   REQUIRE(result2.get_estimate() == update_sketch3.get_estimate());
 }
 
+TEST_CASE("theta union: update many ordered", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 20; ++i) {
+    auto update_sketch = update_theta_sketch::builder().set_lg_k(i % 2 == 0 ? 10 : 12).build();
+    for (int j = 0; j < 3000 + i * 1000; ++j) update_sketch.update(i * 1500 + j);
+    sketches.push_back(update_sketch.compact());
+  }
+  sketches.push_back(update_theta_sketch::builder().build().compact()); // empty
+
+  auto u1 = theta_union::builder().set_lg_k(11).build();
+  for (const auto& sketch: sketches) u1.update(sketch);
+  const auto expected = u1.get_result();
+
+  auto u2 = theta_union::builder().set_lg_k(11).build();
+  u2.update_many(sketches.begin(), sketches.end());
+  const auto result = u2.get_result();
+  REQUIRE(result.is_estimation_mode());
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+
+  // merged into the existing state
+  auto update_sketch = update_theta_sketch::builder().build();
+  for (int j = 0; j < 1000; ++j) update_sketch.update(-j);
+  u1.update(update_sketch);
+  u2.update(update_sketch);
+  u1.update_many(sketches.begin(), sketches.begin() + 5);
+  for (auto it = sketches.begin(); it != sketches.begin() + 5; ++it) u2.update(*it);
+  REQUIRE(u1.get_result().get_theta64() == u2.get_result().get_theta64());
+  REQUIRE(u1.get_result().get_num_retained() == u2.get_result().get_num_retained());
+}
+
+TEST_CASE("theta union: update many exact mode", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 3; ++i) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    for (int j = 0; j < 1000; ++j) update_sketch.update(i * 500 + j);
+    sketches.push_back(update_sketch.compact());
+  }
+  auto u = theta_union::builder().build();
+  u.update_many(sketches.begin(), sketches.end());
+  const auto result = u.get_result();
+  REQUIRE_FALSE(result.is_estimation_mode());
+  REQUIRE(result.get_estimate() == 2000.0);
+}
+
+TEST_CASE("theta union: update many wrapped and unordered", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  std::vector<compact_theta_sketch::vector_bytes> images;
+  for (int i = 0; i < 4; ++i) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    for (int j = 0; j < 10000; ++j) update_sketch.update(i * 5000 + j);
+    sketches.push_back(update_sketch.compact(i != 2));
+    images.push_back(update_sketch.compact().serialize_compressed());
+  }
+  auto u1 = theta_union::builder().build();
+  for (const auto& sketch: sketches) u1.update(sketch);
+  const auto expected = u1.get_result();
+
+  // one unordered sketch falls back to updating one by one
+  auto u2 = theta_union::builder().build();
+  u2.update_many(sketches.begin(), sketches.end());
+  REQUIRE(u2.get_result().get_theta64() == expected.get_theta64());
+  REQUIRE(u2.get_result().get_num_retained() == expected.get_num_retained());
+
+  std::vector<wrapped_compact_theta_sketch> wrapped;
+  for (const auto& bytes: images) wrapped.push_back(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+  auto u3 = theta_union::builder().build();
+  u3.update_many(wrapped.begin(), wrapped.end());
+  const auto result = u3.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("theta union: wrapped compressed and uncompressed", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  std::vector<compact_theta_sketch::vector_bytes> images;
+  for (int i = 0; i < 4; ++i) {
+    auto update_sketch = update_theta_sketch::builder().build();
+    // exact mode and estimation mode inputs
+    for (int j = 0; j < (i + 1) * 3000; ++j) update_sketch.update(i * 1000 + j);
+    sketches.push_back(update_sketch.compact());
+    images.push_back(i % 2 == 0 ? sketches.back().serialize_compressed() : sketches.back().serialize());
+  }
+  auto union1 = theta_union::builder().build();
+  for (const auto& sketch: sketches) union1.update(sketch);
+  const auto expected = union1.get_result();
+
+  auto union2 = theta_union::builder().build();
+  for (const auto& bytes: images) union2.update(wrapped_compact_theta_sketch::wrap(bytes.data(), bytes.size()));
+  const auto result = union2.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+}
+
+TEST_CASE("theta union: update many seed mismatch", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  auto update_sketch = update_theta_sketch::builder().build();
+  update_sketch.update(1);
+  sketches.push_back(update_sketch.compact());
+  theta_union u = theta_union::builder().set_seed(123).build();
+  REQUIRE_THROWS_AS(u.update_many(sketches.begin(), sketches.end()), std::invalid_argument);
+}
+
+TEST_CASE("theta union: estimate without result", "[theta_union]") {
+  auto u = theta_union::builder().build();
+  REQUIRE(u.get_estimate() == 0.0);
+  REQUIRE(u.get_lower_bound(1) == 0.0);
+  REQUIRE(u.get_upper_bound(1) == 0.0);
+
+  // exact mode
+  auto sketch1 = update_theta_sketch::builder().build();
+  for (int i = 0; i < 1000; ++i) sketch1.update(i);
+  u.update(sketch1);
+  REQUIRE(u.get_estimate() == 1000.0);
+  REQUIRE(u.get_estimate() == u.get_result().get_estimate());
+  REQUIRE(u.get_lower_bound(2) == 1000.0);
+  REQUIRE(u.get_upper_bound(2) == 1000.0);
+
+  // estimation mode
+  auto sketch2 = update_theta_sketch::builder().build();
+  for (int i = 0; i < 100000; ++i) sketch2.update(i + 500);
+  u.update(sketch2);
+  const double estimate = u.get_estimate();
+  REQUIRE(estimate == Approx(100500).margin(100500 * 0.05));
+  REQUIRE(u.get_lower_bound(2) < estimate);
+  REQUIRE(u.get_upper_bound(2) > estimate);
+  const auto result = u.get_result();
+  REQUIRE(estimate == Approx(result.get_estimate()).margin(result.get_estimate() * 0.02));
+
+  // theta of an ordered merge below the theta of the table
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 8; ++i) {
+    auto sketch = update_theta_sketch::builder().build();
+    for (int j = 0; j < 10000; ++j) sketch.update(i * 5000 + j);
+    sketches.push_back(sketch.compact());
+  }
+  auto u2 = theta_union::builder().build();
+  u2.update_many(sketches.begin(), sketches.end());
+  REQUIRE(u2.get_estimate() == Approx(45000).margin(45000 * 0.05));
+  REQUIRE(u2.get_estimate() == Approx(u2.get_result().get_estimate()).margin(45000 * 0.02));
+  REQUIRE(u2.get_lower_bound(3) < u2.get_estimate());
+  REQUIRE(u2.get_upper_bound(3) > u2.get_estimate());
+}
+
+TEST_CASE("theta union: cached result", "[theta_union]") {
+  auto u = theta_union::builder().set_cache_result(true).build();
+  auto u_expected = theta_union::builder().build();
+  REQUIRE(u.get_result().is_empty());
+
+  auto sketch1 = update_theta_sketch::builder().build();
+  for (int i = 0; i < 10000; ++i) sketch1.update(i);
+  u.update(sketch1);
+  u_expected.update(sketch1);
+  const auto result1 = u.get_result();
+  REQUIRE_FALSE(result1.is_empty());
+  REQUIRE(result1.get_estimate() == u_expected.get_result().get_estimate());
+  const auto result2 = u.get_result();
+  REQUIRE(result1.get_num_retained() == result2.get_num_retained());
+  REQUIRE(std::equal(result1.begin(), result1.end(), result2.begin()));
+
+  // an unordered request may be served by an ordered result, not the other way around
+  REQUIRE(u.get_result(false).is_ordered());
+  u.update(sketch1);
+  REQUIRE_FALSE(u.get_result(false).is_ordered());
+  REQUIRE(u.get_result().is_ordered());
+
+  // updated after caching
+  auto sketch2 = update_theta_sketch::builder().build();
+  for (int i = 0; i < 10000; ++i) sketch2.update(i + 5000);
+  u.update(sketch2);
+  u_expected.update(sketch2);
+  REQUIRE(u.get_result().get_estimate() == u_expected.get_result().get_estimate());
+  std::vector<compact_theta_sketch> sketches(1, sketch2.compact());
+  sketches.push_back(sketch1.compact());
+  u.update_many(sketches.begin(), sketches.end());
+  u_expected.update_many(sketches.begin(), sketches.end());
+  REQUIRE(u.get_result().get_estimate() == u_expected.get_result().get_estimate());
+
+  u.reset();
+  REQUIRE(u.get_result().is_empty());
+}
+
+TEST_CASE("theta union: update parallel", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 50; ++i) {
+    auto sketch = update_theta_sketch::builder().set_lg_k(10).build();
+    for (int j = 0; j < 1000 + i * 100; ++j) sketch.update(i * 1000 + j);
+    // mix of ordered and unordered, exact and estimation mode
+    sketches.push_back(sketch.compact(i % 3 != 0));
+  }
+  sketches.push_back(update_theta_sketch::builder().build().compact());
+  auto u_serial = theta_union::builder().set_lg_k(10).build();
+  for (const auto& sketch: sketches) u_serial.update(sketch);
+  const auto expected = u_serial.get_result();
+  REQUIRE(expected.is_estimation_mode());
+
+  const unsigned thread_counts[] = {0, 1, 2, 3, 8, 100};
+  for (unsigned num_threads: thread_counts) {
+    auto u = theta_union::builder().set_lg_k(10).build();
+    u.update_parallel(sketches.begin(), sketches.end(), num_threads);
+    const auto result = u.get_result();
+    REQUIRE(result.get_theta64() == expected.get_theta64());
+    REQUIRE(result.get_num_retained() == expected.get_num_retained());
+    REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+  }
+
+  // on top of the current state
+  auto u = theta_union::builder().set_lg_k(10).build();
+  u.update(sketches[0]);
+  u.update_parallel(sketches.begin() + 1, sketches.end(), 4);
+  const auto result = u.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+
+  // empty range
+  auto u_empty = theta_union::builder().build();
+  u_empty.update_parallel(sketches.begin(), sketches.begin(), 4);
+  REQUIRE(u_empty.get_result().is_empty());
+}
+
+TEST_CASE("theta union: update parallel seed mismatch", "[theta_union]") {
+  std::vector<compact_theta_sketch> sketches;
+  for (int i = 0; i < 8; ++i) {
+    auto sketch = update_theta_sketch::builder().set_seed(i == 5 ? 123 : DEFAULT_SEED).build();
+    sketch.update(i);
+    sketches.push_back(sketch.compact());
+  }
+  auto u = theta_union::builder().build();
+  REQUIRE_THROWS_AS(u.update_parallel(sketches.begin(), sketches.end(), 4), std::invalid_argument);
+  // not changed
+  REQUIRE(u.get_result().is_empty());
+}
+
+TEST_CASE("theta union: copy with separate keys table layout", "[theta_union]") {
+  auto sketch = update_theta_sketch::builder().set_lg_k(12).build();
+  for (int i = 0; i < 1500; ++i) sketch.update(i);
+  auto u = theta_union::builder().set_lg_k(12).set_table_layout(theta_union::table_layout::SEPARATE_KEYS).build();
+  u.update(sketch);
+  // the copy finds the keys it already holds
+  auto copy = u;
+  copy.update(sketch);
+  const auto result = copy.get_result();
+  REQUIRE(result.get_num_retained() == 1500);
+  REQUIRE(result.get_estimate() == u.get_result().get_estimate());
+}
+
 } /* namespace datasketches */
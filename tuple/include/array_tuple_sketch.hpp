@@ -157,6 +157,7 @@ class update_array_tuple_sketch: public update_tuple_sketch<Array, Array, Policy
 public:
   using Base = update_tuple_sketch<Array, Array, Policy, Allocator>;
   using resize_factor = typename Base::resize_factor;
+  using table_layout = typename Base::table_layout;
 
   class builder;
 
@@ -168,7 +169,7 @@ public:
 private:
   // for builder
   update_array_tuple_sketch(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta,
-      uint64_t seed, const Policy& policy, const Allocator& allocator);
+      uint64_t seed, const Policy& policy, const Allocator& allocator, theta_constants::table_layout layout);
 };
 
 /// Update array tuple sketch builder
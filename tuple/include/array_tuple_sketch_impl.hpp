@@ -21,8 +21,8 @@ namespace datasketches {
 
 template<typename Array, typename Policy, typename Allocator>
 update_array_tuple_sketch<Array, Policy, Allocator>::update_array_tuple_sketch(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf,
-    float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator):
-Base(lg_cur_size, lg_nom_size, rf, p, theta, seed, policy, allocator) {}
+    float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator, theta_constants::table_layout layout):
+Base(lg_cur_size, lg_nom_size, rf, p, theta, seed, policy, allocator, layout) {}
 
 template<typename Array, typename Policy, typename Allocator>
 uint8_t update_array_tuple_sketch<Array, Policy, Allocator>::get_num_values() const {
@@ -42,7 +42,8 @@ tuple_base_builder<builder, Policy, Allocator>(policy, allocator) {}
 
 template<typename Array, typename Policy, typename Allocator>
 auto update_array_tuple_sketch<Array, Policy, Allocator>::builder::build() const -> update_array_tuple_sketch {
-  return update_array_tuple_sketch(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_);
+  return update_array_tuple_sketch(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_,
+      this->layout_);
 }
 
 // compact sketch
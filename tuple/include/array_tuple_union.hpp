@@ -57,6 +57,7 @@ public:
   using Base = tuple_union<Array, Policy, Allocator>;
   using CompactSketch = compact_array_tuple_sketch<Array, Allocator>;
   using resize_factor = theta_constants::resize_factor;
+  using table_layout = theta_constants::table_layout;
 
   class builder;
 
@@ -64,7 +65,8 @@ public:
 
 private:
   // for builder
-  array_tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator);
+  array_tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator,
+      theta_constants::table_layout layout);
 };
 
 template<typename Array, typename Policy, typename Allocator>
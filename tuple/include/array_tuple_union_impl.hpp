@@ -20,8 +20,9 @@
 namespace datasketches {
 
 template<typename Array, typename Policy, typename Allocator>
-array_tuple_union<Array, Policy, Allocator>::array_tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator):
-Base(lg_cur_size, lg_nom_size, rf, p, theta, seed, policy, allocator)
+array_tuple_union<Array, Policy, Allocator>::array_tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator,
+    theta_constants::table_layout layout):
+Base(lg_cur_size, lg_nom_size, rf, p, theta, seed, policy, allocator, layout)
 {}
 
 template<typename Array, typename Policy, typename Allocator>
@@ -37,7 +38,8 @@ tuple_base_builder<builder, Policy, typename Array::allocator_type>(policy, allo
 
 template<typename Array, typename Policy, typename Allocator>
 auto array_tuple_union<Array, Policy, Allocator>::builder::build() const -> array_tuple_union {
-  return array_tuple_union(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_);
+  return array_tuple_union(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_,
+      this->layout_);
 }
 
 } /* namespace datasketches */
@@ -17,6 +17,9 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <iterator>
+
 namespace datasketches {
 
 template<typename S, typename P, typename A>
@@ -30,6 +33,17 @@ void tuple_intersection<S, P, A>::update(SS&& sketch) {
   state_.update(std::forward<SS>(sketch));
 }
 
+template<typename S, typename P, typename A>
+template<typename FwdIt>
+void tuple_intersection<S, P, A>::update_many(FwdIt first, FwdIt last) {
+  using reference = typename std::iterator_traits<FwdIt>::reference;
+  if (std::all_of(first, last, [](reference sketch) { return sketch.is_ordered(); })) {
+    state_.update_ordered(first, last);
+  } else {
+    for (; first != last; ++first) state_.update(*first);
+  }
+}
+
 template<typename S, typename P, typename A>
 auto tuple_intersection<S, P, A>::get_result(bool ordered) const -> CompactSketch {
   return state_.get_result(ordered);
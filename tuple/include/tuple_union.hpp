@@ -50,6 +50,7 @@ public:
   using CompactSketch = compact_tuple_sketch<Summary, Allocator>;
   using AllocEntry = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
   using resize_factor = theta_constants::resize_factor;
+  using table_layout = theta_constants::table_layout;
 
   // reformulate the external policy that operates on Summary
   // in terms of operations on Entry
@@ -77,6 +78,21 @@ public:
   template<typename FwdSketch>
   void update(FwdSketch&& sketch);
 
+  /**
+   * Update the union with a range of sketches using several threads.
+   * Each thread unions a contiguous part of the range into a partial union with its own copy of the policy,
+   * the threads skip hashes at or above the smallest theta any of them has reached,
+   * and the partial results are merged at the end.
+   * The result is the same as from updating with the sketches one by one if the policy is associative.
+   * The sketches must not be modified and the allocator must be safe to use from several threads
+   * during the call. If an update throws, the exception is rethrown and the union is not changed.
+   * @param first iterator to the first sketch
+   * @param last iterator past the last sketch
+   * @param num_threads number of threads to use, 0 means std::thread::hardware_concurrency()
+   */
+  template<typename FwdIt>
+  void update_parallel(FwdIt first, FwdIt last, unsigned num_threads = 0);
+
   /**
    * Produces a copy of the current state of the union as a compact sketch.
    * @param ordered optional flag to specify if an ordered sketch should be produced
@@ -93,7 +109,8 @@ protected:
   State state_;
 
   // for builder
-  tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator);
+  tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const Policy& policy, const Allocator& allocator,
+      theta_constants::table_layout layout);
 };
 
 /// Tuple union builder
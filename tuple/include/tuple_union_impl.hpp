@@ -20,8 +20,9 @@
 namespace datasketches {
 
 template<typename S, typename P, typename A>
-tuple_union<S, P, A>::tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const P& policy, const A& allocator):
-state_(lg_cur_size, lg_nom_size, rf, p, theta, seed, internal_policy(policy), allocator)
+tuple_union<S, P, A>::tuple_union(uint8_t lg_cur_size, uint8_t lg_nom_size, resize_factor rf, float p, uint64_t theta, uint64_t seed, const P& policy, const A& allocator,
+    theta_constants::table_layout layout):
+state_(lg_cur_size, lg_nom_size, rf, p, theta, seed, internal_policy(policy), allocator, layout)
 {}
 
 template<typename S, typename P, typename A>
@@ -30,6 +31,12 @@ void tuple_union<S, P, A>::update(SS&& sketch) {
   state_.update(std::forward<SS>(sketch));
 }
 
+template<typename S, typename P, typename A>
+template<typename FwdIt>
+void tuple_union<S, P, A>::update_parallel(FwdIt first, FwdIt last, unsigned num_threads) {
+  state_.update_parallel(first, last, num_threads);
+}
+
 template<typename S, typename P, typename A>
 auto tuple_union<S, P, A>::get_result(bool ordered) const -> CompactSketch {
   return state_.get_result(ordered);
@@ -46,7 +53,8 @@ tuple_base_builder<builder, P, A>(policy, allocator) {}
 
 template<typename S, typename P, typename A>
 auto tuple_union<S, P, A>::builder::build() const -> tuple_union {
-  return tuple_union(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_);
+  return tuple_union(this->starting_lg_size(), this->lg_k_, this->rf_, this->p_, this->starting_theta(), this->seed_, this->policy_, this->allocator_,
+      this->layout_);
 }
 
 } /* namespace datasketches */
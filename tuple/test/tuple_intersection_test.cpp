@@ -23,6 +23,7 @@
 #include <tuple_intersection.hpp>
 #include <theta_sketch.hpp>
 #include <stdexcept>
+#include <vector>
 
 namespace datasketches {
 
@@ -230,4 +231,40 @@ TEST_CASE("tuple intersection: seed mismatch", "[tuple_intersection]") {
   REQUIRE_THROWS_AS(intersection.update(sketch), std::invalid_argument);
 }
 
+TEST_CASE("tuple intersection: update many ordered", "[tuple_intersection]") {
+  std::vector<compact_tuple_sketch<float>> sketches;
+  for (int i = 0; i < 4; ++i) {
+    auto update_sketch = update_tuple_sketch<float>::builder().set_lg_k(i == 2 ? 9 : 12).build();
+    for (int j = 0; j < 10000; ++j) update_sketch.update(i * 1000 + j, static_cast<float>(i + 1));
+    sketches.push_back(update_sketch.compact());
+  }
+  tuple_intersection_float intersection1;
+  for (const auto& sketch: sketches) intersection1.update(sketch);
+  const auto expected = intersection1.get_result();
+  REQUIRE(expected.get_num_retained() > 0);
+
+  // the policy is applied in the order of the inputs
+  tuple_intersection_float intersection2;
+  intersection2.update_many(sketches.begin(), sketches.end());
+  const auto result = intersection2.get_result();
+  REQUIRE(result.get_theta64() == expected.get_theta64());
+  REQUIRE(result.get_num_retained() == expected.get_num_retained());
+  auto it = expected.begin();
+  for (const auto& entry: result) {
+    REQUIRE(entry.first == it->first);
+    REQUIRE(entry.second == it->second);
+    REQUIRE(entry.second == 1.0f - 2.0f - 3.0f - 4.0f);
+    ++it;
+  }
+
+  // the existing state comes first, and update() can follow update_many()
+  tuple_intersection_float intersection3;
+  intersection3.update(sketches[0]);
+  intersection3.update_many(sketches.begin() + 1, sketches.end() - 1);
+  intersection3.update(sketches.back());
+  const auto result3 = intersection3.get_result();
+  REQUIRE(result3.get_num_retained() == expected.get_num_retained());
+  for (const auto& entry: result3) REQUIRE(entry.second == 1.0f - 2.0f - 3.0f - 4.0f);
+}
+
 } /* namespace datasketches */
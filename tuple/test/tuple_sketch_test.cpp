@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <tuple>
 
@@ -371,4 +372,43 @@ TEST_CASE("filter", "[tuple_sketch]") {
   }
 }
 
+TEST_CASE("tuple sketch: separate keys table layout", "[tuple_sketch]") {
+  using sketch_type = update_tuple_sketch<float>;
+  for (int rf = 0; rf <= 3; ++rf) {
+    const auto resize_factor = static_cast<theta_constants::resize_factor>(rf);
+    auto sketch1 = sketch_type::builder().set_lg_k(10).set_resize_factor(resize_factor).build();
+    auto sketch2 = sketch_type::builder().set_lg_k(10).set_resize_factor(resize_factor)
+        .set_table_layout(sketch_type::table_layout::SEPARATE_KEYS).build();
+    for (int n: {100, 1000, 10000}) {
+      for (int i = 0; i < n; ++i) {
+        sketch1.update(i, 1.0f);
+        sketch1.update(i, 1.0f);
+        sketch2.update(i, 1.0f);
+        sketch2.update(i, 1.0f);
+      }
+      REQUIRE(sketch2.get_num_retained() == sketch1.get_num_retained());
+      REQUIRE(sketch2.get_theta64() == sketch1.get_theta64());
+      const auto compact1 = sketch1.compact();
+      const auto compact2 = sketch2.compact();
+      REQUIRE(std::equal(compact1.begin(), compact1.end(), compact2.begin()));
+    }
+
+    auto copy = sketch2;
+    copy.update(-1, 1.0f);
+    auto moved = std::move(copy);
+    moved.trim();
+    sketch1.update(-1, 1.0f);
+    sketch1.trim();
+    REQUIRE(moved.get_num_retained() == sketch1.get_num_retained());
+    const auto compact1 = sketch1.compact();
+    const auto compact2 = moved.compact();
+    REQUIRE(std::equal(compact1.begin(), compact1.end(), compact2.begin()));
+
+    sketch2.reset();
+    REQUIRE(sketch2.is_empty());
+    sketch2.update(1, 1.0f);
+    REQUIRE(sketch2.get_num_retained() == 1);
+  }
+}
+
 } /* namespace datasketches */
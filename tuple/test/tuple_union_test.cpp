@@ -17,8 +17,10 @@
  * under the License.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include <catch2/catch.hpp>
 #include <tuple_union.hpp>
@@ -189,4 +191,27 @@ TEST_CASE("tuple_union float: full overlap with theta sketch", "[tuple union]")
   }
 }
 
+TEST_CASE("tuple_union float: update parallel", "[tuple union]") {
+  std::vector<compact_tuple_sketch<float>> sketches;
+  for (int i = 0; i < 30; ++i) {
+    auto sketch = update_tuple_sketch<float>::builder().set_lg_k(8).build();
+    for (int j = 0; j < 500 + i * 50; ++j) sketch.update(i * 300 + j, 1.0f);
+    sketches.push_back(sketch.compact(i % 2 == 0));
+  }
+  auto u_serial = tuple_union<float>::builder().set_lg_k(8).build();
+  for (const auto& sketch: sketches) u_serial.update(sketch);
+  const auto expected = u_serial.get_result();
+  REQUIRE(expected.is_estimation_mode());
+
+  for (unsigned num_threads = 1; num_threads <= 5; ++num_threads) {
+    auto u = tuple_union<float>::builder().set_lg_k(8).build();
+    u.update_parallel(sketches.begin(), sketches.end(), num_threads);
+    const auto result = u.get_result();
+    REQUIRE(result.get_theta64() == expected.get_theta64());
+    REQUIRE(result.get_num_retained() == expected.get_num_retained());
+    // summaries of the same key from different threads are summed when the partial results are merged
+    REQUIRE(std::equal(result.begin(), result.end(), expected.begin()));
+  }
+}
+
 } /* namespace datasketches */